@@ -0,0 +1,478 @@
+//================================ Includes =====================================================
+#include "VectorParser.h"
+#include "CorpusGenerator.h"
+#include "SignatureSimilarity.h"
+#include <cctype>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+//================================ Constants ====================================================
+#define USAGE_ERROR "Usage: author_benchmark [--vocabulary N] [--frequent N] [--authors N] " \
+					"[--file-size BYTES] [--threads N] [--zipf S] [--seed N] [--output DIR]\n"
+#define VOCABULARY_OPTION "--vocabulary"
+#define FREQUENT_OPTION "--frequent"
+#define AUTHORS_OPTION "--authors"
+#define FILE_SIZE_OPTION "--file-size"
+#define THREADS_OPTION "--threads"
+#define ZIPF_OPTION "--zipf"
+#define SEED_OPTION "--seed"
+#define OUTPUT_OPTION "--output"
+#define DEFAULT_VOCABULARY_SIZE 50000
+#define DEFAULT_NUM_OF_FREQUENT_WORDS 500
+#define DEFAULT_NUM_OF_AUTHORS 16
+#define DEFAULT_FILE_SIZE (1 << 20)
+#define MAX_VOCABULARY_SIZE 10000000ull
+#define MAX_NUM_OF_FREQUENT_WORDS 1000000ull
+#define MAX_NUM_OF_AUTHORS 100000ull
+#define MAX_FILE_SIZE (1ull << 30)
+#define MAX_NUM_OF_THREADS 1024ull
+#define MAX_SEED UINT64_MAX
+#define MAX_ZIPF_EXPONENT 16.0
+#define MINIMAL_MEASURED_SECONDS 0.2
+#define BYTES_IN_MEGABYTE (1024.0 * 1024.0)
+#define FREQUENT_WORDS_FILE_NAME "/frequent_words.txt"
+#define UNKNOWN_AUTHOR_FILE_NAME "/unknown.txt"
+#define AUTHOR_FILE_PREFIX "/author"
+#define TEXT_FILE_SUFFIX ".txt"
+#define UNKNOWN_AUTHOR_INDEX 0
+#define UNKNOWN_AUTHOR_SAMPLE_INDEX 1
+#define RESULTS_HEADER "threads\ttokenize_MB/s\tsignatures/s\tcomparisons/s"
+#define WRITE_ERROR "Error: cannot write "
+#define TAB '\t'
+//================================ Code Segment =================================================
+
+/**
+ * This file is a throughput benchmark of the find_the_author pipeline on a synthetic corpus.
+ * It either writes the corpus to a directory (for benchmarking find_the_author itself), or
+ * measures tokenization MB/s, signatures/s and comparisons/s at 1..N threads in memory.
+ */
+
+/**
+ * This struct represents the parameters of a benchmark run.
+ */
+struct BenchmarkParameters
+{
+	size_t vocabularySize = DEFAULT_VOCABULARY_SIZE;
+	size_t numOfFrequentWords = DEFAULT_NUM_OF_FREQUENT_WORDS;
+	size_t numOfAuthors = DEFAULT_NUM_OF_AUTHORS;
+	size_t fileSize = DEFAULT_FILE_SIZE;
+	size_t maxThreads = std::max(1u, std::thread::hardware_concurrency());
+	double zipfExponent = DEFAULT_ZIPF_EXPONENT;
+	uint64_t seed = DEFAULT_CORPUS_SEED;
+	std::string outputDirectory;
+};
+
+/**
+ * This function prints the usage and exits.
+ */
+void exitWithUsage()
+{
+	std::cerr << USAGE_ERROR;
+	exit(EXIT_FAILURE);
+}
+
+/**
+ * This function parses a non negative integer option value. The whole value must be a number.
+ * @param value - the value of the option.
+ * @param maximum - the largest value that the option accepts.
+ * @return the number, or exits with the usage error if the value is not a number in range.
+ */
+uint64_t parseNumber(std::string const &value, uint64_t maximum)
+{
+	// stoull skips spaces and accepts a leading '-' (which wraps), so a digit must come first
+	if(value.empty() || !std::isdigit(static_cast<unsigned char>(value[0])))
+	{
+		exitWithUsage();
+	}
+	size_t pos = 0;
+	uint64_t number = 0;
+	try
+	{
+		number = std::stoull(value, &pos);
+	}
+	catch(std::logic_error const &)
+	{
+		exitWithUsage();
+	}
+	if(pos != value.size() || number > maximum)
+	{
+		exitWithUsage();
+	}
+	return number;
+}
+
+/**
+ * This function parses the Zipf exponent option value. The whole value must be a number.
+ * @param value - the value of the option.
+ * @return the exponent, or exits with the usage error if the value is not in [0, maximum].
+ */
+double parseExponent(std::string const &value)
+{
+	size_t pos = 0;
+	double exponent = 0;
+	try
+	{
+		exponent = std::stod(value, &pos);
+	}
+	catch(std::logic_error const &)
+	{
+		exitWithUsage();
+	}
+	// the negated comparison also rejects NaN
+	if(pos != value.size() || !(exponent >= 0 && exponent <= MAX_ZIPF_EXPONENT))
+	{
+		exitWithUsage();
+	}
+	return exponent;
+}
+
+/**
+ * This function parses the command line options.
+ * @param argc - argument counter for input
+ * @param argv - argument values for input
+ * @return the parameters of the benchmark run.
+ */
+BenchmarkParameters parseParameters(int const argc, char const *argv[])
+{
+	BenchmarkParameters parameters;
+	for(int i = 1 ; i < argc ; i += 2)
+	{
+		if(i + 1 >= argc)
+		{
+			exitWithUsage();
+		}
+		std::string option(argv[i]);
+		std::string value(argv[i + 1]);
+		if(option == VOCABULARY_OPTION)
+		{
+			parameters.vocabularySize = parseNumber(value, MAX_VOCABULARY_SIZE);
+		}
+		else if(option == FREQUENT_OPTION)
+		{
+			parameters.numOfFrequentWords = parseNumber(value, MAX_NUM_OF_FREQUENT_WORDS);
+		}
+		else if(option == AUTHORS_OPTION)
+		{
+			parameters.numOfAuthors = parseNumber(value, MAX_NUM_OF_AUTHORS);
+		}
+		else if(option == FILE_SIZE_OPTION)
+		{
+			parameters.fileSize = parseNumber(value, MAX_FILE_SIZE);
+		}
+		else if(option == THREADS_OPTION)
+		{
+			parameters.maxThreads = parseNumber(value, MAX_NUM_OF_THREADS);
+		}
+		else if(option == ZIPF_OPTION)
+		{
+			parameters.zipfExponent = parseExponent(value);
+		}
+		else if(option == SEED_OPTION)
+		{
+			parameters.seed = parseNumber(value, MAX_SEED);
+		}
+		else if(option == OUTPUT_OPTION)
+		{
+			parameters.outputDirectory = value;
+		}
+		else
+		{
+			exitWithUsage();
+		}
+	}
+	if(parameters.vocabularySize == 0 || parameters.numOfAuthors == 0 ||
+	   parameters.maxThreads == 0)
+	{
+		exitWithUsage();
+	}
+	return parameters;
+}
+
+/**
+ * This class represents a fixed set of worker threads which run rounds of tasks. The workers are
+ * started once, so a measured round pays only for waking them up and not for creating threads.
+ * Worker t runs the tasks t, t + numOfThreads, t + 2 * numOfThreads and so on of each round.
+ */
+class WorkerPool
+{
+	public:
+	/**
+	 * This constructor starts the workers.
+	 * @param numOfThreads - the number of worker threads.
+	 */
+	explicit WorkerPool(size_t const numOfThreads) : _numOfThreads(numOfThreads), _task(nullptr),
+													 _numOfTasks(0), _round(0), _numOfRunning(0),
+													 _stopped(false)
+	{
+		for(size_t threadIndex = 0 ; threadIndex < numOfThreads ; ++threadIndex)
+		{
+			_threads.emplace_back(&WorkerPool::work, this, threadIndex);
+		}
+	}
+
+	/**
+	 * This destructor stops the workers and waits for them.
+	 */
+	~WorkerPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_stopped = true;
+		}
+		_roundStarted.notify_all();
+		for(std::thread &thread : _threads)
+		{
+			thread.join();
+		}
+	}
+
+	WorkerPool(WorkerPool const &) = delete;
+	WorkerPool &operator=(WorkerPool const &) = delete;
+
+	/**
+	 * This function runs a round of tasks on the workers and waits until all of them are done.
+	 * @param numOfTasks - the number of tasks.
+	 * @param task - the function which runs a task, given its index.
+	 */
+	void run(size_t const numOfTasks, std::function<void(size_t)> const &task)
+	{
+		std::unique_lock<std::mutex> lock(_mutex);
+		_task = &task;
+		_numOfTasks = numOfTasks;
+		_numOfRunning = _numOfThreads;
+		++_round;
+		_roundStarted.notify_all();
+		_roundDone.wait(lock, [this] { return _numOfRunning == 0; });
+		_task = nullptr;
+	}
+
+	private:
+	/**
+	 * This function is the body of a worker thread: it waits for a round, runs its share of the
+	 * tasks and reports that it is done.
+	 * @param threadIndex - the index of the worker.
+	 */
+	void work(size_t const threadIndex)
+	{
+		size_t lastRound = 0;
+		std::unique_lock<std::mutex> lock(_mutex);
+		while(true)
+		{
+			_roundStarted.wait(lock, [&] { return _stopped || _round != lastRound; });
+			if(_stopped)
+			{
+				return;
+			}
+			lastRound = _round;
+			std::function<void(size_t)> const &task = *_task;
+			size_t const numOfTasks = _numOfTasks;
+			lock.unlock();
+			for(size_t taskIndex = threadIndex ; taskIndex < numOfTasks ;
+				taskIndex += _numOfThreads)
+			{
+				task(taskIndex);
+			}
+			lock.lock();
+			if(--_numOfRunning == 0)
+			{
+				_roundDone.notify_one();
+			}
+		}
+	}
+
+	/**
+	 * The number of worker threads (the workers read it while _threads is still being filled).
+	 */
+	size_t const _numOfThreads;
+
+	/**
+	 * The task of the current round, and its number of tasks.
+	 */
+	std::function<void(size_t)> const *_task;
+	size_t _numOfTasks;
+
+	/**
+	 * The number of the current round; a worker runs a round when it sees a new number.
+	 */
+	size_t _round;
+
+	/**
+	 * The number of workers which did not finish the current round yet.
+	 */
+	size_t _numOfRunning;
+
+	/**
+	 * True when the workers should exit.
+	 */
+	bool _stopped;
+
+	/**
+	 * Guards all of the state above.
+	 */
+	std::mutex _mutex;
+
+	/**
+	 * Notified when a round starts (or the pool stops).
+	 */
+	std::condition_variable _roundStarted;
+
+	/**
+	 * Notified when the last worker finishes a round.
+	 */
+	std::condition_variable _roundDone;
+
+	/**
+	 * The worker threads, which are started last, after all of the state above.
+	 */
+	std::vector<std::thread> _threads;
+};
+
+/**
+ * This function repeats a measured step until it ran for at least MINIMAL_MEASURED_SECONDS.
+ * @param step - the measured step, which returns the number of operations it did.
+ * @return the number of operations per second.
+ */
+double operationsPerSecond(std::function<size_t()> const &step)
+{
+	size_t operations = 0;
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	std::chrono::duration<double> elapsed{};
+	do
+	{
+		operations += step();
+		elapsed = std::chrono::steady_clock::now() - start;
+	}
+	while(elapsed.count() < MINIMAL_MEASURED_SECONDS);
+	return operations / elapsed.count();
+}
+
+/**
+ * This function writes a text to a file.
+ * @param path - the path of the file.
+ * @param text - the text.
+ */
+void writeFile(std::string const &path, std::string const &text)
+{
+	std::ofstream file(path, std::ios::binary);
+	file << text;
+	if(!file)
+	{
+		std::cerr << WRITE_ERROR << path << std::endl;
+		exit(EXIT_FAILURE);
+	}
+}
+
+/**
+ * This function writes the corpus as the input files of find_the_author: the frequent words,
+ * the unknown author (another text of the first author) and the known authors.
+ * @param parameters - the parameters of the run.
+ * @param generator - the corpus generator.
+ */
+void writeCorpus(BenchmarkParameters const &parameters, CorpusGenerator const &generator)
+{
+	std::string const &directory = parameters.outputDirectory;
+	writeFile(directory + FREQUENT_WORDS_FILE_NAME,
+			  generator.frequentWords(parameters.numOfFrequentWords));
+	writeFile(directory + UNKNOWN_AUTHOR_FILE_NAME,
+			  generator.authorText(UNKNOWN_AUTHOR_INDEX, parameters.fileSize,
+								   UNKNOWN_AUTHOR_SAMPLE_INDEX));
+	for(size_t author = 0 ; author < parameters.numOfAuthors ; ++author)
+	{
+		writeFile(directory + AUTHOR_FILE_PREFIX + std::to_string(author) + TEXT_FILE_SUFFIX,
+				  generator.authorText(author, parameters.fileSize));
+	}
+}
+
+/**
+ * This function measures the pipeline at 1..maxThreads threads and prints a row per count.
+ * @param parameters - the parameters of the run.
+ * @param generator - the corpus generator.
+ */
+void runBenchmark(BenchmarkParameters const &parameters, CorpusGenerator const &generator)
+{
+	std::istringstream frequentWordsFile(
+			generator.frequentWords(parameters.numOfFrequentWords));
+	FrequentWords frequentWords;
+	VectorParser::getFrequentWords(frequentWordsFile, frequentWords);
+	std::vector<std::string> texts(parameters.numOfAuthors);
+	size_t totalBytes = 0;
+	for(size_t author = 0 ; author < texts.size() ; ++author)
+	{
+		texts[author] = generator.authorText(author, parameters.fileSize);
+		totalBytes += texts[author].size();
+	}
+	std::cout << RESULTS_HEADER << std::endl;
+	for(size_t numOfThreads = 1 ; numOfThreads <= parameters.maxThreads ; ++numOfThreads)
+	{
+		std::vector<WordCountMap> maps(texts.size());
+		std::vector<std::vector<int>> signatures(texts.size(),
+												 std::vector<int>(frequentWords.size(), 0));
+		std::vector<double> norms(texts.size());
+		std::vector<double> scores(texts.size());
+		// the workers are started before, and stopped after, all of the measured steps
+		WorkerPool workers(numOfThreads);
+		double bytesPerSecond = operationsPerSecond([&]
+		{
+			workers.run(texts.size(), [&](size_t author)
+			{
+				std::istringstream textFile(texts[author]);
+				maps[author].clear();
+				VectorParser::mapText(textFile, maps[author], frequentWords);
+			});
+			return totalBytes;
+		});
+		double signaturesPerSecond = operationsPerSecond([&]
+		{
+			workers.run(texts.size(), [&](size_t author)
+			{
+				VectorParser::createSignature(frequentWords, signatures[author], maps[author]);
+				norms[author] = l2Norm(signatures[author]);
+			});
+			return texts.size();
+		});
+		// every known author is compared with every other author, as the unknown one
+		double comparisonsPerSecond = operationsPerSecond([&]
+		{
+			workers.run(texts.size(), [&](size_t unknown)
+			{
+				double score = 0;
+				for(size_t known = 0 ; known < texts.size() ; ++known)
+				{
+					score += calculateCosThetaAngle(signatures[unknown], signatures[known],
+													norms[unknown]);
+				}
+				scores[unknown] = score;
+			});
+			return texts.size() * texts.size();
+		});
+		std::cout << numOfThreads << TAB << std::fixed << std::setprecision(1)
+				  << bytesPerSecond / BYTES_IN_MEGABYTE << TAB << signaturesPerSecond << TAB
+				  << comparisonsPerSecond << std::endl;
+	}
+}
+
+/**
+ * This is the main function of the benchmark.
+ * @param argc - argument counter for input
+ * @param argv - argument values for input
+ * @return 0 if succeeds, non-zero otherwise.
+ */
+int main(int const argc, char const *argv[])
+{
+	BenchmarkParameters parameters = parseParameters(argc, argv);
+	CorpusGenerator generator(parameters.vocabularySize, parameters.zipfExponent,
+							  parameters.seed);
+	if(!parameters.outputDirectory.empty())
+	{
+		writeCorpus(parameters, generator);
+		return 0;
+	}
+	runBenchmark(parameters, generator);
+	return 0;
+}
@@ -0,0 +1,88 @@
+//================================ Includes =====================================================
+#include "ByteRingBuffer.h"
+#include <algorithm>
+#include <cstring>
+//================================ Code Segment =================================================
+
+/**
+ * This constructor initializes an empty ring buffer.
+ * @param capacity - the maximal number of bytes that the buffer holds at once.
+ */
+ByteRingBuffer::ByteRingBuffer(size_t capacity) : _buffer(capacity), _head(0), _size(0),
+												  _closed(false), _cancelled(false)
+{
+
+}
+
+/**
+ * This function writes all the given bytes into the buffer, blocking while it is full.
+ * @param data - the bytes that we write.
+ * @param size - the number of bytes that we write.
+ * @return true if all the bytes were written, false if the consumer cancelled the buffer.
+ */
+bool ByteRingBuffer::write(const char* data, size_t size)
+{
+	std::unique_lock<std::mutex> lock(_mutex);
+	while (size > 0)
+	{
+		_notFull.wait(lock, [this] { return _cancelled || _size < _buffer.size(); });
+		if (_cancelled)
+		{
+			return false;
+		}
+		// we copy into the free region, which may wrap around the end of the storage
+		size_t tail = (_head + _size) % _buffer.size();
+		size_t chunk = std::min(size, std::min(_buffer.size() - _size, _buffer.size() - tail));
+		std::memcpy(_buffer.data() + tail, data, chunk);
+		_size += chunk;
+		data += chunk;
+		size -= chunk;
+		_notEmpty.notify_one();
+	}
+	return true;
+}
+
+/**
+ * This function reads at least one byte from the buffer, blocking while it is empty.
+ * @param data - the destination of the bytes that we read.
+ * @param size - the maximal number of bytes that we read.
+ * @return the number of bytes read, or 0 if the producer closed the buffer and it is empty.
+ */
+size_t ByteRingBuffer::read(char* data, size_t size)
+{
+	std::unique_lock<std::mutex> lock(_mutex);
+	_notEmpty.wait(lock, [this] { return _closed || _cancelled || _size > 0; });
+	size_t total = 0;
+	while (total < size && _size > 0)
+	{
+		size_t chunk = std::min(size - total, std::min(_size, _buffer.size() - _head));
+		std::memcpy(data + total, _buffer.data() + _head, chunk);
+		_head = (_head + chunk) % _buffer.size();
+		_size -= chunk;
+		total += chunk;
+	}
+	_notFull.notify_one();
+	return total;
+}
+
+/**
+ * This function is called by the producer when there are no more bytes to write.
+ */
+void ByteRingBuffer::close()
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	_closed = true;
+	_notEmpty.notify_all();
+}
+
+/**
+ * This function is called by the consumer when it stops reading, so the producer does not
+ * block forever on a full buffer.
+ */
+void ByteRingBuffer::cancel()
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	_cancelled = true;
+	_notFull.notify_all();
+	_notEmpty.notify_all();
+}
@@ -0,0 +1,98 @@
+//================================ Constants ====================================================
+#ifndef CPP2_BYTE_RING_BUFFER_H
+#define CPP2_BYTE_RING_BUFFER_H
+//================================ Includes =====================================================
+#include <cstddef>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+//================================ Code Segment =================================================
+
+/**
+ * This class represents a bounded ring buffer of bytes which is shared by exactly one producer
+ * thread and one consumer thread. The producer blocks while the buffer is full and the consumer
+ * blocks while it is empty, so the memory used for streaming a file never exceeds the capacity.
+ */
+class ByteRingBuffer
+{
+	public:
+
+	/**
+	 * This constructor initializes an empty ring buffer.
+	 * @param capacity - the maximal number of bytes that the buffer holds at once.
+	 */
+	explicit ByteRingBuffer(size_t capacity);
+
+	/**
+	 * This function writes all the given bytes into the buffer, blocking while it is full.
+	 * @param data - the bytes that we write.
+	 * @param size - the number of bytes that we write.
+	 * @return true if all the bytes were written, false if the consumer cancelled the buffer.
+	 */
+	bool write(const char* data, size_t size);
+
+	/**
+	 * This function reads at least one byte from the buffer, blocking while it is empty.
+	 * @param data - the destination of the bytes that we read.
+	 * @param size - the maximal number of bytes that we read.
+	 * @return the number of bytes read, or 0 if the producer closed the buffer and it is empty.
+	 */
+	size_t read(char* data, size_t size);
+
+	/**
+	 * This function is called by the producer when there are no more bytes to write.
+	 */
+	void close();
+
+	/**
+	 * This function is called by the consumer when it stops reading, so the producer does not
+	 * block forever on a full buffer.
+	 */
+	void cancel();
+
+	private:
+
+	/**
+	 * The storage of the ring buffer.
+	 */
+	std::vector<char> _buffer;
+
+	/**
+	 * The index of the next byte to read.
+	 */
+	size_t _head;
+
+	/**
+	 * The number of bytes currently stored in the buffer.
+	 */
+	size_t _size;
+
+	/**
+	 * True if the producer has no more bytes to write.
+	 */
+	bool _closed;
+
+	/**
+	 * True if the consumer stopped reading.
+	 */
+	bool _cancelled;
+
+	/**
+	 * The mutex which guards all the fields above.
+	 */
+	std::mutex _mutex;
+
+	/**
+	 * Signalled when bytes are written (or the buffer is closed).
+	 */
+	std::condition_variable _notEmpty;
+
+	/**
+	 * Signalled when bytes are read (or the buffer is cancelled).
+	 */
+	std::condition_variable _notFull;
+
+};
+
+
+#endif //CPP2_BYTE_RING_BUFFER_H
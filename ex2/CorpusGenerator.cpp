@@ -0,0 +1,135 @@
+//================================ Includes =====================================================
+#include "CorpusGenerator.h"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+//================================ Constants ====================================================
+#define NUM_OF_LETTERS 26
+#define FIRST_LETTER 'a'
+#define MINIMAL_WORD_LENGTH 2
+#define AUTHOR_RESHUFFLED_RANKS 64
+#define AUTHOR_RESHUFFLE_WINDOW 8
+#define WORDS_PER_LINE 12
+#define WORDS_PER_SENTENCE 17
+#define SENTENCE_END ","
+#define WORD_SEPARATOR ' '
+#define LINE_SEPARATOR '\n'
+//================================ Code Segment =================================================
+
+/**
+ * This constructor creates the vocabulary and its Zipf distribution.
+ * @param vocabularySize - the number of distinct words.
+ * @param zipfExponent - the exponent s of the Zipf distribution (frequency ~ 1 / rank^s).
+ * @param seed - the seed of the random generators.
+ */
+CorpusGenerator::CorpusGenerator(size_t vocabularySize, double zipfExponent, uint64_t seed) :
+		_seed(seed)
+{
+	_vocabulary.reserve(vocabularySize);
+	_cumulativeDistribution.reserve(vocabularySize);
+	double total = 0;
+	for (size_t rank = 0; rank < vocabularySize; ++rank)
+	{
+		_vocabulary.push_back(makeWord(rank));
+		total += 1.0 / std::pow((double) (rank + 1), zipfExponent);
+		_cumulativeDistribution.push_back(total);
+	}
+	for (double& probability : _cumulativeDistribution)
+	{
+		probability /= total;
+	}
+}
+
+/**
+ * This function returns the text of a frequent words file: the most frequent words, one
+ * word per line.
+ * @param numOfWords - the number of frequent words.
+ * @return the text of the frequent words file.
+ */
+std::string CorpusGenerator::frequentWords(size_t numOfWords) const
+{
+	std::string text;
+	for (size_t rank = 0; rank < std::min(numOfWords, _vocabulary.size()); ++rank)
+	{
+		text += _vocabulary[rank];
+		text += LINE_SEPARATOR;
+	}
+	return text;
+}
+
+/**
+ * This function generates the text of an author.
+ * @param authorIndex - the index of the author, which determines its word preferences.
+ * @param sizeInBytes - the approximate size of the text.
+ * @param sampleIndex - the index of the text among the texts of the same author.
+ * @return the text of the author.
+ */
+std::string CorpusGenerator::authorText(size_t authorIndex, size_t sizeInBytes,
+										size_t sampleIndex) const
+{
+	std::seed_seq styleSeed{_seed, (uint64_t) authorIndex};
+	std::mt19937_64 styleGenerator(styleSeed);
+	// the author swaps some of the top ranks with near neighbours, which changes its style
+	std::vector<size_t> rankToWord(std::min((size_t) AUTHOR_RESHUFFLED_RANKS,
+											_vocabulary.size()));
+	for (size_t rank = 0; rank < rankToWord.size(); ++rank)
+	{
+		rankToWord[rank] = rank;
+	}
+	for (size_t rank = 0; rank + AUTHOR_RESHUFFLE_WINDOW <= rankToWord.size();
+		 rank += AUTHOR_RESHUFFLE_WINDOW)
+	{
+		std::shuffle(rankToWord.begin() + rank,
+					 rankToWord.begin() + rank + AUTHOR_RESHUFFLE_WINDOW, styleGenerator);
+	}
+	std::seed_seq textSeed{_seed, (uint64_t) authorIndex, (uint64_t) sampleIndex};
+	std::mt19937_64 generator(textSeed);
+	std::uniform_real_distribution<double> uniform(0.0, 1.0);
+	std::string text;
+	text.reserve(sizeInBytes + _vocabulary.back().size() + 1);
+	size_t wordCount = 0;
+	while (text.size() < sizeInBytes)
+	{
+		size_t rank = std::lower_bound(_cumulativeDistribution.begin(),
+									   _cumulativeDistribution.end(), uniform(generator)) -
+					  _cumulativeDistribution.begin();
+		rank = std::min(rank, _vocabulary.size() - 1);
+		const std::string& word =
+				_vocabulary[rank < rankToWord.size() ? rankToWord[rank] : rank];
+		++wordCount;
+		// capitalized sentence starts and punctuation exercise the tokenizer like a real text
+		if (wordCount % WORDS_PER_SENTENCE == 1)
+		{
+			text += (char) std::toupper(word[0]);
+			text.append(word, 1, std::string::npos);
+		}
+		else
+		{
+			text += word;
+		}
+		if (wordCount % WORDS_PER_SENTENCE == 0)
+		{
+			text += SENTENCE_END;
+		}
+		text += wordCount % WORDS_PER_LINE == 0 ? LINE_SEPARATOR : WORD_SEPARATOR;
+	}
+	return text;
+}
+
+/**
+ * This function creates the made-up word of a vocabulary index. Lower indices get shorter
+ * words, like frequent words in a natural language.
+ * @param index - the vocabulary index.
+ * @return the word.
+ */
+std::string CorpusGenerator::makeWord(size_t index)
+{
+	std::string word;
+	do
+	{
+		word += (char) (FIRST_LETTER + index % NUM_OF_LETTERS);
+		index /= NUM_OF_LETTERS;
+	}
+	while (index > 0 || word.size() < MINIMAL_WORD_LENGTH);
+	return word;
+}
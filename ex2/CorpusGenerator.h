@@ -0,0 +1,77 @@
+//================================ Constants ====================================================
+#ifndef CPP2_CORPUS_GENERATOR_H
+#define CPP2_CORPUS_GENERATOR_H
+#define DEFAULT_ZIPF_EXPONENT 1.07
+#define DEFAULT_CORPUS_SEED 2019
+//================================ Includes =====================================================
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+//================================ Code Segment =================================================
+
+/**
+ * This class represents a generator of a synthetic author corpus. The vocabulary is made of
+ * made-up words whose frequencies follow a Zipf distribution, like the words of a natural
+ * language. Every author uses the same vocabulary, but slightly reorders the frequency ranks of
+ * its most common words, so the signatures of different authors are distinguishable.
+ * The corpus only depends on the parameters and the seed, so benchmark runs are reproducible.
+ */
+class CorpusGenerator
+{
+	public:
+
+	/**
+	 * This constructor creates the vocabulary and its Zipf distribution.
+	 * @param vocabularySize - the number of distinct words.
+	 * @param zipfExponent - the exponent s of the Zipf distribution (frequency ~ 1 / rank^s).
+	 * @param seed - the seed of the random generators.
+	 */
+	CorpusGenerator(size_t vocabularySize, double zipfExponent = DEFAULT_ZIPF_EXPONENT,
+					uint64_t seed = DEFAULT_CORPUS_SEED);
+
+	/**
+	 * This function returns the text of a frequent words file: the most frequent words, one
+	 * word per line.
+	 * @param numOfWords - the number of frequent words.
+	 * @return the text of the frequent words file.
+	 */
+	std::string frequentWords(size_t numOfWords) const;
+
+	/**
+	 * This function generates the text of an author.
+	 * @param authorIndex - the index of the author, which determines its word preferences.
+	 * @param sizeInBytes - the approximate size of the text.
+	 * @param sampleIndex - the index of the text among the texts of the same author.
+	 * @return the text of the author.
+	 */
+	std::string authorText(size_t authorIndex, size_t sizeInBytes, size_t sampleIndex = 0) const;
+
+	private:
+
+	/**
+	 * This function creates the made-up word of a vocabulary index.
+	 * @param index - the vocabulary index.
+	 * @return the word.
+	 */
+	static std::string makeWord(size_t index);
+
+	/**
+	 * The vocabulary, ordered from the most frequent word to the least frequent one.
+	 */
+	std::vector<std::string> _vocabulary;
+
+	/**
+	 * The cumulative Zipf distribution of the ranks, used for sampling by binary search.
+	 */
+	std::vector<double> _cumulativeDistribution;
+
+	/**
+	 * The seed of the random generators.
+	 */
+	uint64_t _seed;
+
+};
+
+
+#endif //CPP2_CORPUS_GENERATOR_H
@@ -0,0 +1,338 @@
+//================================ Includes =====================================================
+#include "DecompressingStream.h"
+#include <zlib.h>
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+//================================ Constants ====================================================
+#define MAGIC_BYTES_LENGTH 4
+#define GZIP_FIRST_MAGIC_BYTE 0x1f
+#define GZIP_SECOND_MAGIC_BYTE 0x8b
+#define ZSTD_MAGIC_NUMBER 0xfd2fb528u
+#define ZLIB_AUTO_DETECT_HEADER_WINDOW_BITS (15 + 32)
+#define GZIP_ERROR "Error: corrupted gzip stream"
+#define GZIP_TRUNCATED_ERROR "Error: truncated gzip stream"
+#define ZSTD_ERROR "Error: corrupted zstd stream"
+#define ZSTD_TRUNCATED_ERROR "Error: truncated zstd stream"
+#define ZSTD_ALLOCATION_ERROR "Error: cannot allocate the zstd decoder"
+#define ZSTD_NOT_SUPPORTED_ERROR "Error: zstd support was not compiled in (build with ZSTD=1)"
+//================================ Code Segment =================================================
+
+/**
+ * This function detects the format of a file from its first bytes.
+ * @param magic - the first bytes of the file.
+ * @param length - the number of bytes in magic.
+ * @return the format of the file.
+ */
+static InputFormat detectFormat(const unsigned char* magic, std::streamsize length)
+{
+	if (length >= 2 && magic[0] == GZIP_FIRST_MAGIC_BYTE && magic[1] == GZIP_SECOND_MAGIC_BYTE)
+	{
+		return InputFormat::Gzip;
+	}
+	if (length >= MAGIC_BYTES_LENGTH)
+	{
+		// the zstd frame magic number is stored in little endian order
+		unsigned int number = magic[0] | (magic[1] << 8) | (magic[2] << 16) |
+							  ((unsigned int) magic[3] << 24);
+		if (number == ZSTD_MAGIC_NUMBER)
+		{
+			return InputFormat::Zstd;
+		}
+	}
+	return InputFormat::Plain;
+}
+
+/**
+ * This constructor opens the file, detects its format and starts the producer thread.
+ * @param path - the path of the input file.
+ */
+DecompressingStreamBuffer::DecompressingStreamBuffer(const std::string& path) :
+		_file(path, std::ios::binary), _format(InputFormat::Plain), _ring(RING_BUFFER_CAPACITY),
+		_getArea(DECOMPRESSION_CHUNK_SIZE), _counters(nullptr)
+{
+	setg(_getArea.data(), _getArea.data(), _getArea.data());
+	if (!_file.is_open())
+	{
+		return;
+	}
+	unsigned char magic[MAGIC_BYTES_LENGTH];
+	_file.read(reinterpret_cast<char*>(magic), MAGIC_BYTES_LENGTH);
+	_format = detectFormat(magic, _file.gcount());
+	// we rewind, since the magic bytes are part of the compressed (or plain) data
+	_file.clear();
+	_file.seekg(0);
+	_producer = std::thread(&DecompressingStreamBuffer::produce, this);
+}
+
+/**
+ * This destructor stops the producer thread and waits for it.
+ */
+DecompressingStreamBuffer::~DecompressingStreamBuffer()
+{
+	_ring.cancel();
+	if (_producer.joinable())
+	{
+		_producer.join();
+	}
+}
+
+/**
+ * This function checks if the input file was opened.
+ * @return true if the input file was opened, false otherwise.
+ */
+bool DecompressingStreamBuffer::isOpen() const
+{
+	return _file.is_open();
+}
+
+/**
+ * This function returns the detected format of the input file.
+ * @return the detected format of the input file.
+ */
+InputFormat DecompressingStreamBuffer::format() const
+{
+	return _format;
+}
+
+/**
+ * This function returns the error of the producer thread. It should only be called after
+ * the whole stream was consumed.
+ * @return the error message, or an empty string if there was no error.
+ */
+const std::string& DecompressingStreamBuffer::error() const
+{
+	return _error;
+}
+
+/**
+ * This function sets the counters which the bytes read and the time spent waiting for them
+ * are added to.
+ * @param counters - the counters, or null to disable counting.
+ */
+void DecompressingStreamBuffer::setCounters(PipelineCounters* counters)
+{
+	_counters = counters;
+}
+
+/**
+ * This function refills the get area from the ring buffer.
+ * @return the next character, or eof if the whole file was consumed.
+ */
+DecompressingStreamBuffer::int_type DecompressingStreamBuffer::underflow()
+{
+	if (gptr() < egptr())
+	{
+		return traits_type::to_int_type(*gptr());
+	}
+	if (!_producer.joinable())
+	{
+		return traits_type::eof();
+	}
+	size_t count;
+	{
+		StageTimer timer(_counters, PipelineStage::Read);
+		count = _ring.read(_getArea.data(), _getArea.size());
+	}
+	if (_counters != nullptr)
+	{
+		_counters->bytesRead += count;
+	}
+	if (count == 0)
+	{
+		return traits_type::eof();
+	}
+	setg(_getArea.data(), _getArea.data(), _getArea.data() + count);
+	return traits_type::to_int_type(*gptr());
+}
+
+/**
+ * This function is the body of the producer thread.
+ */
+void DecompressingStreamBuffer::produce()
+{
+	switch (_format)
+	{
+		case InputFormat::Gzip:
+			produceGzip();
+			break;
+		case InputFormat::Zstd:
+			produceZstd();
+			break;
+		default:
+			producePlain();
+			break;
+	}
+	// closing the ring publishes _error to the consumer
+	_ring.close();
+}
+
+/**
+ * This function copies the file as is into the ring buffer.
+ */
+void DecompressingStreamBuffer::producePlain()
+{
+	std::vector<char> chunk(DECOMPRESSION_CHUNK_SIZE);
+	while (_file)
+	{
+		_file.read(chunk.data(), chunk.size());
+		if (_file.gcount() > 0 && !_ring.write(chunk.data(), (size_t) _file.gcount()))
+		{
+			return;
+		}
+	}
+}
+
+/**
+ * This function decompresses a gzip (or zlib) file into the ring buffer.
+ */
+void DecompressingStreamBuffer::produceGzip()
+{
+	std::vector<char> input(DECOMPRESSION_CHUNK_SIZE);
+	std::vector<char> output(DECOMPRESSION_CHUNK_SIZE);
+	z_stream stream{};
+	if (inflateInit2(&stream, ZLIB_AUTO_DETECT_HEADER_WINDOW_BITS) != Z_OK)
+	{
+		_error = GZIP_ERROR;
+		return;
+	}
+	int status = Z_OK;
+	while (_file && _error.empty())
+	{
+		_file.read(input.data(), input.size());
+		stream.next_in = reinterpret_cast<Bytef*>(input.data());
+		stream.avail_in = (uInt) _file.gcount();
+		// we keep inflating while there is input left or the output buffer was filled up
+		while (stream.avail_in > 0 || (stream.avail_out == 0 && status == Z_OK))
+		{
+			if (status == Z_STREAM_END)
+			{
+				// a gzip file may hold several concatenated members
+				inflateReset(&stream);
+			}
+			stream.next_out = reinterpret_cast<Bytef*>(output.data());
+			stream.avail_out = (uInt) output.size();
+			status = inflate(&stream, Z_NO_FLUSH);
+			if (status == Z_BUF_ERROR)
+			{
+				// no progress is possible without more input
+				status = Z_OK;
+				break;
+			}
+			if (status != Z_OK && status != Z_STREAM_END)
+			{
+				_error = GZIP_ERROR;
+				break;
+			}
+			size_t produced = output.size() - stream.avail_out;
+			if (produced > 0 && !_ring.write(output.data(), produced))
+			{
+				inflateEnd(&stream);
+				return;
+			}
+		}
+	}
+	if (_error.empty() && status != Z_STREAM_END)
+	{
+		_error = GZIP_TRUNCATED_ERROR;
+	}
+	inflateEnd(&stream);
+}
+
+/**
+ * This function decompresses a zstd file into the ring buffer.
+ */
+void DecompressingStreamBuffer::produceZstd()
+{
+#ifdef HAVE_ZSTD
+	std::vector<char> input(ZSTD_DStreamInSize());
+	std::vector<char> output(ZSTD_DStreamOutSize());
+	ZSTD_DStream* stream = ZSTD_createDStream();
+	if (stream == nullptr)
+	{
+		_error = ZSTD_ALLOCATION_ERROR;
+		return;
+	}
+	if (ZSTD_isError(ZSTD_initDStream(stream)))
+	{
+		ZSTD_freeDStream(stream);
+		_error = ZSTD_ERROR;
+		return;
+	}
+	size_t lastResult = 0;
+	while (_file && _error.empty())
+	{
+		_file.read(input.data(), input.size());
+		ZSTD_inBuffer in = {input.data(), (size_t) _file.gcount(), 0};
+		bool outputFull = false;
+		// a full output buffer means that the decoder may still hold buffered output
+		while (in.pos < in.size || outputFull)
+		{
+			ZSTD_outBuffer out = {output.data(), output.size(), 0};
+			lastResult = ZSTD_decompressStream(stream, &out, &in);
+			if (ZSTD_isError(lastResult))
+			{
+				_error = ZSTD_ERROR;
+				break;
+			}
+			if (out.pos > 0 && !_ring.write(output.data(), out.pos))
+			{
+				ZSTD_freeDStream(stream);
+				return;
+			}
+			outputFull = out.pos == out.size;
+		}
+	}
+	// a zero result means that the last frame was completely decoded and flushed
+	if (_error.empty() && lastResult != 0)
+	{
+		_error = ZSTD_TRUNCATED_ERROR;
+	}
+	ZSTD_freeDStream(stream);
+#else
+	_error = ZSTD_NOT_SUPPORTED_ERROR;
+#endif
+}
+
+/**
+ * This constructor opens the file. If it cannot be opened the fail bit is set, like
+ * std::ifstream does.
+ * @param path - the path of the input file.
+ */
+DecompressingStream::DecompressingStream(const std::string& path) : std::istream(nullptr),
+																	_buffer(path)
+{
+	rdbuf(&_buffer);
+	if (!_buffer.isOpen())
+	{
+		setstate(std::ios::failbit);
+	}
+}
+
+/**
+ * This function checks if the file could not be decompressed.
+ * @return true if the decompression failed, false otherwise.
+ */
+bool DecompressingStream::hasDecompressionError() const
+{
+	return !_buffer.error().empty();
+}
+
+/**
+ * This function returns the decompression error.
+ * @return the error message, or an empty string if there was no error.
+ */
+const std::string& DecompressingStream::decompressionError() const
+{
+	return _buffer.error();
+}
+
+/**
+ * This function sets the counters which the bytes read and the time spent waiting for them
+ * are added to.
+ * @param counters - the counters, or null to disable counting.
+ */
+void DecompressingStream::setCounters(PipelineCounters* counters)
+{
+	_buffer.setCounters(counters);
+}
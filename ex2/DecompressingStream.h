@@ -0,0 +1,188 @@
+//================================ Constants ====================================================
+#ifndef CPP2_DECOMPRESSING_STREAM_H
+#define CPP2_DECOMPRESSING_STREAM_H
+#define RING_BUFFER_CAPACITY (1 << 20)
+#define DECOMPRESSION_CHUNK_SIZE (1 << 16)
+//================================ Includes =====================================================
+#include <fstream>
+#include <istream>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <vector>
+#include "ByteRingBuffer.h"
+#include "PipelineStats.h"
+//================================ Code Segment =================================================
+
+/**
+ * This enum represents the formats of the input files that we know how to read.
+ */
+enum class InputFormat
+{
+	Plain,
+	Gzip,
+	Zstd
+};
+
+/**
+ * This class represents a stream buffer which reads a (possibly compressed) file.
+ * The format is detected from the magic bytes at the beginning of the file. A producer thread
+ * reads and decompresses the file into a bounded ring buffer, while the consumer (the tokenizer)
+ * reads the plain text from the other end, so the I/O and the decompression overlap with parsing.
+ */
+class DecompressingStreamBuffer : public std::streambuf
+{
+	public:
+
+	/**
+	 * This constructor opens the file, detects its format and starts the producer thread.
+	 * @param path - the path of the input file.
+	 */
+	explicit DecompressingStreamBuffer(const std::string& path);
+
+	/**
+	 * This destructor stops the producer thread and waits for it.
+	 */
+	~DecompressingStreamBuffer() override;
+
+	DecompressingStreamBuffer(const DecompressingStreamBuffer&) = delete;
+	DecompressingStreamBuffer& operator=(const DecompressingStreamBuffer&) = delete;
+
+	/**
+	 * This function checks if the input file was opened.
+	 * @return true if the input file was opened, false otherwise.
+	 */
+	bool isOpen() const;
+
+	/**
+	 * This function returns the detected format of the input file.
+	 * @return the detected format of the input file.
+	 */
+	InputFormat format() const;
+
+	/**
+	 * This function returns the error of the producer thread. It should only be called after
+	 * the whole stream was consumed.
+	 * @return the error message, or an empty string if there was no error.
+	 */
+	const std::string& error() const;
+
+	/**
+	 * This function sets the counters which the bytes read and the time spent waiting for them
+	 * are added to.
+	 * @param counters - the counters, or null to disable counting.
+	 */
+	void setCounters(PipelineCounters* counters);
+
+	protected:
+
+	/**
+	 * This function refills the get area from the ring buffer.
+	 * @return the next character, or eof if the whole file was consumed.
+	 */
+	int_type underflow() override;
+
+	private:
+
+	/**
+	 * This function is the body of the producer thread.
+	 */
+	void produce();
+
+	/**
+	 * This function copies the file as is into the ring buffer.
+	 */
+	void producePlain();
+
+	/**
+	 * This function decompresses a gzip (or zlib) file into the ring buffer.
+	 */
+	void produceGzip();
+
+	/**
+	 * This function decompresses a zstd file into the ring buffer.
+	 */
+	void produceZstd();
+
+	/**
+	 * The input file.
+	 */
+	std::ifstream _file;
+
+	/**
+	 * The detected format of the input file.
+	 */
+	InputFormat _format;
+
+	/**
+	 * The ring buffer between the producer thread and the consumer.
+	 */
+	ByteRingBuffer _ring;
+
+	/**
+	 * The get area of the stream buffer.
+	 */
+	std::vector<char> _getArea;
+
+	/**
+	 * The error of the producer thread, empty if there was no error.
+	 */
+	std::string _error;
+
+	/**
+	 * The counters of the read stage, or null if disabled.
+	 */
+	PipelineCounters* _counters;
+
+	/**
+	 * The producer thread.
+	 */
+	std::thread _producer;
+
+};
+
+/**
+ * This class represents an input stream of a (possibly compressed) file. It can be used
+ * wherever an std::ifstream of the plain text file was used before.
+ */
+class DecompressingStream : public std::istream
+{
+	public:
+
+	/**
+	 * This constructor opens the file. If it cannot be opened the fail bit is set, like
+	 * std::ifstream does.
+	 * @param path - the path of the input file.
+	 */
+	explicit DecompressingStream(const std::string& path);
+
+	/**
+	 * This function checks if the file could not be decompressed.
+	 * @return true if the decompression failed, false otherwise.
+	 */
+	bool hasDecompressionError() const;
+
+	/**
+	 * This function returns the decompression error.
+	 * @return the error message, or an empty string if there was no error.
+	 */
+	const std::string& decompressionError() const;
+
+	/**
+	 * This function sets the counters which the bytes read and the time spent waiting for them
+	 * are added to.
+	 * @param counters - the counters, or null to disable counting.
+	 */
+	void setCounters(PipelineCounters* counters);
+
+	private:
+
+	/**
+	 * The stream buffer which does the actual reading.
+	 */
+	DecompressingStreamBuffer _buffer;
+
+};
+
+
+#endif //CPP2_DECOMPRESSING_STREAM_H
@@ -0,0 +1,152 @@
+//================================ Includes =====================================================
+#include "FrequentWords.h"
+#include <algorithm>
+#include <functional>
+//================================ Constants ====================================================
+#define READ_CHUNK_SIZE (1 << 16)
+#define MINIMAL_NUMBER_OF_SLOTS 16
+#define EMPTY_SLOT 0
+#define SLOT_INDEX_BITS 32
+#define SLOT_INDEX_MASK 0xffffffffull
+#define PREFETCH_DISTANCE 16
+//================================ Code Segment =================================================
+
+/**
+ * This function reads the whole frequent words file (one word per line) into the arena,
+ * replacing the words which were loaded before.
+ * @param file - the frequent words input file.
+ */
+void FrequentWords::load(std::istream& file)
+{
+	_arena.clear();
+	_words.clear();
+	_slots.clear();
+	// the file may be a decompressed stream of unknown size, so we read it in chunks
+	std::streambuf* buffer = file.rdbuf();
+	if (buffer != nullptr && file.good())
+	{
+		std::streamsize count;
+		do
+		{
+			size_t oldSize = _arena.size();
+			_arena.resize(oldSize + READ_CHUNK_SIZE);
+			count = buffer->sgetn(&_arena[oldSize], READ_CHUNK_SIZE);
+			_arena.resize(oldSize + (size_t) count);
+		}
+		while (count == READ_CHUNK_SIZE);
+	}
+	// only now the arena does not move anymore, so we can take views into it
+	_words.reserve((size_t) std::count(_arena.begin(), _arena.end(), FREQUENT_WORDS_SEPARATOR) + 1);
+	std::string_view text(_arena);
+	size_t start = 0;
+	while (start < text.size())
+	{
+		// like std::getline, a last line without a separator is a word, but an empty one is not
+		size_t end = text.find(FREQUENT_WORDS_SEPARATOR, start);
+		if (end == std::string_view::npos)
+		{
+			end = text.size();
+		}
+		_words.push_back(text.substr(start, end - start));
+		start = end + 1;
+	}
+	buildSlots();
+}
+
+/**
+ * This function builds the hash set of the words. The hashes are computed a few words ahead
+ * and their slots are prefetched, so the cache misses of the (large) table overlap.
+ */
+void FrequentWords::buildSlots()
+{
+	// at most half of the slots are used, so the probe sequences stay short
+	size_t numOfSlots = MINIMAL_NUMBER_OF_SLOTS;
+	while (numOfSlots < 2 * _words.size())
+	{
+		numOfSlots *= 2;
+	}
+	_slots.assign(numOfSlots, EMPTY_SLOT);
+	size_t mask = numOfSlots - 1;
+	size_t hashes[PREFETCH_DISTANCE];
+	for (size_t i = 0; i < _words.size() + PREFETCH_DISTANCE; ++i)
+	{
+		if (i >= PREFETCH_DISTANCE)
+		{
+			size_t word = i - PREFETCH_DISTANCE;
+			size_t hash = hashes[word % PREFETCH_DISTANCE];
+			size_t slot = findSlot(_words[word], hash);
+			if (_slots[slot] == EMPTY_SLOT)
+			{
+				_slots[slot] = (hash >> SLOT_INDEX_BITS << SLOT_INDEX_BITS) | (word + 1);
+			}
+		}
+		if (i < _words.size())
+		{
+			size_t hash = std::hash<std::string_view>()(_words[i]);
+			hashes[i % PREFETCH_DISTANCE] = hash;
+			__builtin_prefetch(&_slots[hash & mask]);
+		}
+	}
+}
+
+/**
+ * This function looks for the slot of a word in the hash set.
+ * @param word - the word that we look for.
+ * @param hash - the hash of the word.
+ * @param numOfProbes - if not null, the number of slots visited is added to it.
+ * @return the slot which holds the word, or the empty slot where it should be inserted.
+ */
+size_t FrequentWords::findSlot(std::string_view word, size_t hash, uint64_t* numOfProbes) const
+{
+	size_t mask = _slots.size() - 1;
+	size_t slot = hash & mask;
+	uint64_t tag = hash >> SLOT_INDEX_BITS;
+	uint64_t probes = 1;
+	while (_slots[slot] != EMPTY_SLOT && ((_slots[slot] >> SLOT_INDEX_BITS) != tag ||
+										  _words[(_slots[slot] & SLOT_INDEX_MASK) - 1] != word))
+	{
+		slot = (slot + 1) & mask;
+		++probes;
+	}
+	if (numOfProbes != nullptr)
+	{
+		*numOfProbes += probes;
+	}
+	return slot;
+}
+
+/**
+ * This function returns the frequent words in the order of the file.
+ * @return the frequent words in the order of the file.
+ */
+const std::vector<std::string_view>& FrequentWords::words() const
+{
+	return _words;
+}
+
+/**
+ * This function returns the number of frequent words (the size of a signature).
+ * @return the number of frequent words.
+ */
+size_t FrequentWords::size() const
+{
+	return _words.size();
+}
+
+/**
+ * This function looks for a word in the frequent words set.
+ * @param word - the word that we look for.
+ * @param numOfProbes - if not null, the number of slots visited by the lookup is added to it.
+ * @return a pointer to the stored view of the word (which lives as long as this object),
+ * or null if the word is not a frequent word.
+ */
+const std::string_view* FrequentWords::find(std::string_view word, uint64_t* numOfProbes) const
+{
+	if (_slots.empty())
+	{
+		return nullptr;
+	}
+	size_t slot = findSlot(word, std::hash<std::string_view>()(word), numOfProbes);
+	uint64_t index = _slots[slot] & SLOT_INDEX_MASK;
+	return index != EMPTY_SLOT ? &_words[index - 1] : nullptr;
+}
@@ -0,0 +1,103 @@
+//================================ Constants ====================================================
+#ifndef CPP2_FREQUENT_WORDS_H
+#define CPP2_FREQUENT_WORDS_H
+#define FREQUENT_WORDS_SEPARATOR '\n'
+//================================ Includes =====================================================
+#include <istream>
+#include <string>
+#include <string_view>
+#include <cstdint>
+#include <vector>
+//================================ Code Segment =================================================
+
+/**
+ * This type represents the type of an iterator of the frequent words.
+ */
+typedef std::vector<std::string_view>::const_iterator FrequentWordsIterator;
+
+/**
+ * This class represents the frequent words list, stored in a single arena: the whole file is
+ * read into one buffer and the ordered list of words are views into it. The set of words is a
+ * flat open addressing hash table of indices into that list, so loading a list costs a handful
+ * of allocations in total instead of two strings and a set node per word.
+ * The views point into the object itself, so it can be neither copied nor moved.
+ */
+class FrequentWords
+{
+	public:
+
+	/**
+	 * This constructor initializes an empty frequent words list.
+	 */
+	FrequentWords() = default;
+
+	FrequentWords(const FrequentWords&) = delete;
+	FrequentWords& operator=(const FrequentWords&) = delete;
+
+	/**
+	 * This function reads the whole frequent words file (one word per line) into the arena,
+	 * replacing the words which were loaded before.
+	 * @param file - the frequent words input file.
+	 */
+	void load(std::istream& file);
+
+	/**
+	 * This function returns the frequent words in the order of the file.
+	 * @return the frequent words in the order of the file.
+	 */
+	const std::vector<std::string_view>& words() const;
+
+	/**
+	 * This function returns the number of frequent words (the size of a signature).
+	 * @return the number of frequent words.
+	 */
+	size_t size() const;
+
+	/**
+	 * This function looks for a word in the frequent words set.
+	 * @param word - the word that we look for.
+	 * @param numOfProbes - if not null, the number of slots visited by the lookup is added to it.
+	 * @return a pointer to the stored view of the word (which lives as long as this object),
+	 * or null if the word is not a frequent word.
+	 */
+	const std::string_view* find(std::string_view word, uint64_t* numOfProbes = nullptr) const;
+
+	private:
+
+	/**
+	 * This function looks for the slot of a word in the hash set.
+	 * @param word - the word that we look for.
+	 * @param hash - the hash of the word.
+	 * @param numOfProbes - if not null, the number of slots visited is added to it.
+	 * @return the slot which holds the word, or the empty slot where it should be inserted.
+	 */
+	size_t findSlot(std::string_view word, size_t hash, uint64_t* numOfProbes = nullptr) const;
+
+	/**
+	 * This function builds the hash set of the words. The hashes are computed a few words ahead
+	 * and their slots are prefetched, so the cache misses of the (large) table overlap.
+	 */
+	void buildSlots();
+
+	/**
+	 * The arena: the whole text of the frequent words file.
+	 */
+	std::string _arena;
+
+	/**
+	 * The frequent words in the order of the file, as views into the arena.
+	 */
+	std::vector<std::string_view> _words;
+
+	/**
+	 * The hash set of the frequent words: each slot is an index into _words plus one in its low
+	 * half, or zero if the slot is empty, and the high half of the hash of the word in its high
+	 * half, so probing only compares the words whose hashes match. Its size is a power of two,
+	 * and collisions are resolved by linear probing.
+	 */
+	std::vector<uint64_t> _slots;
+
+};
+
+
+#endif //CPP2_FREQUENT_WORDS_H
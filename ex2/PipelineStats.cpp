@@ -0,0 +1,170 @@
+//================================ Includes =====================================================
+#include "PipelineStats.h"
+//================================ Constants ====================================================
+#define JSON_INDENT "  "
+//================================ Code Segment =================================================
+
+/**
+ * The names of the stages in the JSON output, indexed by PipelineStage.
+ */
+static const char* const STAGE_NAMES[] = {"read", "tokenize", "hash", "vocabulary",
+										  "signature", "scoring"};
+
+/**
+ * This function adds the counters of other to these counters.
+ * @param other - the counters that we add.
+ */
+void PipelineCounters::add(const PipelineCounters& other)
+{
+	bytesRead += other.bytesRead;
+	tokens += other.tokens;
+	vocabularyHits += other.vocabularyHits;
+	hashProbes += other.hashProbes;
+	for (int stage = 0; stage < (int) PipelineStage::NumOfStages; ++stage)
+	{
+		nanoseconds[stage] += other.nanoseconds[stage];
+	}
+}
+
+/**
+ * This function adds elapsed time to a stage.
+ * @param stage - the stage.
+ * @param start - the time when the stage started.
+ * @param end - the time when the stage ended.
+ */
+void PipelineCounters::addTime(PipelineStage stage, PipelineClock::time_point start,
+							   PipelineClock::time_point end)
+{
+	nanoseconds[(int) stage] += (uint64_t) std::chrono::duration_cast<std::chrono::nanoseconds>(
+			end - start).count();
+}
+
+/**
+ * This constructor starts timing a stage.
+ * @param counters - the counters that we add the time to, or null if disabled.
+ * @param stage - the timed stage.
+ */
+StageTimer::StageTimer(PipelineCounters* counters, PipelineStage stage) : _counters(counters),
+																		  _stage(stage)
+{
+	if (_counters != nullptr)
+	{
+#ifdef PERF_MARKERS
+		pipeline_stage_begin((int) _stage);
+#endif
+		_start = PipelineClock::now();
+	}
+}
+
+/**
+ * This destructor adds the time of the scope to the stage.
+ */
+StageTimer::~StageTimer()
+{
+	if (_counters != nullptr)
+	{
+		_counters->addTime(_stage, _start, PipelineClock::now());
+#ifdef PERF_MARKERS
+		pipeline_stage_end((int) _stage);
+#endif
+	}
+}
+
+/**
+ * This function writes a string as a JSON string literal.
+ * @param os - the output stream.
+ * @param str - the string.
+ */
+static void writeJsonString(std::ostream& os, const std::string& str)
+{
+	static const char* const HEX_DIGITS = "0123456789abcdef";
+	os << '"';
+	for (unsigned char character : str)
+	{
+		if (character == '"' || character == '\\')
+		{
+			os << '\\' << character;
+		}
+		else if (character < 0x20)
+		{
+			os << "\\u00" << HEX_DIGITS[character >> 4] << HEX_DIGITS[character & 0xf];
+		}
+		else
+		{
+			os << character;
+		}
+	}
+	os << '"';
+}
+
+/**
+ * This function writes counters as a JSON object.
+ * @param os - the output stream.
+ * @param counters - the counters.
+ */
+static void writeJsonCounters(std::ostream& os, const PipelineCounters& counters)
+{
+	os << "\"bytes_read\": " << counters.bytesRead << ", \"tokens\": " << counters.tokens
+	   << ", \"vocabulary_hits\": " << counters.vocabularyHits << ", \"hash_probes\": "
+	   << counters.hashProbes << ", \"ns\": {";
+	for (int stage = 0; stage < (int) PipelineStage::NumOfStages; ++stage)
+	{
+		os << (stage == 0 ? "" : ", ") << '"' << STAGE_NAMES[stage] << "\": "
+		   << counters.nanoseconds[stage];
+	}
+	os << '}';
+}
+
+/**
+ * This function adds an input file to the statistics.
+ * @param fileName - the name of the input file.
+ * @return the counters of the file, valid as long as the statistics are.
+ */
+PipelineCounters& PipelineStats::addFile(const std::string& fileName)
+{
+	_files.emplace_back(fileName, PipelineCounters());
+	return _files.back().second;
+}
+
+/**
+ * This function writes the statistics of all the files and their total as JSON.
+ * @param os - the output stream.
+ */
+void PipelineStats::writeJson(std::ostream& os) const
+{
+	PipelineCounters total;
+	os << "{\n" << JSON_INDENT << "\"files\": [";
+	for (size_t i = 0; i < _files.size(); ++i)
+	{
+		os << (i == 0 ? "\n" : ",\n") << JSON_INDENT << JSON_INDENT << "{\"name\": ";
+		writeJsonString(os, _files[i].first);
+		os << ", ";
+		writeJsonCounters(os, _files[i].second);
+		os << '}';
+		total.add(_files[i].second);
+	}
+	os << '\n' << JSON_INDENT << "],\n" << JSON_INDENT << "\"total\": {";
+	writeJsonCounters(os, total);
+	os << "}\n}" << std::endl;
+}
+
+#ifdef PERF_MARKERS
+/**
+ * This function is a perf friendly marker of the beginning of a stage.
+ * @param stage - the stage which begins.
+ */
+extern "C" __attribute__((noinline)) void pipeline_stage_begin(int stage)
+{
+	// the empty asm keeps the call from being optimized away
+	asm volatile("" : : "r"(stage) : "memory");
+}
+
+/**
+ * This function is a perf friendly marker of the end of a stage.
+ * @param stage - the stage which ends.
+ */
+extern "C" __attribute__((noinline)) void pipeline_stage_end(int stage)
+{
+	asm volatile("" : : "r"(stage) : "memory");
+}
+#endif
@@ -0,0 +1,169 @@
+//================================ Constants ====================================================
+#ifndef CPP2_PIPELINE_STATS_H
+#define CPP2_PIPELINE_STATS_H
+//================================ Includes =====================================================
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <ostream>
+#include <string>
+//================================ Code Segment =================================================
+
+/**
+ * This enum represents the stages of the find_the_author pipeline that we time.
+ * Read is the time the tokenizer waits for (decompressed) bytes, Tokenize excludes Read and
+ * Hash, and Hash is the time spent on the n-gram features.
+ */
+enum class PipelineStage
+{
+	Read,
+	Tokenize,
+	Hash,
+	Vocabulary,
+	Signature,
+	Scoring,
+	NumOfStages
+};
+
+/**
+ * This type represents the clock that we use for timing the stages.
+ */
+typedef std::chrono::steady_clock PipelineClock;
+
+/**
+ * This struct represents the counters of one input file (or of all the input files).
+ */
+struct PipelineCounters
+{
+	/**
+	 * The number of (decompressed) bytes read.
+	 */
+	uint64_t bytesRead = 0;
+
+	/**
+	 * The number of words in the text.
+	 */
+	uint64_t tokens = 0;
+
+	/**
+	 * The number of words which are frequent words.
+	 */
+	uint64_t vocabularyHits = 0;
+
+	/**
+	 * The number of slots visited by the lookups in the frequent words hash set.
+	 */
+	uint64_t hashProbes = 0;
+
+	/**
+	 * The nanoseconds spent in each stage, indexed by PipelineStage.
+	 */
+	uint64_t nanoseconds[(int) PipelineStage::NumOfStages] = {};
+
+	/**
+	 * This function adds the counters of other to these counters.
+	 * @param other - the counters that we add.
+	 */
+	void add(const PipelineCounters& other);
+
+	/**
+	 * This function adds elapsed time to a stage.
+	 * @param stage - the stage.
+	 * @param start - the time when the stage started.
+	 * @param end - the time when the stage ended.
+	 */
+	void addTime(PipelineStage stage, PipelineClock::time_point start,
+				 PipelineClock::time_point end);
+};
+
+/**
+ * This class represents a timer which adds the time of its scope to a stage. It does nothing
+ * (not even reading the clock) if the counters are null, so it costs nothing when the
+ * statistics are disabled.
+ */
+class StageTimer
+{
+	public:
+
+	/**
+	 * This constructor starts timing a stage.
+	 * @param counters - the counters that we add the time to, or null if disabled.
+	 * @param stage - the timed stage.
+	 */
+	StageTimer(PipelineCounters* counters, PipelineStage stage);
+
+	/**
+	 * This destructor adds the time of the scope to the stage.
+	 */
+	~StageTimer();
+
+	StageTimer(const StageTimer&) = delete;
+	StageTimer& operator=(const StageTimer&) = delete;
+
+	private:
+
+	/**
+	 * The counters that we add the time to, or null if disabled.
+	 */
+	PipelineCounters* _counters;
+
+	/**
+	 * The timed stage.
+	 */
+	PipelineStage _stage;
+
+	/**
+	 * The time when the stage started.
+	 */
+	PipelineClock::time_point _start;
+
+};
+
+/**
+ * This class represents the statistics of a whole run: the counters of each input file and
+ * their total, which can be written as JSON.
+ */
+class PipelineStats
+{
+	public:
+
+	/**
+	 * This function adds an input file to the statistics.
+	 * @param fileName - the name of the input file.
+	 * @return the counters of the file, valid as long as the statistics are.
+	 */
+	PipelineCounters& addFile(const std::string& fileName);
+
+	/**
+	 * This function writes the statistics of all the files and their total as JSON.
+	 * @param os - the output stream.
+	 */
+	void writeJson(std::ostream& os) const;
+
+	private:
+
+	/**
+	 * The input files and their counters. A deque keeps the counters in place as files are added.
+	 */
+	std::deque<std::pair<std::string, PipelineCounters>> _files;
+
+};
+
+#ifdef PERF_MARKERS
+/**
+ * This function is a perf friendly marker of the beginning of a stage. When built with
+ * PERF_MARKERS it is a real (non inlined) function that perf can probe, for example:
+ * perf probe -x find_the_author 'pipeline_stage_begin stage'
+ * @param stage - the stage which begins.
+ */
+extern "C" void pipeline_stage_begin(int stage);
+
+/**
+ * This function is a perf friendly marker of the end of a stage (see pipeline_stage_begin).
+ * @param stage - the stage which ends.
+ */
+extern "C" void pipeline_stage_end(int stage);
+#endif
+
+
+#endif //CPP2_PIPELINE_STATS_H
@@ -0,0 +1,41 @@
+//================================ Includes =====================================================
+#include "SignatureSimilarity.h"
+#include <numeric>
+#include <math.h>
+//================================ Code Segment =================================================
+
+/**
+ * This function calculates the l2-norm of a vector of ints.
+ * @param vector - the int vector which we calculate its norm.
+ * @return the l2_norm of a vector of ints.
+ */
+double l2Norm(std::vector<int> const &vector)
+{
+	double resultSquared = inner_product(std::begin(vector), std::end(vector),
+			                             std::begin(vector), 0.0);
+	return sqrt(resultSquared);
+}
+
+/**
+ * This function calculates the cos angle between two int vectors, while the norm of the first
+ * vector is already known. If one of the norms equals zero - we return zero, in order not to
+ * divide by zero.
+ * @param firstVector - the first input int vector.
+ * @param secondVector - the second input int vector.
+ * @param normOfFirstVector - the norm of the first vector.
+ * @return the cos angle between two int vectors.
+ */
+double calculateCosThetaAngle(std::vector<int> const &firstVector,
+						      std::vector<int> const &secondVector, double const normOfFirstVector)
+{
+	double normOfSecondVector = l2Norm(secondVector);
+
+	if(normOfFirstVector == 0 || normOfSecondVector == 0)
+	{
+		return 0;
+	}
+	double scalarProduct = inner_product(std::begin(firstVector),
+										 std::end(firstVector),
+										 std::begin(secondVector), 0.0);
+	return scalarProduct / (normOfFirstVector * normOfSecondVector);
+}
@@ -0,0 +1,28 @@
+//================================ Constants ====================================================
+#ifndef CPP2_SIGNATURE_SIMILARITY_H
+#define CPP2_SIGNATURE_SIMILARITY_H
+//================================ Includes =====================================================
+#include <vector>
+//================================ Code Segment =================================================
+
+/**
+ * This function calculates the l2-norm of a vector of ints.
+ * @param vector - the int vector which we calculate its norm.
+ * @return the l2_norm of a vector of ints.
+ */
+double l2Norm(std::vector<int> const &vector);
+
+/**
+ * This function calculates the cos angle between two int vectors, while the norm of the first
+ * vector is already known. If one of the norms equals zero - we return zero, in order not to
+ * divide by zero.
+ * @param firstVector - the first input int vector.
+ * @param secondVector - the second input int vector.
+ * @param normOfFirstVector - the norm of the first vector.
+ * @return the cos angle between two int vectors.
+ */
+double calculateCosThetaAngle(std::vector<int> const &firstVector,
+						      std::vector<int> const &secondVector, double const normOfFirstVector);
+
+
+#endif //CPP2_SIGNATURE_SIMILARITY_H
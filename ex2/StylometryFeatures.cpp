@@ -0,0 +1,114 @@
+//================================ Includes =====================================================
+#include "StylometryFeatures.h"
+//================================ Constants ====================================================
+#define FNV_OFFSET_BASIS 14695981039346656037ull
+#define FNV_PRIME 1099511628211ull
+#define ROLLING_HASH_BASE 257ull
+#define FIBONACCI_HASH_MULTIPLIER 11400714819323198485ull
+#define BIGRAM_MIX_MULTIPLIER 0x9ddfea08eb382d69ull
+#define WORD_BOUNDARY_CHARACTER ' '
+//================================ Code Segment =================================================
+
+/**
+ * This function calculates ROLLING_HASH_BASE ^ CHARACTER_NGRAM_LENGTH (modulo 2^64), which is
+ * the weight of the character that leaves the rolling hash.
+ * @return the weight of the oldest character in the rolling hash.
+ */
+static uint64_t outgoingCharacterWeight()
+{
+	uint64_t weight = 1;
+	for (int i = 0; i < CHARACTER_NGRAM_LENGTH; ++i)
+	{
+		weight *= ROLLING_HASH_BASE;
+	}
+	return weight;
+}
+
+/**
+ * This constructor initializes empty feature vectors.
+ */
+StylometryFeatures::StylometryFeatures() : _previousWordHash(0), _hasPreviousWord(false),
+										   _rollingHash(0), _window(), _windowFill(0),
+										   _windowPosition(0),
+										   _wordBigrams(FEATURE_VECTOR_SIZE, 0),
+										   _characterNgrams(FEATURE_VECTOR_SIZE, 0)
+{
+
+}
+
+/**
+ * This function adds the next (lowercase) word of the text to all the feature families.
+ * @param word - the next word of the text.
+ */
+void StylometryFeatures::addWord(std::string_view word)
+{
+	uint64_t wordHash = FNV_OFFSET_BASIS;
+	for (unsigned char character : word)
+	{
+		wordHash = (wordHash ^ character) * FNV_PRIME;
+		addCharacter(character);
+	}
+	// words are separated by a single boundary character, so shingles span word pairs as well
+	addCharacter(WORD_BOUNDARY_CHARACTER);
+	if (_hasPreviousWord)
+	{
+		// the multiplication makes the bigram hash depend on the order of the two words
+		_wordBigrams[bucketOf((_previousWordHash * BIGRAM_MIX_MULTIPLIER) ^ wordHash)]++;
+	}
+	_previousWordHash = wordHash;
+	_hasPreviousWord = true;
+}
+
+/**
+ * This function returns the hashed word bigram counts.
+ * @return the hashed word bigram counts.
+ */
+const std::vector<int>& StylometryFeatures::wordBigrams() const
+{
+	return _wordBigrams;
+}
+
+/**
+ * This function returns the hashed character n-gram counts.
+ * @return the hashed character n-gram counts.
+ */
+const std::vector<int>& StylometryFeatures::characterNgrams() const
+{
+	return _characterNgrams;
+}
+
+/**
+ * This function pushes the next character into the rolling character n-gram hash, and
+ * counts the n-gram which ends with it.
+ * @param character - the next character of the text.
+ */
+void StylometryFeatures::addCharacter(unsigned char character)
+{
+	static const uint64_t outgoingWeight = outgoingCharacterWeight();
+	_rollingHash = _rollingHash * ROLLING_HASH_BASE + character;
+	if (_windowFill == CHARACTER_NGRAM_LENGTH)
+	{
+		_rollingHash -= outgoingWeight * _window[_windowPosition];
+	}
+	else
+	{
+		++_windowFill;
+	}
+	_window[_windowPosition] = character;
+	_windowPosition = (_windowPosition + 1) % CHARACTER_NGRAM_LENGTH;
+	if (_windowFill == CHARACTER_NGRAM_LENGTH)
+	{
+		_characterNgrams[bucketOf(_rollingHash)]++;
+	}
+}
+
+/**
+ * This function maps a 64 bit hash to an index in a feature vector.
+ * @param hash - the hash of the feature.
+ * @return the index of the feature in a feature vector.
+ */
+size_t StylometryFeatures::bucketOf(uint64_t hash)
+{
+	// fibonacci hashing spreads the high quality bits of the product over the bucket index
+	return (size_t) ((hash * FIBONACCI_HASH_MULTIPLIER) >> (64 - FEATURE_VECTOR_BITS));
+}
@@ -0,0 +1,105 @@
+//================================ Constants ====================================================
+#ifndef CPP2_STYLOMETRY_FEATURES_H
+#define CPP2_STYLOMETRY_FEATURES_H
+#define FEATURE_VECTOR_BITS 12
+#define FEATURE_VECTOR_SIZE (1 << FEATURE_VECTOR_BITS)
+#define CHARACTER_NGRAM_LENGTH 3
+//================================ Includes =====================================================
+#include <cstdint>
+#include <string_view>
+#include <vector>
+//================================ Code Segment =================================================
+
+/**
+ * This class represents the stylometry features of a text beyond the frequent words counts:
+ * word bigrams and character n-grams (shingles). Each feature family is counted into a
+ * fixed-size vector indexed by a hash of the feature, so no n-gram string is ever built.
+ * The features are gathered word by word during the single tokenization pass of mapText.
+ */
+class StylometryFeatures
+{
+	public:
+
+	/**
+	 * This constructor initializes empty feature vectors.
+	 */
+	StylometryFeatures();
+
+	/**
+	 * This function adds the next (lowercase) word of the text to all the feature families.
+	 * @param word - the next word of the text.
+	 */
+	void addWord(std::string_view word);
+
+	/**
+	 * This function returns the hashed word bigram counts.
+	 * @return the hashed word bigram counts.
+	 */
+	const std::vector<int>& wordBigrams() const;
+
+	/**
+	 * This function returns the hashed character n-gram counts.
+	 * @return the hashed character n-gram counts.
+	 */
+	const std::vector<int>& characterNgrams() const;
+
+	private:
+
+	/**
+	 * This function pushes the next character into the rolling character n-gram hash, and
+	 * counts the n-gram which ends with it.
+	 * @param character - the next character of the text.
+	 */
+	void addCharacter(unsigned char character);
+
+	/**
+	 * This function maps a 64 bit hash to an index in a feature vector.
+	 * @param hash - the hash of the feature.
+	 * @return the index of the feature in a feature vector.
+	 */
+	static size_t bucketOf(uint64_t hash);
+
+	/**
+	 * The hash of the previous word, used to build the next bigram.
+	 */
+	uint64_t _previousWordHash;
+
+	/**
+	 * True if the text already had a word, so the next word completes a bigram.
+	 */
+	bool _hasPreviousWord;
+
+	/**
+	 * The rolling polynomial hash of the last CHARACTER_NGRAM_LENGTH characters.
+	 */
+	uint64_t _rollingHash;
+
+	/**
+	 * The last CHARACTER_NGRAM_LENGTH characters, used to remove the oldest one from the hash.
+	 */
+	unsigned char _window[CHARACTER_NGRAM_LENGTH];
+
+	/**
+	 * The number of characters seen so far, capped at CHARACTER_NGRAM_LENGTH.
+	 */
+	size_t _windowFill;
+
+	/**
+	 * The index in _window of the oldest character.
+	 */
+	size_t _windowPosition;
+
+	/**
+	 * The hashed word bigram counts.
+	 */
+	std::vector<int> _wordBigrams;
+
+	/**
+	 * The hashed character n-gram counts.
+	 */
+	std::vector<int> _characterNgrams;
+
+};
+
+
+#endif //CPP2_STYLOMETRY_FEATURES_H
@@ -1,5 +1,8 @@
 //================================ Includes =====================================================
 #include "VectorParser.h"
+#include <cstring>
+//================================ Constants ====================================================
+#define TOKENIZE_CHUNK_SIZE (1 << 16)
 //================================ Code Segment =================================================
 
 /**
@@ -8,78 +11,144 @@
  */
 
 /**
- * This function parses the frequent words file to its words ans saves them in a vector.
+ * This function parses the frequent words file to its words and saves them in a single arena
+ * which is shared by the ordered list of words and the set of words.
  * @param file - the frequent words input file.
- * @param frequentWordsVec - the vector which stores all the words.
+ * @param frequentWords - the frequent words which store all the words.
  */
-void VectorParser::getFrequentWords(std::ifstream& file,
-		                            std::vector<std::string>& frequentWordsVec)
+void VectorParser::getFrequentWords(std::istream& file, FrequentWords& frequentWords)
 {
-
-	std::string line;
-	while (std::getline(file, line))
-	{
-		frequentWordsVec.push_back(line);
-	}
+	frequentWords.load(file);
 }
 
 /**
  * This function parses and maps all the words from the author text file, and counts only
- * those which are also in the frequent words set.
- * @param textFile - the input author text file.
+ * those which are also in the frequent words set. The words are views into the chunk of the
+ * text which was read, so no string is built per word.
+ * @param textFile - the input author text file (already decompressed if it was compressed).
  * @param mapWords - the map where we save the words and how many times they appear in
  * the text.
- * @param frequentWordsSet - this is the frequent words stored as an unordered set.
+ * @param frequentWords - this is the frequent words, looked up through their hash set.
+ * @param features - if not null, the n-gram features of the text are gathered into it
+ * during the same pass.
+ * @param counters - if not null, the tokenizing statistics of the text are added to it.
+ * Time spent inside the stream is left to the stream to count (see DecompressingStream).
  */
-void VectorParser::mapText(std::ifstream &textFile, std::unordered_map<std::string,
-		                   int>& mapWords, std::unordered_set<std::string>& frequentWordsSet)
+void VectorParser::mapText(std::istream &textFile, WordCountMap& mapWords,
+		                   const FrequentWords& frequentWords, StylometryFeatures* features,
+		                   PipelineCounters* counters)
 {
-	std::string separator{SEPARATORS};
-	std::string tempLine;
-	while(getline (textFile, tempLine))
-	{ // we will read the file line by line
-		size_t tempEndOfWord, tempStartOfWord = 0;
-		do  {
-			// we want to ignore all the separators
-			tempStartOfWord = tempLine.find_first_not_of(separator, tempStartOfWord);
-			// we want to stop if there are no word left anymore
-			if (tempStartOfWord == std :: string :: npos)
+	// the tokenize stage is the whole pass minus the time which was counted for other stages
+	uint64_t otherStagesNanoseconds = 0;
+	PipelineClock::time_point passStart;
+	if(counters != nullptr)
+	{
+		otherStagesNanoseconds = counters->nanoseconds[(int) PipelineStage::Read] +
+								 counters->nanoseconds[(int) PipelineStage::Hash];
+		passStart = PipelineClock::now();
+	}
+	// the text is read in chunks which are lowercased in place, and its words are views into
+	// the chunk, so no string is built per word (or per line)
+	std::string_view separators{SEPARATORS};
+	std::vector<char> buffer(TOKENIZE_CHUNK_SIZE);
+	size_t carried = 0;
+	bool isEndOfText = false;
+	while (!isEndOfText)
+	{
+		if (carried == buffer.size())
+		{
+			// a single word fills the whole buffer, so we make room for the rest of it
+			buffer.resize(2 * buffer.size());
+		}
+		textFile.read(buffer.data() + carried, buffer.size() - carried);
+		size_t size = carried + (size_t) textFile.gcount();
+		isEndOfText = !textFile;
+		std::transform(buffer.data() + carried, buffer.data() + size, buffer.data() + carried,
+					   ::tolower);
+		std::string_view text(buffer.data(), size);
+		carried = 0;
+		size_t startOfWord = 0;
+		while ((startOfWord = text.find_first_not_of(separators, startOfWord)) !=
+			   std::string_view::npos)
+		{
+			size_t endOfWord = text.find_first_of(separators, startOfWord);
+			if (endOfWord == std::string_view::npos && !isEndOfText)
 			{
+				// the word may go on in the next chunk, so we move it to the start of the buffer
+				carried = size - startOfWord;
+				std::memmove(buffer.data(), buffer.data() + startOfWord, carried);
 				break;
 			}
-			// now we will look for the next separator
-			tempEndOfWord = tempLine.find_first_of(separator, tempStartOfWord);
-			//now we will create the next word
-			std :: string tempWord(tempLine.substr(tempStartOfWord,
-					                               tempEndOfWord - tempStartOfWord));
-			toLowercase(tempWord); //we convert word to lowercase
-			if(frequentWordsSet.count(tempWord))
+			countWord(text.substr(startOfWord, endOfWord - startOfWord), mapWords, frequentWords,
+					  features, counters);
+			if (endOfWord == std::string_view::npos)
 			{
-				mapWords[tempWord]++;
-			}
-			// now we will update the position of the start of next word to be after the separator
-			tempStartOfWord = tempEndOfWord + 1;
+				break;
 			}
-		while (tempEndOfWord != std :: string :: npos); // continue as long as there are lines
+			startOfWord = endOfWord + 1;
+		}
+	}
+	if(counters != nullptr)
+	{
+		otherStagesNanoseconds = counters->nanoseconds[(int) PipelineStage::Read] +
+								 counters->nanoseconds[(int) PipelineStage::Hash] -
+								 otherStagesNanoseconds;
+		counters->addTime(PipelineStage::Tokenize, passStart, PipelineClock::now());
+		counters->nanoseconds[(int) PipelineStage::Tokenize] -= otherStagesNanoseconds;
+	}
+}
+
+/**
+ * This function counts a (lowercase) word of the author text.
+ * @param word - the word, a view into the chunk of the text.
+ * @param mapWords - the map where we save the words and how many times they appear in
+ * the text.
+ * @param frequentWords - this is the frequent words, looked up through their hash set.
+ * @param features - if not null, the n-gram features of the text are gathered into it.
+ * @param counters - if not null, the tokenizing statistics of the text are added to it.
+ */
+void VectorParser::countWord(std::string_view word, WordCountMap& mapWords,
+							 const FrequentWords& frequentWords, StylometryFeatures* features,
+							 PipelineCounters* counters)
+{
+	if(features != nullptr)
+	{
+		StageTimer timer(counters, PipelineStage::Hash);
+		features->addWord(word);
+	}
+	// we count the word under the arena view of it, which outlives the chunk of the text
+	const std::string_view *frequentWord =
+		frequentWords.find(word, counters != nullptr ? &counters->hashProbes : nullptr);
+	bool isFrequentWord = frequentWord != nullptr;
+	if(isFrequentWord)
+	{
+		mapWords[*frequentWord]++;
+	}
+	if(counters != nullptr)
+	{
+		counters->tokens++;
+		counters->vocabularyHits += isFrequentWord;
 	}
 }
 
 /**
  * This function calculates the int vector (signature) of the author.
- * @param frequentWordsVector - this is the frequent words stored as a vector of strings.
+ * @param frequentWords - this is the frequent words, in the order of the file.
  * @param signature - the signature that we return.
  * @param mapWords - the map of the author text.
  */
-void VectorParser :: createSignature(std::vector<std::string>& frequentWordsVector,
+void VectorParser :: createSignature(const FrequentWords& frequentWords,
 		                             std::vector<int>& signature,
-		                             std::unordered_map<std::string, int>& mapWords)
+		                             const WordCountMap& mapWords)
 {
 	int j = 0;
 
-	for (StringVectorIterator i = frequentWordsVector.begin();
-		 i != frequentWordsVector.end(); ++i)
+	for (FrequentWordsIterator i = frequentWords.words().begin();
+		 i != frequentWords.words().end(); ++i)
 	{
-		signature[j] = mapWords[*i];
+		// we look the word up without inserting it, so absent words cost no map node
+		WordCountMap::const_iterator count = mapWords.find(*i);
+		signature[j] = count != mapWords.end() ? count->second : 0;
 		++j;
 	}
 }
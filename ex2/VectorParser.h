@@ -12,12 +12,17 @@
 #include <unordered_set>
 #include <unordered_map>
 #include <algorithm>
+#include <string_view>
+#include "StylometryFeatures.h"
+#include "FrequentWords.h"
+#include "PipelineStats.h"
 //================================ Code Segment =================================================
 
 /**
- * This type represents the type of an iterator of a vector of strings.
+ * This type represents the map of a text from a frequent word to the number of its appearances.
+ * The keys are views into the frequent words arena, so counting a word never allocates a string.
  */
-typedef std::vector<std::string>::const_iterator StringVectorIterator;
+typedef std::unordered_map<std::string_view, int> WordCountMap;
 
 /**
  * This class represents a parser which parses and maps files to vectors of
@@ -29,32 +34,40 @@ class VectorParser
 	public:
 
 	/**
-	 * This function parses the frequent words file to its words ans saves them in a vector.
+	 * This function parses the frequent words file to its words and saves them in a single arena
+	 * which is shared by the ordered list of words and the set of words.
 	 * @param file - the frequent words input file.
-	 * @param frequentWordsVec - the vector which stores all the words.
+	 * @param frequentWords - the frequent words which store all the words.
 	 */
-	static void getFrequentWords(std::ifstream& file, std::vector<std::string>& frequentWordsVec);
+	static void getFrequentWords(std::istream& file, FrequentWords& frequentWords);
 
 	/**
 	 * This function parses and maps all the words from the author text file, and counts only
-	 * those which are also in the frequent words set.
-	 * @param textFile - the input author text file.
+	 * those which are also in the frequent words set. The words are views into the chunk of the
+	 * text which was read, so no string is built per word.
+	 * @param textFile - the input author text file (already decompressed if it was compressed).
 	 * @param mapWords - the map where we save the words and how many times they appear in
 	 * the text.
-	 * @param frequentWordsSet - this is the frequent words stored as an unordered set.
+	 * @param frequentWords - this is the frequent words, looked up through their hash set.
+	 * @param features - if not null, the n-gram features of the text are gathered into it
+	 * during the same pass.
+	 * @param counters - if not null, the tokenizing statistics of the text are added to it.
+	 * Time spent inside the stream is left to the stream to count (see DecompressingStream).
 	 */
-	static void mapText(std::ifstream& textFile, std::unordered_map<std::string, int>& mapWords,
-						std::unordered_set<std::string>& frequentWordsSet);
+	static void mapText(std::istream& textFile, WordCountMap& mapWords,
+						const FrequentWords& frequentWords,
+						StylometryFeatures* features = nullptr,
+						PipelineCounters* counters = nullptr);
 
 	/**
 	 * This function calculates the int vector (signature) of the author.
-	 * @param frequentWordsVector - this is the frequent words stored as a vector of strings.
+	 * @param frequentWords - this is the frequent words, in the order of the file.
 	 * @param signature - the signature that we return.
 	 * @param mapWords - the map of the author text.
 	 */
-	static void createSignature(std::vector<std::string>& frequentWordsVector,
+	static void createSignature(const FrequentWords& frequentWords,
 			                    std::vector<int>& signature,
-			                    std::unordered_map<std::string, int>& mapWords);
+			                    const WordCountMap& mapWords);
 
 	/**
 	 * This function gets a string and convert each character of it to lowercase.
@@ -64,6 +77,19 @@ class VectorParser
 
 	private:
 
+	/**
+	 * This function counts a (lowercase) word of the author text.
+	 * @param word - the word, a view into the chunk of the text.
+	 * @param mapWords - the map where we save the words and how many times they appear in
+	 * the text.
+	 * @param frequentWords - this is the frequent words, looked up through their hash set.
+	 * @param features - if not null, the n-gram features of the text are gathered into it.
+	 * @param counters - if not null, the tokenizing statistics of the text are added to it.
+	 */
+	static void countWord(std::string_view word, WordCountMap& mapWords,
+						  const FrequentWords& frequentWords, StylometryFeatures* features,
+						  PipelineCounters* counters);
+
 };
 
 
@@ -1,53 +1,82 @@
 //================================ Includes =====================================================
 #include "VectorParser.h"
-#include <numeric>
-#include <math.h>
+#include "DecompressingStream.h"
+#include "SignatureSimilarity.h"
 //================================ Constants ====================================================
 #define PRINT_BEST_MATCHING_RESULT "Best matching author is "
 #define PRINT_SCORE " score "
 #define SPACE " "
-#define NOT_ENOUGH_ARGUMENTS_ERROR "Usage: find_the_author<frequent_words.txt> <text1> ...\n"
+#define NOT_ENOUGH_ARGUMENTS_ERROR "Usage: find_the_author [--ngrams] [--stats] " \
+								   "<frequent_words.txt> <text1> ...\n"
+#define NGRAMS_OPTION "--ngrams"
+#define STATS_OPTION "--stats"
+#define FREQUENT_WORDS_SCORE_WEIGHT 0.5
+#define WORD_BIGRAMS_SCORE_WEIGHT 0.25
+#define CHARACTER_NGRAMS_SCORE_WEIGHT 0.25
 #define MINIMAL_NUMBER_OF_ARGUMENTS 4
 #define FIRST_KNOWN_AUTHOR_INDEX 3
 #define UNKNOWN_AUTHOR_INDEX 2
 #define FREQUENT_WORDS_FILE_INDEX 1
 #define EXIT_RETURN_VALUE_FOR_USAGE_ERROR 0
+#define IN_FILE " in "
 //================================ Code Segment =================================================
 
 /**
- * This function calculates the l2-norm of a vector of ints.
- * @param vector - the int vector which we calculate its norm.
- * @return the l2_norm of a vector of ints.
+ * This function calculates the score of a known author text. Without n-gram features this is
+ * the cos angle between the frequent words signatures. With n-gram features it is a weighted
+ * average of the cos angles of all the feature families.
+ * @param unknownSignature - the signature of the unknown author.
+ * @param knownSignature - the signature of the known author.
+ * @param normOfUnknownSignature - the norm of the signature of the unknown author.
+ * @param unknownFeatures - the n-gram features of the unknown author, or null if disabled.
+ * @param knownFeatures - the n-gram features of the known author, or null if disabled.
+ * @return the score of the known author text.
  */
-double l2Norm(std::vector<int> const &vector)
+double calculateScore(std::vector<int> const &unknownSignature,
+					  std::vector<int> const &knownSignature,
+					  double const normOfUnknownSignature,
+					  StylometryFeatures const *unknownFeatures,
+					  StylometryFeatures const *knownFeatures)
 {
-	double resultSquared = inner_product(std::begin(vector), std::end(vector),
-			                             std::begin(vector), 0.0);
-	return sqrt(resultSquared);
+	double score = calculateCosThetaAngle(unknownSignature, knownSignature,
+										  normOfUnknownSignature);
+	if(unknownFeatures == nullptr || knownFeatures == nullptr)
+	{
+		return score;
+	}
+	std::vector<int> const &unknownBigrams = unknownFeatures->wordBigrams();
+	std::vector<int> const &unknownNgrams = unknownFeatures->characterNgrams();
+	return FREQUENT_WORDS_SCORE_WEIGHT * score +
+		   WORD_BIGRAMS_SCORE_WEIGHT * calculateCosThetaAngle(unknownBigrams,
+				                                              knownFeatures->wordBigrams(),
+				                                              l2Norm(unknownBigrams)) +
+		   CHARACTER_NGRAMS_SCORE_WEIGHT * calculateCosThetaAngle(unknownNgrams,
+				                                                  knownFeatures->characterNgrams(),
+				                                                  l2Norm(unknownNgrams));
 }
 
 /**
- * This function calculates the cos angle between two int vectors, while the norm of the first
- * vector is already known. If one of the norms equals zero - we return zero, in order not to
- * divide by zero.
- * @param firstVector - the first input int vector.
- * @param secondVector - the second input int vector.
- * @param normOfFirstVector - the norm of the first vector.
- * @return the cos angle between two int vectors.
+ * This function adds an input file to the statistics, if the statistics are enabled.
+ * @param stats - the statistics of the run, or null if disabled.
+ * @param fileName - the name of the input file.
+ * @return the counters of the file, or null if the statistics are disabled.
  */
-double calculateCosThetaAngle(std::vector<int>& firstVector,
-						      std::vector<int>& secondVector, double const normOfFirstVector)
+PipelineCounters *addFileCounters(PipelineStats *stats, char const *fileName)
 {
-	double normOfSecondVector = l2Norm(secondVector);
+	return stats != nullptr ? &stats->addFile(fileName) : nullptr;
+}
 
-	if(normOfFirstVector == 0 || normOfSecondVector == 0)
+/**
+ * This function reports a decompression error of an input file, if there was one.
+ * @param file - the input file stream, after it was consumed.
+ * @param fileName - the name of the input file.
+ */
+void reportDecompressionError(DecompressingStream const &file, char const *fileName)
+{
+	if(file.hasDecompressionError())
 	{
-		return 0;
+		std::cerr << file.decompressionError() << IN_FILE << fileName << std::endl;
 	}
-	double scalarProduct = inner_product(std::begin(firstVector),
-										 std::end(firstVector),
-										 std::begin(secondVector), 0.0);
-	return scalarProduct / (normOfFirstVector * normOfSecondVector);
 }
 
 /**
@@ -55,28 +84,45 @@ double calculateCosThetaAngle(std::vector<int>& firstVector,
  * @param argc - argument counter for input
  * @param argv - argument values for input
  * @param sizeOfSignature - size of frequent words vector.
- * @param frequentWordsSet - frequent words stored as a set.
- * @param frequentWordsVector - frequent words stored as a vector.
+ * @param frequentWords - the frequent words.
  * @param signatureOfUnknownAuthor - the signature of the unknown input author.
  * @param normOfUnknownAuthorVector - the l2-norm of the unknown input author.
+ * @param unknownAuthorFeatures - the n-gram features of the unknown input author, or null if
+ * n-gram features are disabled.
+ * @param stats - the statistics of the run, or null if disabled.
  */
 void printResults(int const argc, char const *argv[], unsigned long const sizeOfSignature,
-		          std::unordered_set<std::string>& frequentWordsSet,
-				  std::vector<std::string>& frequentWordsVector,
+		          FrequentWords const &frequentWords,
 				  std::vector<int>& signatureOfUnknownAuthor,
-				  double const normOfUnknownAuthorVector)
+				  double const normOfUnknownAuthorVector,
+				  StylometryFeatures const *unknownAuthorFeatures, PipelineStats *stats)
 {
 	double bestScore = 0;
 	std::string bestAuthor;
 	for(int fileIndex = FIRST_KNOWN_AUTHOR_INDEX ; fileIndex < argc ; ++fileIndex)
 	{
-		std::unordered_map<std::string, int> mapTempFile;
-		std::ifstream tempFile(argv[fileIndex]);
+		WordCountMap mapTempFile;
+		DecompressingStream tempFile(argv[fileIndex]);
+		PipelineCounters *tempCounters = addFileCounters(stats, argv[fileIndex]);
+		tempFile.setCounters(tempCounters);
 		std::vector<int> tempSignature(sizeOfSignature, 0);
-		VectorParser::mapText(tempFile, mapTempFile, frequentWordsSet);
-		VectorParser::createSignature(frequentWordsVector, tempSignature, mapTempFile);
-		double tempScore = calculateCosThetaAngle(signatureOfUnknownAuthor, tempSignature,
-				                                  normOfUnknownAuthorVector);
+		StylometryFeatures tempFeatures;
+		StylometryFeatures *tempFeaturesPointer =
+				unknownAuthorFeatures != nullptr ? &tempFeatures : nullptr;
+		VectorParser::mapText(tempFile, mapTempFile, frequentWords, tempFeaturesPointer,
+							  tempCounters);
+		reportDecompressionError(tempFile, argv[fileIndex]);
+		{
+			StageTimer timer(tempCounters, PipelineStage::Signature);
+			VectorParser::createSignature(frequentWords, tempSignature, mapTempFile);
+		}
+		double tempScore;
+		{
+			StageTimer timer(tempCounters, PipelineStage::Scoring);
+			tempScore = calculateScore(signatureOfUnknownAuthor, tempSignature,
+									   normOfUnknownAuthorVector, unknownAuthorFeatures,
+									   tempFeaturesPointer);
+		}
 		std::cout << argv[fileIndex] << SPACE << tempScore << std::endl;
 		if(tempScore > bestScore)
 		{
@@ -89,21 +135,6 @@ void printResults(int const argc, char const *argv[], unsigned long const sizeOf
 	std::endl;
 }
 
-/**
- * This function gets the frequent words stored as a vector and saves them in
- * an unordered set.
- * @param frequentWordsVector - the frequent words stored as a vector.
- * @param frequentWordsSet - the frequent words stored as a set.
- */
-void createFrequentWordsUnorderedSet(const std::vector<std::string>& frequentWordsVector,
-		                             std::unordered_set<std::string>& frequentWordsSet)
-{
-	for (const auto &i : frequentWordsVector)
-	{
-		frequentWordsSet.insert(i);
-	}
-}
-
 /**
  * This function checks if there are enough input arguments.
  * If not: exit with exit failure. otherwise: don't do anything.
@@ -118,6 +149,37 @@ void checkNumOfArgs(int const numOfArgs)
 	}
 }
 
+/**
+ * This function consumes the options which come before the input files.
+ * @param argc - argument counter for input, updated to exclude the options.
+ * @param argv - argument values for input, updated to exclude the options.
+ * @param useNgrams - set to true if the n-gram features option was given.
+ * @param printStats - set to true if the statistics option was given.
+ */
+void parseOptions(int &argc, char const **&argv, bool &useNgrams, bool &printStats)
+{
+	while(argc > FREQUENT_WORDS_FILE_INDEX)
+	{
+		std::string option(argv[FREQUENT_WORDS_FILE_INDEX]);
+		if(option == NGRAMS_OPTION)
+		{
+			useNgrams = true;
+		}
+		else if(option == STATS_OPTION)
+		{
+			printStats = true;
+		}
+		else
+		{
+			break;
+		}
+		// we shift the program name over the option, so the input indices stay the same
+		argv[FREQUENT_WORDS_FILE_INDEX] = argv[0];
+		++argv;
+		--argc;
+	}
+}
+
 /**
  * This is the main function of the program. it parses all the input data,
  * stores the words in a map and calculates and prints all the results.
@@ -125,26 +187,59 @@ void checkNumOfArgs(int const numOfArgs)
  * @param argv - argument values for input
  * @return 0 if succeeds, non-zero otherwise.
  */
-int main(int const argc, char const *argv[])
+int main(int argc, char const *argv[])
 {
+	bool useNgrams = false;
+	bool printStats = false;
+	parseOptions(argc, argv, useNgrams, printStats);
 	checkNumOfArgs(argc);
-	std::ifstream frequentWordsFile(argv[FREQUENT_WORDS_FILE_INDEX]);
-	std::vector<std::string> frequentWordsVector;
-	std::unordered_map<std::string, int> mapUnknownAuthor;
-	std::ifstream unknownAuthorFile(argv[UNKNOWN_AUTHOR_INDEX]);
-	VectorParser::getFrequentWords(frequentWordsFile, frequentWordsVector);
-	std::unordered_set<std::string> frequentWordsSet;
-	//create unordered set of frequent words
-	createFrequentWordsUnorderedSet(frequentWordsVector, frequentWordsSet);
+	PipelineStats stats;
+	PipelineStats *statsPointer = printStats ? &stats : nullptr;
+	DecompressingStream frequentWordsFile(argv[FREQUENT_WORDS_FILE_INDEX]);
+	PipelineCounters *frequentWordsCounters = addFileCounters(statsPointer,
+															  argv[FREQUENT_WORDS_FILE_INDEX]);
+	frequentWordsFile.setCounters(frequentWordsCounters);
+	FrequentWords frequentWords;
+	WordCountMap mapUnknownAuthor;
+	DecompressingStream unknownAuthorFile(argv[UNKNOWN_AUTHOR_INDEX]);
+	PipelineCounters *unknownAuthorCounters = addFileCounters(statsPointer,
+															  argv[UNKNOWN_AUTHOR_INDEX]);
+	unknownAuthorFile.setCounters(unknownAuthorCounters);
+	//load the frequent words into one arena shared by their vector and their unordered set
+	{
+		StageTimer timer(frequentWordsCounters, PipelineStage::Vocabulary);
+		VectorParser::getFrequentWords(frequentWordsFile, frequentWords);
+	}
+	if(frequentWordsCounters != nullptr)
+	{
+		// the vocabulary stage excludes the time spent waiting for the file
+		frequentWordsCounters->nanoseconds[(int) PipelineStage::Vocabulary] -=
+				frequentWordsCounters->nanoseconds[(int) PipelineStage::Read];
+	}
+	reportDecompressionError(frequentWordsFile, argv[FREQUENT_WORDS_FILE_INDEX]);
 	//count words from frequent words set in text by using an unordered map
-	VectorParser::mapText(unknownAuthorFile, mapUnknownAuthor, frequentWordsSet);
-	unsigned long sizeOfVector = (long) frequentWordsVector.size();
+	StylometryFeatures unknownAuthorFeatures;
+	StylometryFeatures *unknownAuthorFeaturesPointer = useNgrams ? &unknownAuthorFeatures : nullptr;
+	VectorParser::mapText(unknownAuthorFile, mapUnknownAuthor, frequentWords,
+						  unknownAuthorFeaturesPointer, unknownAuthorCounters);
+	reportDecompressionError(unknownAuthorFile, argv[UNKNOWN_AUTHOR_INDEX]);
+	unsigned long sizeOfVector = (long) frequentWords.size();
 	std::vector<int> vectorOfUnknownAuthor(sizeOfVector, 0);
-	VectorParser::createSignature(frequentWordsVector, vectorOfUnknownAuthor, mapUnknownAuthor);
-	double normOfUnknownAuthorVector = l2Norm(vectorOfUnknownAuthor);
+	double normOfUnknownAuthorVector;
+	{
+		StageTimer timer(unknownAuthorCounters, PipelineStage::Signature);
+		VectorParser::createSignature(frequentWords, vectorOfUnknownAuthor,
+									  mapUnknownAuthor);
+		normOfUnknownAuthorVector = l2Norm(vectorOfUnknownAuthor);
+	}
 
 	//print all the results
-	printResults(argc, argv, sizeOfVector, frequentWordsSet, frequentWordsVector,
-			     vectorOfUnknownAuthor, normOfUnknownAuthorVector);
+	printResults(argc, argv, sizeOfVector, frequentWords,
+			     vectorOfUnknownAuthor, normOfUnknownAuthorVector, unknownAuthorFeaturesPointer,
+			     statsPointer);
+	if(printStats)
+	{
+		stats.writeJson(std::cerr);
+	}
 	return 0;
 }
\ No newline at end of file
@@ -0,0 +1,22 @@
+//================================ Includes =====================================================
+#include "Complex.h"
+//================================ Code Segment =================================================
+
+std :: ostream& operator<<(std :: ostream& os, const Complex& c)
+{
+	if(std :: signbit(c._imaginary))
+	{
+		return os << c._real << " - " << -c._imaginary << "i";
+	}
+	return os << c._real << " + " << c._imaginary << "i";
+}
+
+std :: istream& operator>>(std :: istream& is, Complex& c)
+{
+	double real, imaginary;
+	if(is >> real >> imaginary)
+	{
+		c = Complex(real, imaginary);
+	}
+	return is;
+}
@@ -0,0 +1,238 @@
+//================================ Includes =====================================================
+#include <cmath>
+#include <iostream>
+#include <type_traits>
+//================================ Constants ====================================================
+#ifndef CPP3_COMPLEX_H
+#define CPP3_COMPLEX_H
+#define COMPLEX_LAYOUT_ERROR "A Complex must be stored as its real and imaginary parts"
+//================================ Code Segment =================================================
+
+/**
+ * This class represents a complex number. It is stored interleaved - the real part followed by
+ * the imaginary part, like std::complex<double> - so an array of Complex is also an array of
+ * doubles, which the complex GEMM multiplies with the real SIMD kernel. All the arithmetic is
+ * inline, so the generic kernels compile it to plain floating point operations.
+ */
+class Complex
+{
+	public:
+
+	/**
+	 * This constructor initializes a complex number. It converts a real number implicitly.
+	 * @param real - the real part.
+	 * @param imaginary - the imaginary part.
+	 */
+	constexpr Complex(double real = 0, double imaginary = 0) : _real(real), _imaginary(imaginary)
+	{
+
+	}
+
+	/**
+	 * This method returns the real part.
+	 * @return the real part.
+	 */
+	constexpr double real() const
+	{
+		return _real;
+	}
+
+	/**
+	 * This method returns the imaginary part.
+	 * @return the imaginary part.
+	 */
+	constexpr double imag() const
+	{
+		return _imaginary;
+	}
+
+	/**
+	 * This method returns the conjugate.
+	 * @return the conjugate.
+	 */
+	constexpr Complex conj() const
+	{
+		return Complex(_real, -_imaginary);
+	}
+
+	/**
+	 * This method returns the squared absolute value.
+	 * @return real^2 + imaginary^2.
+	 */
+	constexpr double norm() const
+	{
+		return _real * _real + _imaginary * _imaginary;
+	}
+
+	/**
+	 * This method returns the absolute value, without overflow of the squares.
+	 * @return the absolute value.
+	 */
+	double abs() const
+	{
+		return std :: hypot(_real, _imaginary);
+	}
+
+	/**
+	 * This method adds a complex number to this one.
+	 * @param other - the complex number.
+	 * @return this complex number.
+	 */
+	Complex& operator+=(const Complex& other)
+	{
+		_real += other._real;
+		_imaginary += other._imaginary;
+		return *(this);
+	}
+
+	/**
+	 * This method subtracts a complex number from this one.
+	 * @param other - the complex number.
+	 * @return this complex number.
+	 */
+	Complex& operator-=(const Complex& other)
+	{
+		_real -= other._real;
+		_imaginary -= other._imaginary;
+		return *(this);
+	}
+
+	/**
+	 * This method multiplies this complex number by another one.
+	 * @param other - the complex number.
+	 * @return this complex number.
+	 */
+	Complex& operator*=(const Complex& other)
+	{
+		double real = _real * other._real - _imaginary * other._imaginary;
+		_imaginary = _real * other._imaginary + _imaginary * other._real;
+		_real = real;
+		return *(this);
+	}
+
+	/**
+	 * This method divides this complex number by another one. The divisor is scaled by its
+	 * larger part first (Smith's algorithm), so the division does not overflow or underflow
+	 * where the quotient is representable.
+	 * @param other - the divisor.
+	 * @return this complex number.
+	 */
+	Complex& operator/=(const Complex& other)
+	{
+		double real, imaginary;
+		if(std :: fabs(other._real) >= std :: fabs(other._imaginary))
+		{
+			double ratio = other._imaginary / other._real;
+			double denominator = other._real + other._imaginary * ratio;
+			real = (_real + _imaginary * ratio) / denominator;
+			imaginary = (_imaginary - _real * ratio) / denominator;
+		}
+		else
+		{
+			double ratio = other._real / other._imaginary;
+			double denominator = other._real * ratio + other._imaginary;
+			real = (_real * ratio + _imaginary) / denominator;
+			imaginary = (_imaginary * ratio - _real) / denominator;
+		}
+		_real = real;
+		_imaginary = imaginary;
+		return *(this);
+	}
+
+	/**
+	 * This method returns the negation.
+	 * @return -this.
+	 */
+	constexpr Complex operator-() const
+	{
+		return Complex(-_real, -_imaginary);
+	}
+
+	/**
+	 * This method adds two complex numbers.
+	 * @return the sum.
+	 */
+	friend Complex operator+(Complex left, const Complex& right)
+	{
+		return left += right;
+	}
+
+	/**
+	 * This method subtracts two complex numbers.
+	 * @return the difference.
+	 */
+	friend Complex operator-(Complex left, const Complex& right)
+	{
+		return left -= right;
+	}
+
+	/**
+	 * This method multiplies two complex numbers.
+	 * @return the product.
+	 */
+	friend Complex operator*(Complex left, const Complex& right)
+	{
+		return left *= right;
+	}
+
+	/**
+	 * This method divides two complex numbers.
+	 * @return the quotient.
+	 */
+	friend Complex operator/(Complex left, const Complex& right)
+	{
+		return left /= right;
+	}
+
+	/**
+	 * This method compares two complex numbers.
+	 * @return true if both parts are equal.
+	 */
+	friend constexpr bool operator==(const Complex& left, const Complex& right)
+	{
+		return left._real == right._real && left._imaginary == right._imaginary;
+	}
+
+	/**
+	 * This method compares two complex numbers.
+	 * @return true if a part differs.
+	 */
+	friend constexpr bool operator!=(const Complex& left, const Complex& right)
+	{
+		return !(left == right);
+	}
+
+	/**
+	 * This method prints a complex number as "real + imaginaryi" (or "real - |imaginary|i").
+	 * @param os - the output stream.
+	 * @param c - the complex number.
+	 * @return the output stream.
+	 */
+	friend std :: ostream& operator<<(std :: ostream& os, const Complex& c);
+
+	/**
+	 * This method reads a complex number as its real and imaginary parts, separated by spaces.
+	 * @param is - the input stream.
+	 * @param c - the complex number.
+	 * @return the input stream.
+	 */
+	friend std :: istream& operator>>(std :: istream& is, Complex& c);
+
+	private:
+
+	/**
+	 * The real part.
+	 */
+	double _real;
+
+	/**
+	 * The imaginary part.
+	 */
+	double _imaginary;
+
+};
+
+static_assert(std :: is_standard_layout<Complex>::value && sizeof(Complex) == 2 * sizeof(double),
+			  COMPLEX_LAYOUT_ERROR);
+
+#endif
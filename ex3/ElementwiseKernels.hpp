@@ -0,0 +1,591 @@
+//================================ Includes =====================================================
+#include "Complex.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+//================================ Constants ====================================================
+#ifndef CPP3_ELEMENTWISE_KERNELS_H
+#define CPP3_ELEMENTWISE_KERNELS_H
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define ELEMENTWISE_RUNTIME_DISPATCH 1
+#else
+#define ELEMENTWISE_RUNTIME_DISPATCH 0
+#endif
+#define AVX512_VECTOR_BYTES 64
+#define AVX2_VECTOR_BYTES 32
+#define BASELINE_VECTOR_BYTES 16
+#define ELEMENTWISE_UNROLL 4
+//================================ Code Segment =================================================
+
+/**
+ * This enum represents the SIMD instruction sets which the element-wise kernels can use.
+ */
+enum class SimdLevel
+{
+	Baseline,
+	Avx2,
+	Avx512
+};
+
+/**
+ * This function detects (once) the widest SIMD instruction set of the running CPU, so the same
+ * binary uses AVX-512 or AVX2 when the CPU has them, and the baseline vectors otherwise.
+ * @return the SIMD instruction set of the running CPU.
+ */
+inline SimdLevel detectSimdLevel()
+{
+#if ELEMENTWISE_RUNTIME_DISPATCH
+	static const SimdLevel level = []
+	{
+		__builtin_cpu_init();
+		if(__builtin_cpu_supports("avx512f"))
+		{
+			return SimdLevel::Avx512;
+		}
+		if(__builtin_cpu_supports("avx2"))
+		{
+			return SimdLevel::Avx2;
+		}
+		return SimdLevel::Baseline;
+	}();
+	return level;
+#else
+	return SimdLevel::Baseline;
+#endif
+}
+
+/**
+ * This class holds the SIMD element-wise kernels and reductions behind the Matrix operators.
+ * They work on contiguous arrays. For int, float and double every kernel is compiled three
+ * times, with baseline, AVX2 and AVX-512 vectors, and the widest one the CPU supports is chosen
+ * at run time. Other types run the same operations with scalar loops.
+ * @tparam T - the generic type of a coordinate in the generic matrix.
+ */
+template <class T> class ElementwiseKernels
+{
+	public:
+
+	/**
+	 * True if T has SIMD kernels.
+	 */
+	static constexpr bool IS_VECTORIZED = std::is_same<T, int>::value ||
+										  std::is_same<T, float>::value ||
+										  std::is_same<T, double>::value;
+
+	/**
+	 * This method adds two arrays: out = left + right. out may be left or right.
+	 * @param size - the size of the arrays.
+	 * @param left - the left array.
+	 * @param right - the right array.
+	 * @param out - the result array.
+	 */
+	static void add(std::size_t size, const T* left, const T* right, T* out)
+	{
+		map(size, left, right, out, AddLanes());
+	}
+
+	/**
+	 * This method subtracts two arrays: out = left - right. out may be left or right.
+	 * @param size - the size of the arrays.
+	 * @param left - the left array.
+	 * @param right - the right array.
+	 * @param out - the result array.
+	 */
+	static void subtract(std::size_t size, const T* left, const T* right, T* out)
+	{
+		map(size, left, right, out, SubtractLanes());
+	}
+
+	/**
+	 * This method multiplies two arrays coordinate by coordinate (the Hadamard product):
+	 * out = left .* right. out may be left or right.
+	 * @param size - the size of the arrays.
+	 * @param left - the left array.
+	 * @param right - the right array.
+	 * @param out - the result array.
+	 */
+	static void hadamard(std::size_t size, const T* left, const T* right, T* out)
+	{
+		map(size, left, right, out, MultiplyLanes());
+	}
+
+	/**
+	 * This method scales an array: out = values * factor. out may be values.
+	 * @param size - the size of the arrays.
+	 * @param values - the array.
+	 * @param factor - the scalar factor.
+	 * @param out - the result array.
+	 */
+	static void scale(std::size_t size, const T* values, const T& factor, T* out)
+	{
+		map(size, values, values, out, ScaleLanes{factor});
+	}
+
+	/**
+	 * This method adds a scaled array to another array: y = alpha * x + y.
+	 * @param size - the size of the arrays.
+	 * @param alpha - the scalar factor.
+	 * @param x - the scaled array.
+	 * @param y - the array which is added to.
+	 */
+	static void axpy(std::size_t size, const T& alpha, const T* x, T* y)
+	{
+		map(size, x, y, y, AxpyLanes{alpha});
+	}
+
+	/**
+	 * This method sums an array.
+	 * @param size - the size of the array.
+	 * @param values - the array.
+	 * @return the sum of the array (0 if empty).
+	 */
+	static T sum(std::size_t size, const T* values)
+	{
+		return reduce(size, values, T(0), AddLanes());
+	}
+
+	/**
+	 * This method finds the minimum of a non-empty array.
+	 * @param size - the size of the array.
+	 * @param values - the array.
+	 * @return the minimum of the array.
+	 */
+	static T min(std::size_t size, const T* values)
+	{
+		return reduce(size, values, values[0], MinLanes());
+	}
+
+	/**
+	 * This method finds the maximum of a non-empty array.
+	 * @param size - the size of the array.
+	 * @param values - the array.
+	 * @return the maximum of the array.
+	 */
+	static T max(std::size_t size, const T* values)
+	{
+		return reduce(size, values, values[0], MaxLanes());
+	}
+
+	/**
+	 * This method sums the squares of an array, in double precision. The square of a Complex
+	 * coordinate is its squared absolute value (see squaredMagnitude).
+	 * @param size - the size of the array.
+	 * @param values - the array.
+	 * @return the sum of the squares of the array.
+	 */
+	static double sumOfSquares(std::size_t size, const T* values)
+	{
+		if constexpr (IS_VECTORIZED)
+		{
+			switch(detectSimdLevel())
+			{
+				case SimdLevel::Avx512:
+					return sumOfSquaresAvx512(size, values);
+				case SimdLevel::Avx2:
+					return sumOfSquaresAvx2(size, values);
+				default:
+					return sumOfSquaresLanes<BASELINE_VECTOR_BYTES>(size, values);
+			}
+		}
+		else
+		{
+			double result = 0;
+			for(std::size_t index = 0 ; index < size ; ++index)
+			{
+				result += squaredMagnitude(values[index]);
+			}
+			return result;
+		}
+	}
+
+	private:
+
+	/**
+	 * The lane type of the SIMD vectors: T for the vectorized types, a placeholder otherwise.
+	 */
+	typedef typename std::conditional<IS_VECTORIZED, T, float>::type Lane;
+
+	/**
+	 * These methods return the square of a coordinate in double precision: re^2 + im^2 for a
+	 * Complex, and the coordinate converted to double and squared for other types.
+	 * @param value - the coordinate.
+	 * @return the square of the coordinate.
+	 */
+	static double squaredMagnitude(const Complex& value)
+	{
+		return value.norm();
+	}
+
+	template <class Other>
+	static double squaredMagnitude(const Other& value)
+	{
+		return (double) value * (double) value;
+	}
+
+	/**
+	 * This struct adds lanes (or scalars): left = left + right. The operations of the kernels
+	 * work in place on their left operand, so no vector is passed or returned by value.
+	 */
+	struct AddLanes
+	{
+		template <class V> __attribute__((always_inline))
+		void operator()(V& left, const V& right) const
+		{
+			left += right;
+		}
+	};
+
+	/**
+	 * This struct subtracts lanes (or scalars): left = left - right.
+	 */
+	struct SubtractLanes
+	{
+		template <class V> __attribute__((always_inline))
+		void operator()(V& left, const V& right) const
+		{
+			left -= right;
+		}
+	};
+
+	/**
+	 * This struct multiplies lanes (or scalars): left = left * right.
+	 */
+	struct MultiplyLanes
+	{
+		template <class V> __attribute__((always_inline))
+		void operator()(V& left, const V& right) const
+		{
+			left *= right;
+		}
+	};
+
+	/**
+	 * This struct scales lanes (or a scalar): left = left * factor.
+	 */
+	struct ScaleLanes
+	{
+		T factor;
+
+		template <class V> __attribute__((always_inline))
+		void operator()(V& left, const V&) const
+		{
+			left *= factor;
+		}
+	};
+
+	/**
+	 * This struct computes left = alpha * left + right on lanes (or scalars).
+	 */
+	struct AxpyLanes
+	{
+		T alpha;
+
+		template <class V> __attribute__((always_inline))
+		void operator()(V& left, const V& right) const
+		{
+			left = left * alpha + right;
+		}
+	};
+
+	/**
+	 * This struct takes the minimum of lanes (or scalars): left = min(left, right).
+	 */
+	struct MinLanes
+	{
+		template <class V> __attribute__((always_inline))
+		void operator()(V& left, const V& right) const
+		{
+			left = right < left ? right : left;
+		}
+	};
+
+	/**
+	 * This struct takes the maximum of lanes (or scalars): left = max(left, right).
+	 */
+	struct MaxLanes
+	{
+		template <class V> __attribute__((always_inline))
+		void operator()(V& left, const V& right) const
+		{
+			left = left < right ? right : left;
+		}
+	};
+
+	/**
+	 * This method applies a binary operation to two arrays, with the widest SIMD vectors of the
+	 * CPU: out = operation(left, right).
+	 * @tparam Operation - the type of the operation.
+	 * @param size - the size of the arrays.
+	 * @param left - the left array.
+	 * @param right - the right array.
+	 * @param out - the result array.
+	 * @param operation - the operation.
+	 */
+	template <class Operation>
+	static void map(std::size_t size, const T* left, const T* right, T* out, Operation operation)
+	{
+		if constexpr (IS_VECTORIZED)
+		{
+			switch(detectSimdLevel())
+			{
+				case SimdLevel::Avx512:
+					mapAvx512(size, left, right, out, operation);
+					return;
+				case SimdLevel::Avx2:
+					mapAvx2(size, left, right, out, operation);
+					return;
+				default:
+					mapLanes<BASELINE_VECTOR_BYTES>(size, left, right, out, operation);
+					return;
+			}
+		}
+		else
+		{
+			for(std::size_t index = 0 ; index < size ; ++index)
+			{
+				T value = left[index];
+				operation(value, right[index]);
+				out[index] = value;
+			}
+		}
+	}
+
+	/**
+	 * This method reduces an array with a binary operation, with the widest SIMD vectors of the
+	 * CPU.
+	 * @tparam Operation - the type of the operation.
+	 * @param size - the size of the array.
+	 * @param values - the array.
+	 * @param identity - the initial value of the reduction.
+	 * @param operation - the operation.
+	 * @return the reduction of the array.
+	 */
+	template <class Operation>
+	static T reduce(std::size_t size, const T* values, const T& identity, Operation operation)
+	{
+		if constexpr (IS_VECTORIZED)
+		{
+			switch(detectSimdLevel())
+			{
+				case SimdLevel::Avx512:
+					return reduceAvx512(size, values, identity, operation);
+				case SimdLevel::Avx2:
+					return reduceAvx2(size, values, identity, operation);
+				default:
+					return reduceLanes<BASELINE_VECTOR_BYTES>(size, values, identity, operation);
+			}
+		}
+		else
+		{
+			T result = identity;
+			for(std::size_t index = 0 ; index < size ; ++index)
+			{
+				operation(result, values[index]);
+			}
+			return result;
+		}
+	}
+
+	/**
+	 * This method is the body of map, for SIMD vectors of BYTES bytes. It is always inlined, so
+	 * it is compiled for the instruction set of the function which calls it.
+	 */
+	template <unsigned BYTES, class Operation>
+	__attribute__((always_inline)) static inline void mapLanes(std::size_t size, const T* left,
+															   const T* right, T* out,
+															   Operation operation)
+	{
+		typedef Lane Vector __attribute__((vector_size(BYTES)));
+		constexpr std::size_t lanes = BYTES / sizeof(T);
+		std::size_t index = 0;
+		for( ; index + ELEMENTWISE_UNROLL * lanes <= size ; index += ELEMENTWISE_UNROLL * lanes)
+		{
+			Vector leftVectors[ELEMENTWISE_UNROLL], rightVectors[ELEMENTWISE_UNROLL];
+			std::memcpy(leftVectors, left + index, sizeof(leftVectors));
+			std::memcpy(rightVectors, right + index, sizeof(rightVectors));
+			for(unsigned vector = 0 ; vector < ELEMENTWISE_UNROLL ; ++vector)
+			{
+				operation(leftVectors[vector], rightVectors[vector]);
+			}
+			std::memcpy(out + index, leftVectors, sizeof(leftVectors));
+		}
+		for( ; index < size ; ++index)
+		{
+			T value = left[index];
+			operation(value, right[index]);
+			out[index] = value;
+		}
+	}
+
+	/**
+	 * This method is the body of reduce, for SIMD vectors of BYTES bytes. Every lane starts from
+	 * the identity, so it should be neutral (0 for a sum, a coordinate of the array for min and
+	 * max). It is always inlined, so it is compiled for the instruction set of the function
+	 * which calls it.
+	 */
+	template <unsigned BYTES, class Operation>
+	__attribute__((always_inline)) static inline T reduceLanes(std::size_t size, const T* values,
+															   const T& identity,
+															   Operation operation)
+	{
+		typedef Lane Vector __attribute__((vector_size(BYTES)));
+		constexpr std::size_t lanes = BYTES / sizeof(T);
+		T result = identity;
+		std::size_t index = 0;
+		if(size >= ELEMENTWISE_UNROLL * lanes)
+		{
+			Vector accumulators[ELEMENTWISE_UNROLL];
+			for(unsigned vector = 0 ; vector < ELEMENTWISE_UNROLL ; ++vector)
+			{
+				accumulators[vector] = Vector{} + identity;
+			}
+			for( ; index + ELEMENTWISE_UNROLL * lanes <= size ;
+				 index += ELEMENTWISE_UNROLL * lanes)
+			{
+				Vector vectors[ELEMENTWISE_UNROLL];
+				std::memcpy(vectors, values + index, sizeof(vectors));
+				for(unsigned vector = 0 ; vector < ELEMENTWISE_UNROLL ; ++vector)
+				{
+					operation(accumulators[vector], vectors[vector]);
+				}
+			}
+			T lanesOfAccumulators[ELEMENTWISE_UNROLL * lanes];
+			std::memcpy(lanesOfAccumulators, accumulators, sizeof(accumulators));
+			for(T lane : lanesOfAccumulators)
+			{
+				operation(result, lane);
+			}
+		}
+		for( ; index < size ; ++index)
+		{
+			operation(result, values[index]);
+		}
+		return result;
+	}
+
+	/**
+	 * This method is the body of sumOfSquares, for SIMD vectors of BYTES bytes. The lanes are
+	 * converted to double before they are squared. It is always inlined, so it is compiled for
+	 * the instruction set of the function which calls it.
+	 */
+	template <unsigned BYTES>
+	__attribute__((always_inline)) static inline double sumOfSquaresLanes(std::size_t size,
+																		   const T* values)
+	{
+		constexpr std::size_t lanes = BYTES / sizeof(T);
+		typedef Lane Vector __attribute__((vector_size(BYTES)));
+		typedef double WideVector __attribute__((vector_size(lanes * sizeof(double))));
+		double result = 0;
+		std::size_t index = 0;
+		if(size >= lanes)
+		{
+			WideVector accumulator = {};
+			for( ; index + lanes <= size ; index += lanes)
+			{
+				Vector vector;
+				std::memcpy(&vector, values + index, sizeof(vector));
+				WideVector wide = __builtin_convertvector(vector, WideVector);
+				accumulator += wide * wide;
+			}
+			double lanesOfAccumulator[lanes];
+			std::memcpy(lanesOfAccumulator, &accumulator, sizeof(accumulator));
+			for(double lane : lanesOfAccumulator)
+			{
+				result += lane;
+			}
+		}
+		for( ; index < size ; ++index)
+		{
+			result += (double) values[index] * (double) values[index];
+		}
+		return result;
+	}
+
+#if ELEMENTWISE_RUNTIME_DISPATCH
+	/**
+	 * These methods compile the kernels with AVX2 and AVX-512 vectors.
+	 */
+	template <class Operation> __attribute__((target("avx2")))
+	static void mapAvx2(std::size_t size, const T* left, const T* right, T* out,
+						Operation operation)
+	{
+		mapLanes<AVX2_VECTOR_BYTES>(size, left, right, out, operation);
+	}
+
+	template <class Operation> __attribute__((target("avx512f")))
+	static void mapAvx512(std::size_t size, const T* left, const T* right, T* out,
+						  Operation operation)
+	{
+		mapLanes<AVX512_VECTOR_BYTES>(size, left, right, out, operation);
+	}
+
+	template <class Operation> __attribute__((target("avx2")))
+	static T reduceAvx2(std::size_t size, const T* values, const T& identity, Operation operation)
+	{
+		return reduceLanes<AVX2_VECTOR_BYTES>(size, values, identity, operation);
+	}
+
+	template <class Operation> __attribute__((target("avx512f")))
+	static T reduceAvx512(std::size_t size, const T* values, const T& identity,
+						  Operation operation)
+	{
+		return reduceLanes<AVX512_VECTOR_BYTES>(size, values, identity, operation);
+	}
+
+	__attribute__((target("avx2")))
+	static double sumOfSquaresAvx2(std::size_t size, const T* values)
+	{
+		return sumOfSquaresLanes<AVX2_VECTOR_BYTES>(size, values);
+	}
+
+	__attribute__((target("avx512f")))
+	static double sumOfSquaresAvx512(std::size_t size, const T* values)
+	{
+		return sumOfSquaresLanes<AVX512_VECTOR_BYTES>(size, values);
+	}
+#else
+	/**
+	 * Without runtime dispatch every level runs the baseline vectors.
+	 */
+	template <class Operation>
+	static void mapAvx2(std::size_t size, const T* left, const T* right, T* out,
+						Operation operation)
+	{
+		mapLanes<BASELINE_VECTOR_BYTES>(size, left, right, out, operation);
+	}
+
+	template <class Operation>
+	static void mapAvx512(std::size_t size, const T* left, const T* right, T* out,
+						  Operation operation)
+	{
+		mapLanes<BASELINE_VECTOR_BYTES>(size, left, right, out, operation);
+	}
+
+	template <class Operation>
+	static T reduceAvx2(std::size_t size, const T* values, const T& identity, Operation operation)
+	{
+		return reduceLanes<BASELINE_VECTOR_BYTES>(size, values, identity, operation);
+	}
+
+	template <class Operation>
+	static T reduceAvx512(std::size_t size, const T* values, const T& identity,
+						  Operation operation)
+	{
+		return reduceLanes<BASELINE_VECTOR_BYTES>(size, values, identity, operation);
+	}
+
+	static double sumOfSquaresAvx2(std::size_t size, const T* values)
+	{
+		return sumOfSquaresLanes<BASELINE_VECTOR_BYTES>(size, values);
+	}
+
+	static double sumOfSquaresAvx512(std::size_t size, const T* values)
+	{
+		return sumOfSquaresLanes<BASELINE_VECTOR_BYTES>(size, values);
+	}
+#endif
+
+};
+
+#endif
@@ -0,0 +1,1086 @@
+//================================ Includes =====================================================
+#include "ElementwiseKernels.hpp"
+#include "Matrix.hpp"
+#include "MatrixView.hpp"
+#include "ThreadPool.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+//================================ Constants ====================================================
+#ifndef CPP3_LINEAR_SOLVERS_H
+#define CPP3_LINEAR_SOLVERS_H
+#define SOLVER_BLOCK 64u
+#define UNSUPPORTED_SOLVER_TYPE_ERROR "The decompositions need real or Complex coordinates"
+#define NON_SQUARE_DECOMPOSITION_ERROR "The decomposition is only defined for a squared matrix"
+#define QR_DIMENSIONS_ERROR "The QR decomposition needs at least as many rows as columns"
+#define SINGULAR_MATRIX_ERROR "The matrix is singular"
+#define NOT_POSITIVE_DEFINITE_ERROR "The matrix is not positive definite"
+//================================ Code Segment =================================================
+
+/**
+ * This file adds dense decompositions of Matrix<T>: LU with partial pivoting, Cholesky and
+ * Householder QR, each with determinant, inverse and solve for several right hand sides at
+ * once. They are blocked: a narrow panel of SOLVER_BLOCK columns is factored at a time, and the
+ * rest of the matrix is updated by products of views (see MatrixView.hpp), so most of the work
+ * runs in the packed GEMM on the threads of the global thread pool. Complex matrices use the
+ * conjugate transpose of Matrix<T>::trans() wherever a real matrix uses its transpose.
+ */
+
+/**
+ * This enum represents how the work of a panel (the rank-1 updates of the factored columns and
+ * the triangular solves of the next rows or columns) runs: on the calling thread, or split on
+ * the threads of the global thread pool. The updates of the rest of the matrix are products,
+ * which always use the thread pool.
+ */
+enum class PanelUpdate
+{
+	Serial,
+	Parallel
+};
+
+/**
+ * This class holds the kernels shared by the decompositions.
+ * @tparam T - the generic type of a coordinate: a floating point type or Complex.
+ */
+template <class T> class SolverKernels
+{
+	public:
+
+	/**
+	 * True if the decompositions support T.
+	 */
+	static constexpr bool IS_SUPPORTED = std :: is_floating_point<T>::value ||
+										 std :: is_same<T, Complex>::value;
+
+	static_assert(IS_SUPPORTED, UNSUPPORTED_SOLVER_TYPE_ERROR);
+
+	/**
+	 * This method returns the conjugate of a coordinate (the coordinate itself if it is real).
+	 * @param coord - the coordinate.
+	 * @return the conjugate.
+	 */
+	static T conjugate(const T& coord)
+	{
+		if constexpr (std :: is_same<T, Complex>::value)
+		{
+			return coord.conj();
+		}
+		else
+		{
+			return coord;
+		}
+	}
+
+	/**
+	 * This method returns the real part of a coordinate.
+	 * @param coord - the coordinate.
+	 * @return the real part.
+	 */
+	static double realPart(const T& coord)
+	{
+		if constexpr (std :: is_same<T, Complex>::value)
+		{
+			return coord.real();
+		}
+		else
+		{
+			return coord;
+		}
+	}
+
+	/**
+	 * This method returns the imaginary part of a coordinate (0 if it is real).
+	 * @param coord - the coordinate.
+	 * @return the imaginary part.
+	 */
+	static double imaginaryPart(const T& coord)
+	{
+		if constexpr (std :: is_same<T, Complex>::value)
+		{
+			return coord.imag();
+		}
+		else
+		{
+			(void) coord;
+			return 0;
+		}
+	}
+
+	/**
+	 * This method returns the squared absolute value of a coordinate.
+	 * @param coord - the coordinate.
+	 * @return |coord|^2.
+	 */
+	static double squaredMagnitude(const T& coord)
+	{
+		return realPart(coord) * realPart(coord) + imaginaryPart(coord) * imaginaryPart(coord);
+	}
+
+	/**
+	 * This method runs chunk(begin, end) on ranges which cover [0, size): on the threads of the
+	 * global thread pool in the parallel mode, as one range on the calling thread otherwise.
+	 * @tparam Chunk - the type of the chunk function.
+	 * @param mode - the panel update mode.
+	 * @param size - the size of the range.
+	 * @param width - the number of coordinates of a unit of the range (such as a row).
+	 * @param chunk - called with every range.
+	 */
+	template <class Chunk>
+	static void forRanges(PanelUpdate mode, std :: size_t size, std :: size_t width,
+						  const Chunk& chunk)
+	{
+		if(mode == PanelUpdate::Parallel)
+		{
+			std :: size_t minimalChunk = PARALLEL_ELEMENTWISE_CHUNK / (width + 1);
+			ThreadPool::instance().parallelRanges(size, std :: max<std :: size_t>(minimalChunk, 1),
+												  chunk);
+		}
+		else
+		{
+			chunk(0, size);
+		}
+	}
+
+	/**
+	 * This method solves L * X = B in place of B, for a lower triangular L (only its lower
+	 * triangle is read). Blocks of SOLVER_BLOCK rows are solved by substitution, split by
+	 * columns of B, and every solved block is subtracted from the next rows by a GEMM.
+	 * @param l - the triangular matrix.
+	 * @param x - B on input, X on output; a row-major view.
+	 * @param isUnitDiagonal - true if the diagonal of L is taken as ones (and not read).
+	 * @param mode - the panel update mode.
+	 */
+	static void solveLower(const ConstMatrixView<T>& l, const MatrixView<T>& x,
+						   bool isUnitDiagonal, PanelUpdate mode)
+	{
+		unsigned int size = l.rows(), numOfCols = x.cols();
+		for(unsigned int block = 0 ; block < size ; block += SOLVER_BLOCK)
+		{
+			unsigned int blockSize = std :: min(SOLVER_BLOCK, size - block);
+			forRanges(mode, numOfCols, blockSize, [&](std :: size_t begin, std :: size_t end)
+			{
+				for(unsigned int row = block ; row < block + blockSize ; ++row)
+				{
+					T* xRow = x.data() + row * x.rowStride() + begin;
+					for(unsigned int col = block ; col < row ; ++col)
+					{
+						ElementwiseKernels<T>::axpy(end - begin, -l.at(row, col),
+													x.data() + col * x.rowStride() + begin, xRow);
+					}
+					if(!isUnitDiagonal)
+					{
+						ElementwiseKernels<T>::scale(end - begin, xRow, T(1) / l.at(row, row),
+													 xRow);
+					}
+				}
+			});
+			unsigned int next = block + blockSize;
+			if(next < size)
+			{
+				x.block(next, 0, size - next, numOfCols) -=
+						l.block(next, block, size - next, blockSize) *
+						x.block(block, 0, blockSize, numOfCols);
+			}
+		}
+	}
+
+	/**
+	 * This method solves U * X = B in place of B, for an upper triangular U (only its upper
+	 * triangle is read), like solveLower from the last block of rows to the first.
+	 * @param u - the triangular matrix.
+	 * @param x - B on input, X on output; a row-major view.
+	 * @param isUnitDiagonal - true if the diagonal of U is taken as ones (and not read).
+	 * @param mode - the panel update mode.
+	 */
+	static void solveUpper(const ConstMatrixView<T>& u, const MatrixView<T>& x,
+						   bool isUnitDiagonal, PanelUpdate mode)
+	{
+		unsigned int size = u.rows(), numOfCols = x.cols();
+		for(unsigned int end = size ; end > 0 ; )
+		{
+			unsigned int blockSize = std :: min(SOLVER_BLOCK, end);
+			unsigned int block = end - blockSize;
+			forRanges(mode, numOfCols, blockSize, [&](std :: size_t begin, std :: size_t last)
+			{
+				for(unsigned int row = end ; row-- > block ; )
+				{
+					T* xRow = x.data() + row * x.rowStride() + begin;
+					for(unsigned int col = row + 1 ; col < end ; ++col)
+					{
+						ElementwiseKernels<T>::axpy(last - begin, -u.at(row, col),
+													x.data() + col * x.rowStride() + begin, xRow);
+					}
+					if(!isUnitDiagonal)
+					{
+						ElementwiseKernels<T>::scale(last - begin, xRow, T(1) / u.at(row, row),
+													 xRow);
+					}
+				}
+			});
+			if(block > 0)
+			{
+				x.block(0, 0, block, numOfCols) -= u.block(0, block, block, blockSize) *
+												   x.block(block, 0, blockSize, numOfCols);
+			}
+			end = block;
+		}
+	}
+
+	/**
+	 * This method returns the identity matrix.
+	 * @param size - number of rows and columns.
+	 * @return the identity matrix.
+	 */
+	static Matrix<T> identity(unsigned int size)
+	{
+		Matrix<T> result(size, size);
+		for(unsigned int index = 0 ; index < size ; ++index)
+		{
+			result.at_unchecked(index, index) = T(1);
+		}
+		return result;
+	}
+};
+
+/**
+ * This class represents the LU decomposition with partial pivoting of a square matrix:
+ * P * A = L * U, where P permutes the rows, L is unit lower triangular and U upper triangular.
+ * Every panel is factored column by column, choosing the largest pivot in its column; then the
+ * next rows of U are solved from the panel, and the rest of the matrix is updated by a GEMM.
+ * A singular matrix is factored as well: its determinant is 0, and solve and inverse throw.
+ * @tparam T - the generic type of a coordinate: a floating point type or Complex.
+ */
+template <class T> class LUDecomposition
+{
+	public:
+
+	/**
+	 * This constructor factors a matrix.
+	 * @tparam Allocator - the allocator of the matrix.
+	 * @tparam Order - the storage order of the matrix.
+	 * @param m - the matrix.
+	 * @param mode - the panel update mode.
+	 * @throw logic error of a non square matrix.
+	 */
+	template <class Allocator, StorageOrder Order>
+	explicit LUDecomposition(const Matrix<T, Allocator, Order>& m,
+							 PanelUpdate mode = PanelUpdate::Parallel) :
+	_lu(m), _pivots(m.rows()), _isOddPermutation(false), _isSingular(false), _mode(mode)
+	{
+		if(!_lu.isSquareMatrix())
+		{
+			throw std :: logic_error(NON_SQUARE_DECOMPOSITION_ERROR);
+		}
+		factor();
+	}
+
+	/**
+	 * This method checks if the matrix is singular.
+	 * @return true if a pivot is zero, false otherwise.
+	 */
+	bool isSingular() const
+	{
+		return _isSingular;
+	}
+
+	/**
+	 * This method returns the unit lower triangular factor L.
+	 * @return L.
+	 */
+	Matrix<T> lower() const
+	{
+		Matrix<T> result(_lu);
+		for(unsigned int row = 0 ; row < result.rows() ; ++row)
+		{
+			result.at_unchecked(row, row) = T(1);
+			for(unsigned int col = row + 1 ; col < result.cols() ; ++col)
+			{
+				result.at_unchecked(row, col) = T(0);
+			}
+		}
+		return result;
+	}
+
+	/**
+	 * This method returns the upper triangular factor U.
+	 * @return U.
+	 */
+	Matrix<T> upper() const
+	{
+		Matrix<T> result(_lu);
+		for(unsigned int row = 1 ; row < result.rows() ; ++row)
+		{
+			for(unsigned int col = 0 ; col < row ; ++col)
+			{
+				result.at_unchecked(row, col) = T(0);
+			}
+		}
+		return result;
+	}
+
+	/**
+	 * This method returns the row permutation P: row i of P * A is row permutation()[i] of A.
+	 * @return the permutation.
+	 */
+	std :: vector<unsigned int> permutation() const
+	{
+		std :: vector<unsigned int> result(_pivots.size());
+		for(unsigned int index = 0 ; index < result.size() ; ++index)
+		{
+			result[index] = index;
+		}
+		for(unsigned int index = 0 ; index < result.size() ; ++index)
+		{
+			std :: swap(result[index], result[_pivots[index]]);
+		}
+		return result;
+	}
+
+	/**
+	 * This method calculates the determinant of the matrix: the product of the diagonal of U,
+	 * negated for an odd permutation.
+	 * @return the determinant.
+	 */
+	T determinant() const
+	{
+		T result = T(_isOddPermutation ? -1 : 1);
+		for(unsigned int index = 0 ; index < _lu.rows() ; ++index)
+		{
+			result = result * _lu.at_unchecked(index, index);
+		}
+		return result;
+	}
+
+	/**
+	 * This method solves A * X = B for all the columns of B at once.
+	 * @param b - the right hand sides.
+	 * @return X.
+	 * @throw logic error of incompatible matrices dimensions.
+	 * @throw domain error of a singular matrix.
+	 */
+	Matrix<T> solve(const Matrix<T>& b) const
+	{
+		if(b.rows() != _lu.rows())
+		{
+			throw std :: logic_error(INVALID_MULTIPLICATION_OF_MATRICES_ERROR);
+		}
+		if(_isSingular)
+		{
+			throw std :: domain_error(SINGULAR_MATRIX_ERROR);
+		}
+		Matrix<T> result(b);
+		MatrixView<T> x = view(result);
+		for(unsigned int row = 0 ; row < _pivots.size() ; ++row)
+		{
+			if(_pivots[row] != row)
+			{
+				std :: swap_ranges(x.data() + row * x.rowStride(),
+								   x.data() + row * x.rowStride() + x.cols(),
+								   x.data() + _pivots[row] * x.rowStride());
+			}
+		}
+		SolverKernels<T>::solveLower(view(_lu), x, true, _mode);
+		SolverKernels<T>::solveUpper(view(_lu), x, false, _mode);
+		return result;
+	}
+
+	/**
+	 * This method calculates the inverse of the matrix.
+	 * @return the inverse.
+	 * @throw domain error of a singular matrix.
+	 */
+	Matrix<T> inverse() const
+	{
+		return solve(SolverKernels<T>::identity(_lu.rows()));
+	}
+
+	private:
+
+	/**
+	 * This method factors the matrix in place, panel by panel.
+	 */
+	void factor()
+	{
+		unsigned int size = _lu.rows();
+		MatrixView<T> a = view(_lu);
+		for(unsigned int panel = 0 ; panel < size ; panel += SOLVER_BLOCK)
+		{
+			unsigned int width = std :: min(SOLVER_BLOCK, size - panel);
+			factorPanel(panel, width);
+			unsigned int next = panel + width, rest = size - next;
+			if(rest == 0)
+			{
+				break;
+			}
+			SolverKernels<T>::solveLower(a.block(panel, panel, width, width),
+										 a.block(panel, next, width, rest), true, _mode);
+			a.block(next, next, rest, rest) -= a.block(next, panel, rest, width) *
+											   a.block(panel, next, width, rest);
+		}
+	}
+
+	/**
+	 * This method factors a panel column by column: it swaps the row of the largest pivot (the
+	 * whole row, so the factored and the next columns follow it), and eliminates the column
+	 * below the pivot with rank-1 updates of the panel.
+	 * @param panel - the first column of the panel.
+	 * @param width - number of columns of the panel.
+	 */
+	void factorPanel(unsigned int panel, unsigned int width)
+	{
+		unsigned int size = _lu.rows();
+		T* data = _lu.data();
+		std :: ptrdiff_t stride = _lu.rowStride();
+		for(unsigned int col = panel ; col < panel + width ; ++col)
+		{
+			unsigned int pivot = col;
+			double largest = SolverKernels<T>::squaredMagnitude(data[col * stride + col]);
+			for(unsigned int row = col + 1 ; row < size ; ++row)
+			{
+				double magnitude = SolverKernels<T>::squaredMagnitude(data[row * stride + col]);
+				if(magnitude > largest)
+				{
+					pivot = row;
+					largest = magnitude;
+				}
+			}
+			_pivots[col] = pivot;
+			if(pivot != col)
+			{
+				std :: swap_ranges(data + col * stride, data + col * stride + size,
+								   data + pivot * stride);
+				_isOddPermutation = !_isOddPermutation;
+			}
+			if(largest == 0)
+			{
+				_isSingular = true;
+				continue;
+			}
+			T reciprocal = T(1) / data[col * stride + col];
+			const T* pivotRow = data + col * stride + col + 1;
+			unsigned int rest = panel + width - col - 1;
+			SolverKernels<T>::forRanges(_mode, size - col - 1, rest + 1,
+										[&](std :: size_t begin, std :: size_t end)
+			{
+				for(std :: size_t row = col + 1 + begin ; row < col + 1 + end ; ++row)
+				{
+					T* coords = data + row * stride + col;
+					coords[0] = coords[0] * reciprocal;
+					ElementwiseKernels<T>::axpy(rest, -coords[0], pivotRow, coords + 1);
+				}
+			});
+		}
+	}
+
+	/**
+	 * L below the diagonal (its unit diagonal is implied) and U on and above it.
+	 */
+	Matrix<T> _lu;
+
+	/**
+	 * The row which was swapped with every row while factoring.
+	 */
+	std :: vector<unsigned int> _pivots;
+
+	/**
+	 * True if the permutation swapped an odd number of rows.
+	 */
+	bool _isOddPermutation;
+
+	/**
+	 * True if a pivot is zero.
+	 */
+	bool _isSingular;
+
+	/**
+	 * The panel update mode.
+	 */
+	PanelUpdate _mode;
+
+};
+
+/**
+ * This class represents the Cholesky decomposition of a Hermitian (symmetric, if it is real)
+ * positive definite matrix: A = L * L^H, where L is lower triangular with a positive diagonal.
+ * Only the lower triangle of A is read. Every panel is factored on its diagonal block, the rows
+ * below it are solved from the block, and the lower triangle of the rest of the matrix is
+ * updated by GEMMs, one block of rows at a time.
+ * @tparam T - the generic type of a coordinate: a floating point type or Complex.
+ */
+template <class T> class CholeskyDecomposition
+{
+	public:
+
+	/**
+	 * This constructor factors a matrix.
+	 * @tparam Allocator - the allocator of the matrix.
+	 * @tparam Order - the storage order of the matrix.
+	 * @param m - the matrix.
+	 * @param mode - the panel update mode.
+	 * @throw logic error of a non square matrix.
+	 * @throw domain error of a matrix which is not positive definite.
+	 */
+	template <class Allocator, StorageOrder Order>
+	explicit CholeskyDecomposition(const Matrix<T, Allocator, Order>& m,
+								   PanelUpdate mode = PanelUpdate::Parallel) :
+	_lower(m), _mode(mode)
+	{
+		if(!_lower.isSquareMatrix())
+		{
+			throw std :: logic_error(NON_SQUARE_DECOMPOSITION_ERROR);
+		}
+		factor();
+		for(unsigned int row = 0 ; row < _lower.rows() ; ++row)
+		{
+			for(unsigned int col = row + 1 ; col < _lower.cols() ; ++col)
+			{
+				_lower.at_unchecked(row, col) = T(0);
+			}
+		}
+	}
+
+	/**
+	 * This method returns the lower triangular factor L.
+	 * @return L.
+	 */
+	const Matrix<T>& lower() const
+	{
+		return _lower;
+	}
+
+	/**
+	 * This method calculates the determinant of the matrix: the squared product of the diagonal
+	 * of L.
+	 * @return the determinant.
+	 */
+	T determinant() const
+	{
+		double result = 1;
+		for(unsigned int index = 0 ; index < _lower.rows() ; ++index)
+		{
+			result *= SolverKernels<T>::realPart(_lower.at_unchecked(index, index));
+		}
+		return T(result * result);
+	}
+
+	/**
+	 * This method solves A * X = B for all the columns of B at once: L * Y = B, then
+	 * L^H * X = Y.
+	 * @param b - the right hand sides.
+	 * @return X.
+	 * @throw logic error of incompatible matrices dimensions.
+	 */
+	Matrix<T> solve(const Matrix<T>& b) const
+	{
+		if(b.rows() != _lower.rows())
+		{
+			throw std :: logic_error(INVALID_MULTIPLICATION_OF_MATRICES_ERROR);
+		}
+		Matrix<T> result(b);
+		SolverKernels<T>::solveLower(view(_lower), view(result), false, _mode);
+		Matrix<T> upper = _lower.trans();
+		SolverKernels<T>::solveUpper(view(upper), view(result), false, _mode);
+		return result;
+	}
+
+	/**
+	 * This method calculates the inverse of the matrix.
+	 * @return the inverse.
+	 */
+	Matrix<T> inverse() const
+	{
+		return solve(SolverKernels<T>::identity(_lower.rows()));
+	}
+
+	private:
+
+	/**
+	 * This method factors the matrix in place, panel by panel.
+	 * @throw domain error of a matrix which is not positive definite.
+	 */
+	void factor()
+	{
+		unsigned int size = _lower.rows();
+		MatrixView<T> a = view(_lower);
+		T* data = _lower.data();
+		std :: ptrdiff_t stride = _lower.rowStride();
+		for(unsigned int panel = 0 ; panel < size ; panel += SOLVER_BLOCK)
+		{
+			unsigned int width = std :: min(SOLVER_BLOCK, size - panel);
+			factorDiagonalBlock(panel, width);
+			unsigned int next = panel + width, rest = size - next;
+			if(rest == 0)
+			{
+				break;
+			}
+			// L21 = A21 * L11^-H, every row on its own
+			SolverKernels<T>::forRanges(_mode, rest, width * width,
+										[&](std :: size_t begin, std :: size_t end)
+			{
+				for(std :: size_t row = next + begin ; row < next + end ; ++row)
+				{
+					T* coords = data + row * stride;
+					for(unsigned int col = panel ; col < next ; ++col)
+					{
+						const T* diagonalRow = data + col * stride;
+						T sum = coords[col];
+						for(unsigned int index = panel ; index < col ; ++index)
+						{
+							sum = sum - coords[index] *
+										SolverKernels<T>::conjugate(diagonalRow[index]);
+						}
+						coords[col] = sum / diagonalRow[col];
+					}
+				}
+			});
+			// A22 -= L21 * L21^H, on the lower triangle only
+			Matrix<T> adjoint = Matrix<T>(a.block(next, panel, rest, width)).trans();
+			for(unsigned int block = 0 ; block < rest ; block += SOLVER_BLOCK)
+			{
+				unsigned int blockRows = std :: min(SOLVER_BLOCK, rest - block);
+				a.block(next + block, next, blockRows, block + blockRows) -=
+						a.block(next + block, panel, blockRows, width) *
+						view(adjoint).block(0, 0, width, block + blockRows);
+			}
+		}
+	}
+
+	/**
+	 * This method factors the diagonal block of a panel by the unblocked algorithm.
+	 * @param panel - the first row and column of the block.
+	 * @param width - number of rows and columns of the block.
+	 * @throw domain error of a matrix which is not positive definite.
+	 */
+	void factorDiagonalBlock(unsigned int panel, unsigned int width)
+	{
+		T* data = _lower.data();
+		std :: ptrdiff_t stride = _lower.rowStride();
+		for(unsigned int col = panel ; col < panel + width ; ++col)
+		{
+			T* diagonalRow = data + col * stride;
+			double diagonal = SolverKernels<T>::realPart(diagonalRow[col]);
+			for(unsigned int index = panel ; index < col ; ++index)
+			{
+				diagonal -= SolverKernels<T>::squaredMagnitude(diagonalRow[index]);
+			}
+			if(!(diagonal > 0))
+			{
+				throw std :: domain_error(NOT_POSITIVE_DEFINITE_ERROR);
+			}
+			diagonalRow[col] = T(std :: sqrt(diagonal));
+			for(unsigned int row = col + 1 ; row < panel + width ; ++row)
+			{
+				T* coords = data + row * stride;
+				T sum = coords[col];
+				for(unsigned int index = panel ; index < col ; ++index)
+				{
+					sum = sum - coords[index] * SolverKernels<T>::conjugate(diagonalRow[index]);
+				}
+				coords[col] = sum / diagonalRow[col];
+			}
+		}
+	}
+
+	/**
+	 * L on and below the diagonal.
+	 */
+	Matrix<T> _lower;
+
+	/**
+	 * The panel update mode.
+	 */
+	PanelUpdate _mode;
+
+};
+
+/**
+ * This class represents the Householder QR decomposition of a matrix with at least as many rows
+ * as columns: A = Q * R, where Q = H_1 * ... * H_n is unitary and R is upper triangular. Every
+ * reflector is H_j = I - tau_j * v_j * v_j^H (the LAPACK convention, with a real diagonal of R).
+ * The reflectors of a panel are accumulated into the compact WY form I - V * T * V^H, so the
+ * rest of the matrix, and the right hand sides of solve, are updated by GEMMs.
+ * @tparam T - the generic type of a coordinate: a floating point type or Complex.
+ */
+template <class T> class QRDecomposition
+{
+	public:
+
+	/**
+	 * This constructor factors a matrix.
+	 * @tparam Allocator - the allocator of the matrix.
+	 * @tparam Order - the storage order of the matrix.
+	 * @param m - the matrix.
+	 * @param mode - the panel update mode.
+	 * @throw logic error of a matrix with fewer rows than columns.
+	 */
+	template <class Allocator, StorageOrder Order>
+	explicit QRDecomposition(const Matrix<T, Allocator, Order>& m,
+							 PanelUpdate mode = PanelUpdate::Parallel) :
+	_qr(m), _taus(m.cols()), _mode(mode)
+	{
+		if(_qr.rows() < _qr.cols())
+		{
+			throw std :: logic_error(QR_DIMENSIONS_ERROR);
+		}
+		factor();
+	}
+
+	/**
+	 * This method returns the upper triangular factor R, cols() * cols().
+	 * @return R.
+	 */
+	Matrix<T> upper() const
+	{
+		Matrix<T> result = view(_qr).block(0, 0, _qr.cols(), _qr.cols());
+		for(unsigned int row = 1 ; row < result.rows() ; ++row)
+		{
+			for(unsigned int col = 0 ; col < row ; ++col)
+			{
+				result.at_unchecked(row, col) = T(0);
+			}
+		}
+		return result;
+	}
+
+	/**
+	 * This method returns the first cols() columns of the unitary factor Q (the thin Q, so that
+	 * A = Q * R).
+	 * @return the thin Q.
+	 */
+	Matrix<T> unitary() const
+	{
+		Matrix<T> result(_qr.rows(), _qr.cols());
+		for(unsigned int index = 0 ; index < _qr.cols() ; ++index)
+		{
+			result.at_unchecked(index, index) = T(1);
+		}
+		applyUnitary(view(result), false);
+		return result;
+	}
+
+	/**
+	 * This method calculates the determinant of a square matrix: the product of the diagonal of
+	 * R and of the determinants 1 - tau_j * v_j^H * v_j of the reflectors.
+	 * @return the determinant.
+	 * @throw logic error of a non square matrix.
+	 */
+	T determinant() const
+	{
+		if(!_qr.isSquareMatrix())
+		{
+			throw std :: logic_error(NON_SQUARE_DECOMPOSITION_ERROR);
+		}
+		T result = T(1);
+		for(unsigned int col = 0 ; col < _qr.cols() ; ++col)
+		{
+			double squaredNorm = 1;
+			for(unsigned int row = col + 1 ; row < _qr.rows() ; ++row)
+			{
+				squaredNorm += SolverKernels<T>::squaredMagnitude(_qr.at_unchecked(row, col));
+			}
+			result = result * (T(1) - _taus[col] * T(squaredNorm)) * _qr.at_unchecked(col, col);
+		}
+		return result;
+	}
+
+	/**
+	 * This method solves A * X = B for all the columns of B at once, in the least squares sense
+	 * if A has more rows than columns: X = R^-1 * (Q^H * B), on the first cols() rows.
+	 * @param b - the right hand sides.
+	 * @return X.
+	 * @throw logic error of incompatible matrices dimensions.
+	 * @throw domain error of a matrix whose columns are linearly dependent.
+	 */
+	Matrix<T> solve(const Matrix<T>& b) const
+	{
+		if(b.rows() != _qr.rows())
+		{
+			throw std :: logic_error(INVALID_MULTIPLICATION_OF_MATRICES_ERROR);
+		}
+		for(unsigned int index = 0 ; index < _qr.cols() ; ++index)
+		{
+			if(_qr.at_unchecked(index, index) == T(0))
+			{
+				throw std :: domain_error(SINGULAR_MATRIX_ERROR);
+			}
+		}
+		Matrix<T> projection(b);
+		applyUnitary(view(projection), true);
+		Matrix<T> result = view(projection).block(0, 0, _qr.cols(), b.cols());
+		SolverKernels<T>::solveUpper(view(_qr).block(0, 0, _qr.cols(), _qr.cols()), view(result),
+									 false, _mode);
+		return result;
+	}
+
+	/**
+	 * This method calculates the inverse of a square matrix.
+	 * @return the inverse.
+	 * @throw logic error of a non square matrix.
+	 * @throw domain error of a singular matrix.
+	 */
+	Matrix<T> inverse() const
+	{
+		if(!_qr.isSquareMatrix())
+		{
+			throw std :: logic_error(NON_SQUARE_DECOMPOSITION_ERROR);
+		}
+		return solve(SolverKernels<T>::identity(_qr.rows()));
+	}
+
+	private:
+
+	/**
+	 * This method factors the matrix in place, panel by panel.
+	 */
+	void factor()
+	{
+		unsigned int numOfRows = _qr.rows(), numOfCols = _qr.cols();
+		MatrixView<T> a = view(_qr);
+		for(unsigned int panel = 0 ; panel < numOfCols ; panel += SOLVER_BLOCK)
+		{
+			unsigned int width = std :: min(SOLVER_BLOCK, numOfCols - panel);
+			factorPanel(panel, width);
+			Matrix<T> reflectors = reflectorsOf(panel, width);
+			Matrix<T> adjoint = reflectors.trans();
+			_factors.push_back(triangularFactorOf(panel, reflectors, adjoint));
+			unsigned int next = panel + width;
+			if(next == numOfCols)
+			{
+				break;
+			}
+			// A2 = (I - V * T^H * V^H) * A2
+			MatrixView<T> rest = a.block(panel, next, numOfRows - panel, numOfCols - next);
+			Matrix<T> product = view(adjoint) * rest;
+			product = _factors.back().trans() * product;
+			rest -= view(reflectors) * view(product);
+		}
+	}
+
+	/**
+	 * This method factors a panel column by column: it computes the reflector of the column,
+	 * stores v below the diagonal, and applies H^H to the next columns of the panel.
+	 * @param panel - the first column of the panel.
+	 * @param width - number of columns of the panel.
+	 */
+	void factorPanel(unsigned int panel, unsigned int width)
+	{
+		unsigned int numOfRows = _qr.rows();
+		T* data = _qr.data();
+		std :: ptrdiff_t stride = _qr.rowStride();
+		std :: vector<T> projection;
+		for(unsigned int col = panel ; col < panel + width ; ++col)
+		{
+			T alpha = data[col * stride + col];
+			double squaredNorm = 0;
+			for(unsigned int row = col + 1 ; row < numOfRows ; ++row)
+			{
+				squaredNorm += SolverKernels<T>::squaredMagnitude(data[row * stride + col]);
+			}
+			if(squaredNorm == 0 && SolverKernels<T>::imaginaryPart(alpha) == 0)
+			{
+				_taus[col] = T(0);
+				continue;
+			}
+			double norm = std :: sqrt(SolverKernels<T>::squaredMagnitude(alpha) + squaredNorm);
+			T beta = T(SolverKernels<T>::realPart(alpha) < 0 ? norm : -norm);
+			_taus[col] = (beta - alpha) / beta;
+			T scale = T(1) / (alpha - beta);
+			for(unsigned int row = col + 1 ; row < numOfRows ; ++row)
+			{
+				data[row * stride + col] = data[row * stride + col] * scale;
+			}
+			data[col * stride + col] = beta;
+			unsigned int rest = panel + width - col - 1;
+			if(rest == 0)
+			{
+				continue;
+			}
+			// w = v^H * A(col:, col + 1:), then A(col:, col + 1:) -= conj(tau) * v * w
+			projection = ThreadPool::instance().parallelReduce<std :: vector<T>>(
+					numOfRows - col, reductionChunkOf(rest),
+					[&](std :: size_t begin, std :: size_t end)
+			{
+				std :: vector<T> partial(rest, T(0));
+				for(std :: size_t row = col + begin ; row < col + end ; ++row)
+				{
+					T coefficient = row == col ? T(1) :
+									SolverKernels<T>::conjugate(data[row * stride + col]);
+					ElementwiseKernels<T>::axpy(rest, coefficient, data + row * stride + col + 1,
+												partial.data());
+				}
+				return partial;
+			}, [](const std :: vector<T>& left, const std :: vector<T>& right)
+			{
+				std :: vector<T> sum(left.size());
+				ElementwiseKernels<T>::add(left.size(), left.data(), right.data(), sum.data());
+				return sum;
+			});
+			T factor = SolverKernels<T>::conjugate(_taus[col]);
+			SolverKernels<T>::forRanges(_mode, numOfRows - col, rest,
+										[&](std :: size_t begin, std :: size_t end)
+			{
+				for(std :: size_t row = col + begin ; row < col + end ; ++row)
+				{
+					T coefficient = row == col ? factor : factor * data[row * stride + col];
+					ElementwiseKernels<T>::axpy(rest, -coefficient, projection.data(),
+												data + row * stride + col + 1);
+				}
+			});
+		}
+	}
+
+	/**
+	 * This method returns the minimal number of rows of a parallel chunk of the reduction in
+	 * factorPanel: all of them in the serial mode.
+	 * @param width - number of columns which are reduced.
+	 * @return the minimal number of rows of a chunk.
+	 */
+	std :: size_t reductionChunkOf(unsigned int width) const
+	{
+		if(_mode == PanelUpdate::Serial)
+		{
+			return _qr.rows();
+		}
+		return std :: max<std :: size_t>(1, PARALLEL_ELEMENTWISE_CHUNK / std :: max(width, 1u));
+	}
+
+	/**
+	 * This method returns the reflectors of a panel as a matrix V, with the rows from the first
+	 * row of the panel: ones on the diagonal, v below it and zeros above it.
+	 * @param panel - the first column of the panel.
+	 * @param width - number of columns of the panel.
+	 * @return V.
+	 */
+	Matrix<T> reflectorsOf(unsigned int panel, unsigned int width) const
+	{
+		Matrix<T> result(_qr.rows() - panel, width);
+		for(unsigned int row = 0 ; row < result.rows() ; ++row)
+		{
+			for(unsigned int col = 0 ; col < width && col <= row ; ++col)
+			{
+				result.at_unchecked(row, col) = col == row ? T(1) :
+												_qr.at_unchecked(panel + row, panel + col);
+			}
+		}
+		return result;
+	}
+
+	/**
+	 * This method accumulates the reflectors of a panel: H_1 * ... * H_k = I - V * T * V^H, where
+	 * T is upper triangular with T(j, j) = tau_j and T(0:j, j) = -tau_j * T(0:j, 0:j) *
+	 * V(:, 0:j)^H * v_j.
+	 * @param panel - the first column of the panel.
+	 * @param reflectors - V.
+	 * @param adjoint - V^H.
+	 * @return T.
+	 */
+	Matrix<T> triangularFactorOf(unsigned int panel, const Matrix<T>& reflectors,
+								 const Matrix<T>& adjoint) const
+	{
+		unsigned int width = reflectors.cols();
+		Matrix<T> gram = adjoint * reflectors;
+		Matrix<T> result(width, width);
+		for(unsigned int col = 0 ; col < width ; ++col)
+		{
+			T tau = _taus[panel + col];
+			result.at_unchecked(col, col) = tau;
+			for(unsigned int row = 0 ; row < col ; ++row)
+			{
+				T sum = T(0);
+				for(unsigned int index = row ; index < col ; ++index)
+				{
+					sum = sum + result.at_unchecked(row, index) * gram.at_unchecked(index, col);
+				}
+				result.at_unchecked(row, col) = T(0) - tau * sum;
+			}
+		}
+		return result;
+	}
+
+	/**
+	 * This method multiplies a matrix by Q, or by Q^H, in place, panel by panel.
+	 * @param x - the matrix, with rows() rows.
+	 * @param isAdjoint - true to multiply by Q^H, false to multiply by Q.
+	 */
+	void applyUnitary(const MatrixView<T>& x, bool isAdjoint) const
+	{
+		unsigned int numOfPanels = (unsigned int) _factors.size();
+		for(unsigned int index = 0 ; index < numOfPanels ; ++index)
+		{
+			unsigned int panelIndex = isAdjoint ? index : numOfPanels - 1 - index;
+			unsigned int panel = panelIndex * SOLVER_BLOCK;
+			Matrix<T> reflectors = reflectorsOf(panel, _factors[panelIndex].cols());
+			Matrix<T> adjoint = reflectors.trans();
+			MatrixView<T> rows = x.block(panel, 0, x.rows() - panel, x.cols());
+			Matrix<T> product = view(adjoint) * rows;
+			product = (isAdjoint ? _factors[panelIndex].trans() : _factors[panelIndex]) * product;
+			rows -= view(reflectors) * view(product);
+		}
+	}
+
+	/**
+	 * R on and above the diagonal, the reflectors v_j below it.
+	 */
+	Matrix<T> _qr;
+
+	/**
+	 * The tau_j of the reflectors.
+	 */
+	std :: vector<T> _taus;
+
+	/**
+	 * The triangular factor T of the reflectors of every panel.
+	 */
+	std :: vector<Matrix<T>> _factors;
+
+	/**
+	 * The panel update mode.
+	 */
+	PanelUpdate _mode;
+
+};
+
+/**
+ * This function calculates the determinant of a square matrix by its LU decomposition.
+ * @tparam T - the generic type of a coordinate: a floating point type or Complex.
+ * @param m - the matrix.
+ * @return the determinant.
+ * @throw logic error of a non square matrix.
+ */
+template <class T> T determinant(const Matrix<T>& m)
+{
+	return LUDecomposition<T>(m).determinant();
+}
+
+/**
+ * This function calculates the inverse of a square matrix by its LU decomposition.
+ * @tparam T - the generic type of a coordinate: a floating point type or Complex.
+ * @param m - the matrix.
+ * @return the inverse.
+ * @throw logic error of a non square matrix.
+ * @throw domain error of a singular matrix.
+ */
+template <class T> Matrix<T> inverse(const Matrix<T>& m)
+{
+	return LUDecomposition<T>(m).inverse();
+}
+
+/**
+ * This function solves A * X = B by the LU decomposition of A.
+ * @tparam T - the generic type of a coordinate: a floating point type or Complex.
+ * @param a - the square matrix.
+ * @param b - the right hand sides.
+ * @return X.
+ * @throw logic error of a non square matrix or of incompatible matrices dimensions.
+ * @throw domain error of a singular matrix.
+ */
+template <class T> Matrix<T> solve(const Matrix<T>& a, const Matrix<T>& b)
+{
+	return LUDecomposition<T>(a).solve(b);
+}
+
+#endif
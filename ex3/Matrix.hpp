@@ -1,6 +1,15 @@
 //================================ Includes =====================================================
 #include "Complex.h"
+#include "ElementwiseKernels.hpp"
+#include "MatrixKernels.hpp"
+#include "PerfCounters.hpp"
+#include "PooledAllocator.hpp"
+#include "StrassenKernels.hpp"
+#include "ThreadPool.hpp"
+#include <cmath>
 #include <iostream>
+#include <type_traits>
+#include <utility>
 #include <vector>
 //================================ Constants ====================================================
 #ifndef CPP3_MATRIX_H
@@ -10,26 +19,79 @@
 #define SEPARATOR_OF_A_TAB '\t'
 #define INVALID_MULTIPLICATION_OF_MATRICES_ERROR "Invalid multiplication of matrices!"
 #define INCOMPATIBLE_DIMENSIONS_OF_MATRICES_ERROR "The matrices dimensions are not compatible"
-#define CAN_NOT_TRANSPOSE_MATRIX_ERROR "This matrix is not squared and thus cannot be transposed"
+#define CAN_NOT_TRANSPOSE_MATRIX_ERROR "This matrix is not squared and thus cannot be transposed " \
+									   "in place"
 #define INDEX_OUT_OF_BOUNDS_ERROR "Index out of bounds error!"
 #define INVALID_ARGUMENT_ERROR "The number of rows and columns should be both positive"
+#define TRACE_OF_NON_SQUARE_MATRIX_ERROR "The trace is only defined for a squared matrix"
+#define PARALLEL_ELEMENTWISE_CHUNK (1 << 15)
+#ifndef MATRIX_BOUNDS_CHECK
+#ifdef NDEBUG
+#define MATRIX_BOUNDS_CHECK 0
+#else
+#define MATRIX_BOUNDS_CHECK 1
+#endif
+#endif
 //================================ Code Segment =================================================
 
+template <class T, class Expression> class MatrixExpression;
+
+template <class T> class MatrixReference;
+
+template <class T> class SparseMatrix;
+
+template <class T> class ConstMatrixView;
+
+template <class T> class MatrixView;
+
+template <class Expression> struct IsProductExpression;
+
+/**
+ * This enum represents the order in which the coordinates of a matrix are stored: row by row
+ * (like C), or column by column (like Fortran, BLAS and Eigen).
+ */
+enum class StorageOrder
+{
+	RowMajor,
+	ColMajor
+};
+
 /**
  * This class represents a generic matrix. For example, we implemented
  * arithmetic operations on matrices.
  * @tparam T - the generic type of a coordinate in the generic matrix.
  * We have an assumption of the type T that it is printable and arithmetic operations
  * can be done on it.
+ * @tparam Allocator - the allocator of the coordinates storage. The default PooledAllocator
+ * aligns the storage to 64 bytes for the SIMD kernels and recycles the storage of temporaries,
+ * so loops which create and destroy matrices of the same size do not call the system allocator.
+ * @tparam Order - the storage order of the coordinates. Products of matrices of any storage
+ * orders run on the same kernels, which read every operand in its own order (see MatrixKernels).
  */
-template <class T> class Matrix
+template <class T, class Allocator = PooledAllocator<T>,
+		  StorageOrder Order = StorageOrder::RowMajor> class Matrix
 {
 	public:
 
 	/**
-	 * This type represents a constant iterator for a generic matrix.
+	 * This type represents the allocator of the coordinates storage.
 	 */
-	typedef typename std::vector<T> :: const_iterator const_iterator;
+	typedef Allocator allocator_type;
+
+	/**
+	 * The storage order of the coordinates.
+	 */
+	static constexpr StorageOrder ORDER = Order;
+
+	/**
+	 * This type represents an iterator for a generic matrix, in the storage order.
+	 */
+	typedef typename std::vector<T, Allocator> :: iterator iterator;
+
+	/**
+	 * This type represents a constant iterator for a generic matrix, in the storage order.
+	 */
+	typedef typename std::vector<T, Allocator> :: const_iterator const_iterator;
 
 	/**
 	 * This is the default constructor which initializes a one-on-one matrix of zeros.
@@ -47,7 +109,7 @@ template <class T> class Matrix
 	 * @throw: invalid argument error if not positive.
 	 */
 	Matrix(unsigned int rows, unsigned int cols) : _numOfRows(rows), _numOfCols(cols),
-	_vectorMatrix(cols * rows, T(BASIC_MATRIX_VALUE))
+	_vectorMatrix((std :: size_t) cols * rows, T(BASIC_MATRIX_VALUE))
 	{
 		checkPositiveRowAndColNumber();
 	}
@@ -62,19 +124,63 @@ template <class T> class Matrix
 
 	}
 
+	/**
+	 * This constructor is a move constructor which takes the values of matrix m without copying
+	 * them. m is left as an empty 0 * 0 matrix, which can only be assigned to or destroyed.
+	 * @param m - the input generic matrix that we move from.
+	 */
+	Matrix(Matrix&& m) noexcept : _numOfRows(m._numOfRows), _numOfCols(m._numOfCols),
+	_vectorMatrix(std :: move(m._vectorMatrix))
+	{
+		m._numOfRows = 0;
+		m._numOfCols = 0;
+		m._vectorMatrix.clear();
+	}
+
 	/**
 	 * This constructor initializes a generic matrix with values in the generic vector.
 	 * @param rows - number of rows in the matrix.
 	 * @param cols - number of columns in the matrix.
-	 * @param cells - the generic vector that we copy from.
+	 * @param cells - the generic vector that we copy from, in the storage order.
 	 * @throw: invalid argument error if not positive.
 	 */
 	Matrix(unsigned int rows, unsigned int cols, const std :: vector<T>& cells) :
-	_numOfRows(rows), _numOfCols(cols), _vectorMatrix(cells)
+	_numOfRows(rows), _numOfCols(cols), _vectorMatrix(cells.begin(), cells.end())
 	{
 		checkPositiveRowAndColNumber();
 	}
 
+	/**
+	 * This constructor evaluates a lazy matrix expression (see MatrixExpressions.hpp).
+	 * @tparam Expression - the type of the expression.
+	 * @param expression - the expression.
+	 */
+	template <class Expression> Matrix(const MatrixExpression<T, Expression>& expression) :
+	_numOfRows(expression.rows()), _numOfCols(expression.cols()),
+	_vectorMatrix((std :: size_t) expression.rows() * expression.cols())
+	{
+		evaluate(expression);
+	}
+
+	/**
+	 * This constructor copies a matrix of another storage order (or allocator). Between storage
+	 * orders, the coordinates are copied by the blocked transpose kernel.
+	 * @tparam OtherAllocator - the allocator of the other matrix.
+	 * @tparam OtherOrder - the storage order of the other matrix.
+	 * @param m - the matrix that we copy from.
+	 */
+	template <class OtherAllocator, StorageOrder OtherOrder>
+	explicit Matrix(const Matrix<T, OtherAllocator, OtherOrder>& m) :
+	_numOfRows(m._numOfRows), _numOfCols(m._numOfCols),
+	_vectorMatrix(m._vectorMatrix.begin(), m._vectorMatrix.end())
+	{
+		if constexpr (OtherOrder != Order)
+		{
+			MatrixKernels<T> :: transpose(m.numOfMajors(), m.numOfMinors(), m._vectorMatrix.data(),
+										  m.numOfMinors(), _vectorMatrix.data(), numOfMinors());
+		}
+	}
+
 	/**
 	 * This destructor is a default destructor for the generic matrix.
 	 */
@@ -110,6 +216,24 @@ template <class T> class Matrix
 		return _numOfCols;
 	}
 
+	/**
+	 * This method returns the distance between two rows of the matrix in its storage.
+	 * @return the row stride.
+	 */
+	std :: ptrdiff_t rowStride() const
+	{
+		return Order == StorageOrder::RowMajor ? _numOfCols : 1;
+	}
+
+	/**
+	 * This method returns the distance between two columns of the matrix in its storage.
+	 * @return the column stride.
+	 */
+	std :: ptrdiff_t colStride() const
+	{
+		return Order == StorageOrder::RowMajor ? 1 : _numOfRows;
+	}
+
 	/**
 	 * This method is the assign operator for a generic matrix.
 	 * @param m - the generic matrix we copy from.
@@ -130,6 +254,45 @@ template <class T> class Matrix
 		}
 	}
 
+	/**
+	 * This method is the move assign operator for a generic matrix. It takes the values of m
+	 * without copying them, and leaves m as an empty 0 * 0 matrix.
+	 * @param m - the generic matrix we move from.
+	 * @return - a reference to the new matrix.
+	 */
+	Matrix& operator=(Matrix&& m) noexcept
+	{
+		if(&m != this)
+		{
+			_numOfRows = m._numOfRows;
+			_numOfCols = m._numOfCols;
+			_vectorMatrix = std :: move(m._vectorMatrix);
+			m._numOfRows = 0;
+			m._numOfCols = 0;
+			m._vectorMatrix.clear();
+		}
+		return *(this);
+	}
+
+	/**
+	 * This method evaluates a lazy matrix expression into this matrix. If the dimensions match
+	 * and the expression does not read this matrix, it is evaluated in place, otherwise into new
+	 * storage first.
+	 * @tparam Expression - the type of the expression.
+	 * @param expression - the expression.
+	 * @return - a reference to the new matrix.
+	 */
+	template <class Expression> Matrix& operator=(const MatrixExpression<T, Expression>& expression)
+	{
+		if(_numOfRows != expression.rows() || _numOfCols != expression.cols() ||
+		   expression.refersTo(_vectorMatrix.data()))
+		{
+			return *this = Matrix(expression);
+		}
+		evaluate(expression);
+		return *(this);
+	}
+
 	/**
 	 * This method checks if the matrices dimensions suit each other.
 	 * @param m - the right other matrix.
@@ -143,44 +306,159 @@ template <class T> class Matrix
 		}
 	}
 
+	/**
+	 * This method adds a generic matrix to this matrix in place. Large matrices are split into
+	 * contiguous ranges which run on the threads of the global thread pool (see ThreadPool).
+	 * @param m - the right hand side matrix.
+	 * @return a reference to this matrix.
+	 * @throw logic error exception if the matrices dimensions do not suit each other.
+	 */
+	Matrix& operator+=(const Matrix& m)
+	{
+		checkMatrixDimensions(m);
+		MATRIX_PERF_SCOPE("add", FlopsOf<T>::ADD * _vectorMatrix.size());
+
+		combineInPlace(m, [](std::size_t size, T* coords, const T* otherCoords)
+		{
+			ElementwiseKernels<T>::add(size, coords, otherCoords, coords);
+		});
+		return *(this);
+	}
+
+	/**
+	 * This method subtracts a generic matrix from this matrix in place. Large matrices are split
+	 * into contiguous ranges which run on the threads of the global thread pool.
+	 * @param m - the right hand side matrix.
+	 * @return a reference to this matrix.
+	 * @throw logic error exception if the matrices dimensions do not suit each other.
+	 */
+	Matrix& operator-=(const Matrix& m)
+	{
+		checkMatrixDimensions(m);
+		MATRIX_PERF_SCOPE("subtract", FlopsOf<T>::ADD * _vectorMatrix.size());
+
+		combineInPlace(m, [](std::size_t size, T* coords, const T* otherCoords)
+		{
+			ElementwiseKernels<T>::subtract(size, coords, otherCoords, coords);
+		});
+		return *(this);
+	}
+
 	/**
 	 * This method adds two generic matrices.
 	 * @param m - the right hand side matrix.
 	 * @return addition of two generic matrices.
 	 * @throw logic error exception if the matrices dimensions do not suit each other.
 	 */
-	Matrix operator+(const Matrix& m) const
+	Matrix operator+(const Matrix& m) const &
 	{
-
 		checkMatrixDimensions(m);
 
 		Matrix result(*this);
-		for(unsigned int matrixIndex = 0 ; matrixIndex < _vectorMatrix.size() ; ++matrixIndex)
-		{
-			result._vectorMatrix[matrixIndex] += m._vectorMatrix[matrixIndex];
-		}
+		result += m;
 		return result;
 	}
 
+	/**
+	 * This method adds two generic matrices, reusing the storage of this temporary matrix, so a
+	 * chain like A + B + C allocates only once.
+	 * @param m - the right hand side matrix.
+	 * @return addition of two generic matrices.
+	 * @throw logic error exception if the matrices dimensions do not suit each other.
+	 */
+	Matrix operator+(const Matrix& m) &&
+	{
+		*this += m;
+		return std :: move(*this);
+	}
+
+	/**
+	 * This method adds two generic matrices, reusing the storage of the temporary matrix m.
+	 * @param m - the right hand side matrix.
+	 * @return addition of two generic matrices.
+	 * @throw logic error exception if the matrices dimensions do not suit each other.
+	 */
+	Matrix operator+(Matrix&& m) const &
+	{
+		checkMatrixDimensions(m);
+		MATRIX_PERF_SCOPE("add", FlopsOf<T>::ADD * _vectorMatrix.size());
+
+		m.combineInPlace(*this, [](std::size_t size, T* coords, const T* otherCoords)
+		{
+			ElementwiseKernels<T>::add(size, otherCoords, coords, coords);
+		});
+		return std :: move(m);
+	}
+
+	/**
+	 * This method adds two temporary generic matrices, reusing the storage of this matrix.
+	 * @param m - the right hand side matrix.
+	 * @return addition of two generic matrices.
+	 * @throw logic error exception if the matrices dimensions do not suit each other.
+	 */
+	Matrix operator+(Matrix&& m) &&
+	{
+		*this += m;
+		return std :: move(*this);
+	}
+
 	/**
 	 * This method subtract two generic matrices.
 	 * @param m - the right hand side matrix.
 	 * @return subtraction of two generic matrices.
 	 * @throw logic error exception if the matrices dimensions do not suit each other.
 	 */
-	Matrix operator-(const Matrix& m) const
+	Matrix operator-(const Matrix& m) const &
 	{
-
 		checkMatrixDimensions(m);
 
 		Matrix result(*this);
-		for(int matrixIndex = 0 ; matrixIndex < _vectorMatrix.size() ; ++matrixIndex)
-		{
-			result._vectorMatrix[matrixIndex] -= m._vectorMatrix[matrixIndex];
-		}
+		result -= m;
 		return result;
 	}
 
+	/**
+	 * This method subtract two generic matrices, reusing the storage of this temporary matrix.
+	 * @param m - the right hand side matrix.
+	 * @return subtraction of two generic matrices.
+	 * @throw logic error exception if the matrices dimensions do not suit each other.
+	 */
+	Matrix operator-(const Matrix& m) &&
+	{
+		*this -= m;
+		return std :: move(*this);
+	}
+
+	/**
+	 * This method subtract two generic matrices, reusing the storage of the temporary matrix m.
+	 * @param m - the right hand side matrix.
+	 * @return subtraction of two generic matrices.
+	 * @throw logic error exception if the matrices dimensions do not suit each other.
+	 */
+	Matrix operator-(Matrix&& m) const &
+	{
+		checkMatrixDimensions(m);
+		MATRIX_PERF_SCOPE("subtract", FlopsOf<T>::ADD * _vectorMatrix.size());
+
+		m.combineInPlace(*this, [](std::size_t size, T* coords, const T* otherCoords)
+		{
+			ElementwiseKernels<T>::subtract(size, otherCoords, coords, coords);
+		});
+		return std :: move(m);
+	}
+
+	/**
+	 * This method subtract two temporary generic matrices, reusing the storage of this matrix.
+	 * @param m - the right hand side matrix.
+	 * @return subtraction of two generic matrices.
+	 * @throw logic error exception if the matrices dimensions do not suit each other.
+	 */
+	Matrix operator-(Matrix&& m) &&
+	{
+		*this -= m;
+		return std :: move(*this);
+	}
+
 	/**
 	 * This method checks validity of matrices multiplication.
 	 * @param m - the right hand side matrix.
@@ -195,35 +473,228 @@ template <class T> class Matrix
 	}
 
 	/**
-	 * This method multiply two generic matrices.
+	 * This method multiply two generic matrices. For arithmetic types it uses the packed,
+	 * cache-blocked kernel with register micro-tiles, for other types (such as Complex) the
+	 * generic kernel (see MatrixKernels). Large products are split into tiles of the result
+	 * which run on the threads of the global thread pool (see ThreadPool). Large square
+	 * products of floating point matrices go through Strassen-Winograd instead (see
+	 * StrassenKernels), unless it is disabled.
 	 * @param m - the right hand side matrix.
 	 * @return multiplication of two generic matrices.
 	 * @throw logic error of incompatible matrices dimensions.
 	 */
 	Matrix operator*(const  Matrix& m) const
 	{
-		checkValidityOfMatricesMultiplication(m);
+		return multiply(m);
+	}
 
-		T calculateCoord = T(0);
+	/**
+	 * This method multiplies by a matrix of another storage order (or allocator). The kernels
+	 * read both matrices in their own storage orders, so no transposed copy is made.
+	 * @tparam OtherAllocator - the allocator of the other matrix.
+	 * @tparam OtherOrder - the storage order of the other matrix.
+	 * @param m - the right hand side matrix.
+	 * @return multiplication of two generic matrices, in the storage order of this matrix.
+	 * @throw logic error of incompatible matrices dimensions.
+	 */
+	template <class OtherAllocator, StorageOrder OtherOrder>
+	Matrix operator*(const Matrix<T, OtherAllocator, OtherOrder>& m) const
+	{
+		return multiply(m);
+	}
 
-		Matrix result(_numOfRows, m._numOfCols);
+	/**
+	 * This method multiplies two matrices, summing the products in a wider accumulator type
+	 * (see AccumulatorOf): Matrix<int> products are summed in 64 bits and do not overflow, float
+	 * products in double, and 8 and 16 bit integers in 32 bits. The operands keep their narrow
+	 * type, and are converted as the kernel packs them, so the product reads them at their
+	 * size. The result is in the accumulator type; no Strassen-Winograd is used.
+	 * @tparam Accumulator - the accumulator type, by default AccumulatorOf<T>::type.
+	 * @tparam OtherAllocator - the allocator of the other matrix.
+	 * @tparam OtherOrder - the storage order of the other matrix.
+	 * @param m - the right hand side matrix.
+	 * @return multiplication of two generic matrices, in the storage order of this matrix.
+	 * @throw logic error of incompatible matrices dimensions.
+	 */
+	template <class Accumulator = typename AccumulatorOf<T>::type, class OtherAllocator,
+			  StorageOrder OtherOrder>
+	Matrix<Accumulator, PooledAllocator<Accumulator>, Order> widenedProduct(
+		const Matrix<T, OtherAllocator, OtherOrder>& m) const
+	{
+		if(m._numOfRows != _numOfCols)
+		{
+			throw std :: logic_error(INVALID_MULTIPLICATION_OF_MATRICES_ERROR);
+		}
+		MATRIX_PERF_SCOPE("widened multiply", FlopsOf<Accumulator>::MULTIPLY_ADD * _numOfRows *
+											  m._numOfCols * _numOfCols);
+		Matrix<Accumulator, PooledAllocator<Accumulator>, Order> result(_numOfRows, m._numOfCols);
+		MatrixKernels<Accumulator>::parallelGemm(_numOfRows, m._numOfCols, _numOfCols,
+												 _vectorMatrix.data(), rowStride(), colStride(),
+												 m._vectorMatrix.data(), m.rowStride(),
+												 m.colStride(), result.data(),
+												 result.rowStride(), result.colStride(), false);
+		return result;
+	}
 
-		for(unsigned int col = 0 ; col < m._numOfCols ; ++col)
+	/**
+	 * This method multiplies this matrix by a scalar in place.
+	 * @param scalar - the scalar.
+	 * @return a reference to this matrix.
+	 */
+	Matrix& operator*=(const T& scalar)
+	{
+		MATRIX_PERF_SCOPE("scale", FlopsOf<T>::MULTIPLY * _vectorMatrix.size());
+		combineInPlace(*this, [&scalar](std::size_t size, T* coords, const T*)
 		{
-			for(unsigned int row = 0 ; row < _numOfRows ; ++row)
-			{
-				for(unsigned int i = 0 ; i < _numOfCols ; ++i)
-				{
+			ElementwiseKernels<T>::scale(size, coords, scalar, coords);
+		});
+		return *(this);
+	}
 
-					calculateCoord += m(i, col) * (*this)(row, i);
-				}
-				result(row, col) = calculateCoord;
-				calculateCoord = T(0);
-			}
+	/**
+	 * This method multiplies a generic matrix by a scalar.
+	 * @param scalar - the scalar.
+	 * @return multiplication of the matrix by the scalar.
+	 */
+	Matrix operator*(const T& scalar) const &
+	{
+		Matrix result(*this);
+		result *= scalar;
+		return result;
+	}
+
+	/**
+	 * This method multiplies a temporary generic matrix by a scalar, reusing its storage.
+	 * @param scalar - the scalar.
+	 * @return multiplication of the matrix by the scalar.
+	 */
+	Matrix operator*(const T& scalar) &&
+	{
+		*this *= scalar;
+		return std :: move(*this);
+	}
+
+	/**
+	 * This method adds a scaled generic matrix to this matrix in place: this += alpha * x.
+	 * @param alpha - the scalar.
+	 * @param x - the scaled matrix.
+	 * @return a reference to this matrix.
+	 * @throw logic error exception if the matrices dimensions do not suit each other.
+	 */
+	Matrix& axpy(const T& alpha, const Matrix& x)
+	{
+		checkMatrixDimensions(x);
+		MATRIX_PERF_SCOPE("axpy", FlopsOf<T>::MULTIPLY_ADD * _vectorMatrix.size());
+
+		combineInPlace(x, [&alpha](std::size_t size, T* coords, const T* otherCoords)
+		{
+			ElementwiseKernels<T>::axpy(size, alpha, otherCoords, coords);
+		});
+		return *(this);
+	}
+
+	/**
+	 * This method multiplies two generic matrices coordinate by coordinate (the Hadamard
+	 * product).
+	 * @param m - the right hand side matrix.
+	 * @return the Hadamard product of the two matrices.
+	 * @throw logic error exception if the matrices dimensions do not suit each other.
+	 */
+	Matrix hadamard(const Matrix& m) const
+	{
+		checkMatrixDimensions(m);
+		MATRIX_PERF_SCOPE("hadamard", FlopsOf<T>::MULTIPLY * _vectorMatrix.size());
+
+		Matrix result(*this);
+		result.combineInPlace(m, [](std::size_t size, T* coords, const T* otherCoords)
+		{
+			ElementwiseKernels<T>::hadamard(size, coords, otherCoords, coords);
+		});
+		return result;
+	}
+
+	/**
+	 * This method sums the coordinates of the matrix.
+	 * @return the sum of the coordinates.
+	 */
+	T sum() const
+	{
+		return reduce<T>(ElementwiseKernels<T>::sum, [](const T& left, const T& right)
+		{
+			return left + right;
+		});
+	}
+
+	/**
+	 * This method finds the smallest coordinate of the matrix.
+	 * @return the smallest coordinate.
+	 */
+	T min() const
+	{
+		return reduce<T>(ElementwiseKernels<T>::min, [](const T& left, const T& right)
+		{
+			return right < left ? right : left;
+		});
+	}
+
+	/**
+	 * This method finds the largest coordinate of the matrix.
+	 * @return the largest coordinate.
+	 */
+	T max() const
+	{
+		return reduce<T>(ElementwiseKernels<T>::max, [](const T& left, const T& right)
+		{
+			return left < right ? right : left;
+		});
+	}
+
+	/**
+	 * This method calculates the Frobenius norm of the matrix (the square root of the sum of the
+	 * squares of the coordinates), in double precision.
+	 * @return the Frobenius norm of the matrix.
+	 */
+	double frobeniusNorm() const
+	{
+		return std :: sqrt(reduce<double>(ElementwiseKernels<T>::sumOfSquares,
+										  [](double left, double right)
+		{
+			return left + right;
+		}));
+	}
+
+	/**
+	 * This method calculates the trace of a square matrix (the sum of its diagonal).
+	 * @return the trace of the matrix.
+	 * @throw logic error of a non square matrix.
+	 */
+	T trace() const
+	{
+		if(!isSquareMatrix())
+		{
+			throw std :: logic_error(TRACE_OF_NON_SQUARE_MATRIX_ERROR);
+		}
+		T result = T(0);
+		for(unsigned int index = 0 ; index < _numOfRows ; ++index)
+		{
+			result += _vectorMatrix[index * ((std :: size_t) _numOfCols + 1)];
 		}
 		return result;
 	}
 
+	/**
+	 * This method multiplies this matrix by a generic matrix (this = this * m). The product
+	 * needs its own storage, which then replaces the storage of this matrix.
+	 * @param m - the right hand side matrix.
+	 * @return a reference to this matrix.
+	 * @throw logic error of incompatible matrices dimensions.
+	 */
+	Matrix& operator*=(const Matrix& m)
+	{
+		*this = *this * m;
+		return *(this);
+	}
+
 	/**
 	 * This method compares between two matrices.
 	 * @param m - the right hand side matrix.
@@ -272,42 +743,53 @@ template <class T> class Matrix
 	}
 
 	/**
-	 * This method transposes a generic matrix.
-	 * @return the transposed matrix.
-	 * @throw logic error of untransposable matrix exception.
+	 * This method transposes a generic matrix of any dimensions. A complex numbers matrix is
+	 * conjugated as well, so its transpose is its Hermitian matrix.
+	 * @return the transposed matrix, in the same storage order.
 	 */
 	Matrix trans() const
 	{
-		checkTranspose();
-
-		unsigned int transSize = _numOfCols;
-
-		Matrix result(transSize, transSize);
-
-		for(int col = 0 ; col < transSize ; ++col)
-		{
-			for(int row = 0 ; row < transSize ; ++row)
-			{
-				result(col, row) = (*this)(row, col);
-			}
-		}
-
+		MATRIX_PERF_SCOPE("transpose", 0);
+		Matrix result(_numOfCols, _numOfRows);
+		MatrixKernels<T> :: transpose(numOfMajors(), numOfMinors(), _vectorMatrix.data(),
+									  numOfMinors(), result._vectorMatrix.data(), numOfMajors(),
+									  transposedCoordinate());
 		return result;
+	}
 
+	/**
+	 * This method transposes a squared matrix in place, without allocating another matrix.
+	 * A complex numbers matrix is conjugated as well.
+	 * @return a reference to this matrix.
+	 * @throw logic error of untransposable matrix exception.
+	 */
+	Matrix& transposeInPlace()
+	{
+		checkTranspose();
+		MATRIX_PERF_SCOPE("transpose in place", 0);
+		MatrixKernels<T> :: transposeInPlace(_numOfRows, _vectorMatrix.data(), _numOfCols,
+											 transposedCoordinate());
+		return *(this);
 	}
 
 	/**
-	 * This method checks index out of bounds exception for accessing a matrix coordinate.
+	 * This method checks index out of bounds exception for accessing a matrix coordinate. It
+	 * does nothing if MATRIX_BOUNDS_CHECK is 0 (by default, in a build with NDEBUG).
 	 * @param row - the coordinate row
 	 * @param column - the coordinate column
 	 * @throw out of range exception of index out of bounds.
 	 */
 	void checkIndexOutOfBounds(const unsigned int row, const unsigned int column) const
 	{
+#if MATRIX_BOUNDS_CHECK
 		if(!(column < _numOfCols && row < _numOfRows))
 		{
 			throw std :: out_of_range(INDEX_OUT_OF_BOUNDS_ERROR);
 		}
+#else
+		(void) row;
+		(void) column;
+#endif
 	}
 
 	/**
@@ -317,11 +799,11 @@ template <class T> class Matrix
 	 * @return matrix coordinate (row, column).
 	 * @throw out of range exception of index out of bounds.
 	 */
-	T const operator()(const unsigned int row, const unsigned int column) const
+	const T& operator()(const unsigned int row, const unsigned int column) const
 	{
 		checkIndexOutOfBounds(row, column);
 
-		return _vectorMatrix[column + _numOfCols * row];
+		return _vectorMatrix[indexOf(row, column)];
 	}
 
 	/**
@@ -335,7 +817,51 @@ template <class T> class Matrix
 	{
 		checkIndexOutOfBounds(row, column);
 
-		return _vectorMatrix[column + _numOfCols * row];
+		return _vectorMatrix[indexOf(row, column)];
+	}
+
+	/**
+	 * This method accesses a matrix coordinate without checking the indices, for loops which
+	 * stay inside the matrix by construction.
+	 * @param row - the coordinate row, smaller than rows().
+	 * @param column - the coordinate column, smaller than cols().
+	 * @return matrix coordinate (row, column).
+	 */
+	const T& at_unchecked(const unsigned int row, const unsigned int column) const
+	{
+		return _vectorMatrix[indexOf(row, column)];
+	}
+
+	/**
+	 * This method accesses a matrix coordinate without checking the indices, for loops which
+	 * stay inside the matrix by construction.
+	 * @param row - the coordinate row, smaller than rows().
+	 * @param column - the coordinate column, smaller than cols().
+	 * @return matrix coordinate (row, column).
+	 */
+	T& at_unchecked(const unsigned int row, const unsigned int column)
+	{
+		return _vectorMatrix[indexOf(row, column)];
+	}
+
+	/**
+	 * This method returns the storage of the matrix: coordinate (row, column) is at
+	 * data()[row * rowStride() + column * colStride()].
+	 * @return the storage.
+	 */
+	const T* data() const
+	{
+		return _vectorMatrix.data();
+	}
+
+	/**
+	 * This method returns the storage of the matrix: coordinate (row, column) is at
+	 * data()[row * rowStride() + column * colStride()].
+	 * @return the storage.
+	 */
+	T* data()
+	{
+		return _vectorMatrix.data();
 	}
 
 	/**
@@ -350,11 +876,11 @@ template <class T> class Matrix
 		{
 			for(unsigned int col = 0 ; col < m._numOfCols ; ++col)
 			{
-				os << m(row, col);
+				os << m.at_unchecked(row, col);
 				os << SEPARATOR_OF_A_TAB;
 			}
 
-			os << std :: endl;
+			os << '\n';
 
 		}
 
@@ -384,50 +910,240 @@ template <class T> class Matrix
 
 	}
 
-	private:
+	/**
+	 * This method iterates over a generic matrix, with write access to its cells.
+	 * @return generic matrix iterator.
+	 */
+	iterator begin()
+	{
+
+		return _vectorMatrix.begin();
+
+	}
 
 	/**
-	 * Number of rows in the generic matrix.
+	 * This method returns the address after the last cell of a given generic matrix.
+	 * @return the address after the last cell of a given generic matrix.
 	 */
-	unsigned int _numOfRows;
+	iterator end()
+	{
+
+		return _vectorMatrix.end();
+
+	}
 
 	/**
-	 * Number of columns in the generic matrix.
+	 * This method iterates over a generic matrix.
+	 * @return generic matrix iterator.
 	 */
-	unsigned int _numOfCols;
+	const_iterator cbegin() const
+	{
+
+		return _vectorMatrix.cbegin();
+
+	}
 
 	/**
-	 * The generic matrix values are stored in a generic vector.
+	 * This method returns the address after the last cell of a given generic matrix.
+	 * @return the address after the last cell of a given generic matrix.
 	 */
-	std :: vector<T> _vectorMatrix;
+	const_iterator cend() const
+	{
 
-};
+		return _vectorMatrix.cend();
 
-/**
- * This method is a specialization of the trans method for a complex numbers matrix.
- * It calculates the Hermitian matrix of a complex numbers matrix.
- * @return the Hermitian matrix of a complex numbers matrix.
- * @throw logic error of untransposable matrix exception.
- */
-template <> Matrix<Complex> Matrix<Complex> :: trans() const
-{
-	checkTranspose();
+	}
+
+	private:
+
+	template <class OtherT, class OtherAllocator, StorageOrder OtherOrder> friend class Matrix;
+
+	friend class MatrixReference<T>;
+
+	friend class SparseMatrix<T>;
+
+	friend class ConstMatrixView<T>;
+
+	friend class MatrixView<T>;
+
+	/**
+	 * This method returns the operation which trans applies to every coordinate: the conjugate
+	 * of a complex number, or nothing for other types.
+	 * @return the coordinate operation.
+	 */
+	static auto transposedCoordinate()
+	{
+		if constexpr (std :: is_same<T, Complex>::value)
+		{
+			return [](const Complex& coord)
+			{
+				return coord.conj();
+			};
+		}
+		else
+		{
+			return IdentityCoordinate();
+		}
+	}
 
-	unsigned int transSize = this->_numOfRows;
+	/**
+	 * This method returns the number of major lines of the storage: rows for a row-major matrix,
+	 * columns for a column-major one.
+	 * @return the number of major lines.
+	 */
+	unsigned int numOfMajors() const
+	{
+		return Order == StorageOrder::RowMajor ? _numOfRows : _numOfCols;
+	}
 
-	Matrix<Complex> result(transSize, transSize);
+	/**
+	 * This method returns the length of a major line of the storage.
+	 * @return the number of minor lines.
+	 */
+	unsigned int numOfMinors() const
+	{
+		return Order == StorageOrder::RowMajor ? _numOfCols : _numOfRows;
+	}
+
+	/**
+	 * This method returns the index of a coordinate in the storage.
+	 * @param row - the coordinate row
+	 * @param column - the coordinate column
+	 * @return the index of coordinate (row, column).
+	 */
+	std :: size_t indexOf(unsigned int row, unsigned int column) const
+	{
+		return row * (std :: size_t) rowStride() + column * (std :: size_t) colStride();
+	}
+
+	/**
+	 * This method evaluates a lazy matrix expression into the storage of this matrix, which has
+	 * its dimensions. A column-major matrix is the row-major storage of its transpose, so it
+	 * receives the transposed expression, and a product is computed straight into it.
+	 * @tparam Expression - the type of the expression.
+	 * @param expression - the expression.
+	 */
+	template <class Expression> void evaluate(const MatrixExpression<T, Expression>& expression)
+	{
+		if constexpr (Order == StorageOrder::RowMajor)
+		{
+			expression.evaluateInto(_vectorMatrix.data());
+		}
+		else if constexpr (IsProductExpression<Expression>::value)
+		{
+			expression.derived().multiplyInto(_vectorMatrix.data(), rowStride(), colStride(),
+											  false);
+		}
+		else
+		{
+			expression.trans().evaluateInto(_vectorMatrix.data());
+		}
+	}
 
-	for(unsigned int col = 0 ; col < transSize ; ++col)
+	/**
+	 * This method multiplies by a matrix of any storage order. Square products of matrices of
+	 * the same storage order may go through Strassen-Winograd, which is row-major: a
+	 * column-major product is the row-major C^T = B^T * A^T, which has the same storage.
+	 * @tparam Other - the type of the other matrix.
+	 * @param m - the right hand side matrix.
+	 * @return multiplication of two generic matrices, in the storage order of this matrix.
+	 * @throw logic error of incompatible matrices dimensions.
+	 */
+	template <class Other> Matrix multiply(const Other& m) const
 	{
-		for(unsigned int row = 0 ; row < transSize ; ++row)
+		if(m._numOfRows != _numOfCols)
 		{
-			Complex tempComplex = (*this)(row, col).conj();
-			result(col, row) = tempComplex;
+			throw std :: logic_error(INVALID_MULTIPLICATION_OF_MATRICES_ERROR);
 		}
+		MATRIX_PERF_SCOPE("multiply", FlopsOf<T>::MULTIPLY_ADD * _numOfRows * m._numOfCols *
+									  _numOfCols);
+
+		Matrix result(_numOfRows, m._numOfCols);
+
+		if(Other::ORDER == Order && StrassenKernels<T>::isUsedFor(_numOfRows, m._numOfCols,
+																  _numOfCols))
+		{
+			const T* left = _vectorMatrix.data();
+			const T* right = m._vectorMatrix.data();
+			if(Order == StorageOrder::ColMajor)
+			{
+				std :: swap(left, right);
+			}
+			StrassenKernels<T>::multiply(_numOfRows, left, _numOfRows, right, _numOfRows,
+										 result._vectorMatrix.data(), _numOfRows);
+			return result;
+		}
+		MatrixKernels<T>::parallelGemm(_numOfRows, m._numOfCols, _numOfCols,
+									   _vectorMatrix.data(), rowStride(), colStride(),
+									   m._vectorMatrix.data(), m.rowStride(), m.colStride(),
+									   result._vectorMatrix.data(), result.rowStride(),
+									   result.colStride(), false);
+		return result;
+	}
+
+	/**
+	 * This method combines the coordinates of this matrix with the same coordinates of m, in
+	 * place. Large matrices are split into contiguous ranges which run on the threads of the
+	 * global thread pool. The dimensions should be checked before.
+	 * @tparam Kernel - the type of the kernel.
+	 * @param m - the other matrix.
+	 * @param kernel - called as kernel(size, coords of this, coords of m) on every range.
+	 */
+	template <class Kernel> void combineInPlace(const Matrix& m, Kernel kernel)
+	{
+		T* coords = _vectorMatrix.data();
+		const T* otherCoords = m._vectorMatrix.data();
+		ThreadPool::instance().parallelRanges(_vectorMatrix.size(), PARALLEL_ELEMENTWISE_CHUNK,
+											  [&](std::size_t begin, std::size_t end)
+		{
+			kernel(end - begin, coords + begin, otherCoords + begin);
+		});
 	}
 
-	return result;
+	/**
+	 * This method reduces the coordinates of the matrix. Large matrices are split into
+	 * contiguous ranges which are reduced on the threads of the global thread pool, and the
+	 * partial results are combined in order.
+	 * @tparam Result - the type of the result.
+	 * @tparam Kernel - the type of the kernel.
+	 * @tparam Combine - the type of the combine function.
+	 * @param kernel - called as kernel(size, coords) on every range.
+	 * @param combine - combines two partial results.
+	 * @return the reduction of the coordinates.
+	 */
+	template <class Result, class Kernel, class Combine>
+	Result reduce(Kernel kernel, Combine combine) const
+	{
+		const T* coords = _vectorMatrix.data();
+		return ThreadPool::instance().parallelReduce<Result>(
+				_vectorMatrix.size(), PARALLEL_ELEMENTWISE_CHUNK,
+				[&](std::size_t begin, std::size_t end)
+		{
+			return kernel(end - begin, coords + begin);
+		}, combine);
+	}
 
-}
+	/**
+	 * Number of rows in the generic matrix.
+	 */
+	unsigned int _numOfRows;
+
+	/**
+	 * Number of columns in the generic matrix.
+	 */
+	unsigned int _numOfCols;
+
+	/**
+	 * The generic matrix values are stored in a generic vector.
+	 */
+	std :: vector<T, Allocator> _vectorMatrix;
+
+};
+
+/**
+ * This type represents a generic matrix which stores its coordinates column by column.
+ */
+template <class T, class Allocator = PooledAllocator<T>>
+using ColMajorMatrix = Matrix<T, Allocator, StorageOrder::ColMajor>;
 
 #endif
@@ -0,0 +1,1042 @@
+//================================ Includes =====================================================
+#include "Matrix.hpp"
+#include "MatrixKernels.hpp"
+#include "ThreadPool.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+//================================ Constants ====================================================
+#ifndef CPP3_MATRIX_EXPRESSIONS_H
+#define CPP3_MATRIX_EXPRESSIONS_H
+//================================ Code Segment =================================================
+
+/**
+ * This file is an opt-in lazy evaluation layer for Matrix<T>. lazy(A) wraps a matrix in an
+ * expression, and +, -, * and trans() on expressions build a tree of expression objects instead
+ * of computing temporary matrices. The tree is evaluated when it is assigned to a Matrix:
+ * - chains of + and - are fused into a single pass over memory,
+ * - A * B + C and A * B - C run as a GEMM into the destination and one fused pass,
+ * - trans() of a matrix is a strided view, which the element-wise loops and the GEMM read
+ * directly, without a transposed copy.
+ * For example: Matrix<double> R = lazy(A) * B + C - lazy(D).trans();
+ * Like the matrices it refers to, an expression should not outlive the statement it is in.
+ */
+
+template <class T> class MatrixReference;
+
+template <class T> struct StorageRegion;
+
+template <class T, class Left, class Right> class ProductExpression;
+
+template <class T, class Operand> class TransposeExpression;
+
+/**
+ * This struct tells whether an expression type is a product.
+ * @tparam Expression - the expression type.
+ */
+template <class Expression> struct IsProductExpression : std::false_type
+{
+
+};
+
+/**
+ * This struct tells whether an expression type is a product.
+ * @tparam T - the generic type of a coordinate.
+ * @tparam Left - the type of the left operand.
+ * @tparam Right - the type of the right operand.
+ */
+template <class T, class Left, class Right>
+struct IsProductExpression<ProductExpression<T, Left, Right>> : std::true_type
+{
+
+};
+
+/**
+ * This struct represents the addition of two coordinates.
+ */
+struct AddOperation
+{
+	/**
+	 * This method adds two coordinates.
+	 * @param left - the left coordinate.
+	 * @param right - the right coordinate.
+	 * @return left + right.
+	 */
+	template <class T> static T apply(const T& left, const T& right)
+	{
+		return left + right;
+	}
+};
+
+/**
+ * This struct represents the subtraction of two coordinates.
+ */
+struct SubtractOperation
+{
+	/**
+	 * This method subtracts two coordinates.
+	 * @param left - the left coordinate.
+	 * @param right - the right coordinate.
+	 * @return left - right.
+	 */
+	template <class T> static T apply(const T& left, const T& right)
+	{
+		return left - right;
+	}
+};
+
+/**
+ * This class is the base of all the matrix expressions (the curiously recurring template
+ * pattern). An expression has dimensions, can be prepared (products inside it are computed) and
+ * then read coordinate by coordinate, and can be evaluated into the row-major storage of a
+ * matrix.
+ * @tparam T - the generic type of a coordinate.
+ * @tparam Expression - the type of the derived expression.
+ */
+template <class T, class Expression> class MatrixExpression
+{
+	public:
+
+	/**
+	 * This method returns the derived expression.
+	 * @return the derived expression.
+	 */
+	const Expression& derived() const
+	{
+		return static_cast<const Expression&>(*this);
+	}
+
+	/**
+	 * This method returns number of rows of the expression.
+	 * @return number of rows of the expression.
+	 */
+	unsigned int rows() const
+	{
+		return derived().rows();
+	}
+
+	/**
+	 * This method returns number of columns of the expression.
+	 * @return number of columns of the expression.
+	 */
+	unsigned int cols() const
+	{
+		return derived().cols();
+	}
+
+	/**
+	 * This method evaluates the expression into the row-major storage of a matrix of its
+	 * dimensions. Element-wise expressions are evaluated in a single fused pass.
+	 * @param destination - the storage of the matrix.
+	 */
+	void evaluateInto(T* destination) const
+	{
+		derived().evaluateInto(destination);
+	}
+
+	/**
+	 * This method checks if the expression reads the storage of a matrix, in which case it
+	 * cannot be evaluated into that storage.
+	 * @param data - the storage of the matrix.
+	 * @return true if the expression refers to the storage, false otherwise.
+	 */
+	bool refersTo(const T* data) const
+	{
+		return derived().refersTo(data);
+	}
+
+	/**
+	 * This method checks if the expression reads a region of the storage of a matrix, in which
+	 * case it cannot be evaluated into that region (see MatrixView.hpp).
+	 * @param region - the region.
+	 * @return true if the expression reads coordinates of the region, false otherwise.
+	 */
+	bool reads(const StorageRegion<T>& region) const
+	{
+		return derived().reads(region);
+	}
+
+	/**
+	 * This method evaluates the expression into a new matrix.
+	 * @return the value of the expression.
+	 */
+	Matrix<T> eval() const
+	{
+		return Matrix<T>(*this);
+	}
+
+	/**
+	 * This method returns the transposed view of the expression.
+	 * @return the transposed expression.
+	 */
+	TransposeExpression<T, Expression> trans() const
+	{
+		return TransposeExpression<T, Expression>(derived());
+	}
+
+	/**
+	 * This method evaluates an element-wise expression in a single pass and combines every
+	 * coordinate of it with the destination. Contiguous expressions are read by linear index,
+	 * the others (such as transposed views) row by row. Large expressions run on the threads of
+	 * the global thread pool.
+	 * @tparam Combine - the type of the combine function.
+	 * @param destination - the row-major storage of a matrix of the dimensions of the expression.
+	 * @param combine - called as combine(destination coordinate, expression coordinate).
+	 */
+	template <class Combine> void combineElementwise(T* destination, Combine combine) const
+	{
+		const Expression& expression = derived();
+		expression.prepare();
+		unsigned int numOfCols = expression.cols();
+		if(expression.isContiguous())
+		{
+			ThreadPool::instance().parallelRanges(
+					(std::size_t) expression.rows() * numOfCols, PARALLEL_ELEMENTWISE_CHUNK,
+					[&](std::size_t begin, std::size_t end)
+			{
+				for(std::size_t index = begin ; index < end ; ++index)
+				{
+					combine(destination[index], expression.atIndex(index));
+				}
+			});
+			return;
+		}
+		ThreadPool::instance().parallelRanges(
+				expression.rows(), std::max(1u, PARALLEL_ELEMENTWISE_CHUNK / numOfCols),
+				[&](std::size_t beginRow, std::size_t endRow)
+		{
+			for(std::size_t row = beginRow ; row < endRow ; ++row)
+			{
+				T* destinationRow = destination + row * numOfCols;
+				for(unsigned int col = 0 ; col < numOfCols ; ++col)
+				{
+					combine(destinationRow[col], expression.at((unsigned int) row, col));
+				}
+			}
+		});
+	}
+
+	/**
+	 * This method evaluates an element-wise expression into the destination in a single pass.
+	 * @param destination - the row-major storage of a matrix of the dimensions of the expression.
+	 */
+	void assignElementwise(T* destination) const
+	{
+		combineElementwise(destination, [](T& coord, const T& value)
+		{
+			coord = value;
+		});
+	}
+
+};
+
+/**
+ * This struct represents a rectangle of the storage of a matrix: the rows [beginRow, endRow) and
+ * the columns [beginCol, endCol) of the matrix whose storage starts at origin.
+ * @tparam T - the generic type of a coordinate.
+ */
+template <class T> struct StorageRegion
+{
+	const T* origin;
+	unsigned int beginRow;
+	unsigned int endRow;
+	unsigned int beginCol;
+	unsigned int endCol;
+
+	/**
+	 * This method checks if two regions share coordinates.
+	 * @param other - the other region.
+	 * @return true if the regions intersect, false otherwise.
+	 */
+	bool intersects(const StorageRegion& other) const
+	{
+		return origin == other.origin && beginRow < other.endRow && other.beginRow < endRow &&
+			   beginCol < other.endCol && other.beginCol < endCol;
+	}
+};
+
+/**
+ * This struct represents an operand of a GEMM: strided storage, as the kernels expect it.
+ * @tparam T - the generic type of a coordinate.
+ */
+template <class T> struct StridedOperand
+{
+	const T* data;
+	std::ptrdiff_t rowStride;
+	std::ptrdiff_t colStride;
+};
+
+/**
+ * This class represents a matrix (or a transposed view of it) inside an expression. It only
+ * refers to the storage of the matrix, so it is cheap to copy.
+ * @tparam T - the generic type of a coordinate.
+ */
+template <class T> class MatrixReference : public MatrixExpression<T, MatrixReference<T>>
+{
+	public:
+
+	/**
+	 * This constructor refers to a matrix.
+	 * @param m - the matrix.
+	 */
+	explicit MatrixReference(const Matrix<T>& m) : _data(m._vectorMatrix.data()),
+	_numOfRows(m._numOfRows), _numOfCols(m._numOfCols), _rowStride(m._numOfCols), _colStride(1)
+	{
+
+	}
+
+	/**
+	 * This method returns number of rows of the view.
+	 * @return number of rows of the view.
+	 */
+	unsigned int rows() const
+	{
+		return _numOfRows;
+	}
+
+	/**
+	 * This method returns number of columns of the view.
+	 * @return number of columns of the view.
+	 */
+	unsigned int cols() const
+	{
+		return _numOfCols;
+	}
+
+	/**
+	 * This method returns the transposed view: the same storage with swapped strides.
+	 * @return the transposed view.
+	 */
+	MatrixReference trans() const
+	{
+		MatrixReference result(*this);
+		std::swap(result._numOfRows, result._numOfCols);
+		std::swap(result._rowStride, result._colStride);
+		return result;
+	}
+
+	/**
+	 * This method prepares the view for reading (nothing to do).
+	 */
+	void prepare() const
+	{
+
+	}
+
+	/**
+	 * This method checks if the view can be read by linear index in row-major order.
+	 * @return true if the view is not transposed, false otherwise.
+	 */
+	bool isContiguous() const
+	{
+		return _colStride == 1;
+	}
+
+	/**
+	 * This method reads a coordinate of the view.
+	 * @param row - the coordinate row.
+	 * @param column - the coordinate column.
+	 * @return the coordinate (row, column).
+	 */
+	const T& at(unsigned int row, unsigned int column) const
+	{
+		return _data[row * _rowStride + column * _colStride];
+	}
+
+	/**
+	 * This method reads a coordinate of a contiguous view by its row-major index.
+	 * @param index - the index.
+	 * @return the coordinate.
+	 */
+	const T& atIndex(std::size_t index) const
+	{
+		return _data[index];
+	}
+
+	/**
+	 * This method evaluates the view into the storage of a matrix.
+	 * @param destination - the row-major storage of a matrix of the dimensions of the view.
+	 */
+	void evaluateInto(T* destination) const
+	{
+		this->assignElementwise(destination);
+	}
+
+	/**
+	 * This method checks if the view is a view of the storage of a matrix.
+	 * @param data - the storage of the matrix.
+	 * @return true if the view refers to the storage, false otherwise.
+	 */
+	bool refersTo(const T* data) const
+	{
+		return _data == data;
+	}
+
+	/**
+	 * This method checks if the view reads a region of the storage of a matrix.
+	 * @param region - the region.
+	 * @return true if the region is in the storage of the matrix, false otherwise.
+	 */
+	bool reads(const StorageRegion<T>& region) const
+	{
+		return region.origin == _data;
+	}
+
+	/**
+	 * This method returns the view as a GEMM operand, without copying it.
+	 * @return the view as a GEMM operand.
+	 */
+	StridedOperand<T> strided(std::vector<T>&) const
+	{
+		return {_data, _rowStride, _colStride};
+	}
+
+	private:
+
+	/**
+	 * The storage of the matrix.
+	 */
+	const T* _data;
+
+	/**
+	 * Number of rows of the view.
+	 */
+	unsigned int _numOfRows;
+
+	/**
+	 * Number of columns of the view.
+	 */
+	unsigned int _numOfCols;
+
+	/**
+	 * The distance between two rows of the view.
+	 */
+	std::ptrdiff_t _rowStride;
+
+	/**
+	 * The distance between two columns of the view.
+	 */
+	std::ptrdiff_t _colStride;
+
+};
+
+/**
+ * This class represents an element-wise operation (+ or -) of two expressions.
+ * @tparam T - the generic type of a coordinate.
+ * @tparam Left - the type of the left operand.
+ * @tparam Right - the type of the right operand.
+ * @tparam Operation - AddOperation or SubtractOperation.
+ */
+template <class T, class Left, class Right, class Operation>
+class ElementwiseExpression : public MatrixExpression<T, ElementwiseExpression<T, Left, Right,
+																			   Operation>>
+{
+	public:
+
+	/**
+	 * This constructor combines two expressions.
+	 * @param left - the left operand.
+	 * @param right - the right operand.
+	 * @throw logic error exception if the dimensions of the operands do not suit each other.
+	 */
+	ElementwiseExpression(const Left& left, const Right& right) : _left(left), _right(right)
+	{
+		if(left.rows() != right.rows() || left.cols() != right.cols())
+		{
+			throw std :: logic_error(INCOMPATIBLE_DIMENSIONS_OF_MATRICES_ERROR);
+		}
+	}
+
+	/**
+	 * This method returns number of rows of the expression.
+	 * @return number of rows of the expression.
+	 */
+	unsigned int rows() const
+	{
+		return _left.rows();
+	}
+
+	/**
+	 * This method returns number of columns of the expression.
+	 * @return number of columns of the expression.
+	 */
+	unsigned int cols() const
+	{
+		return _left.cols();
+	}
+
+	/**
+	 * This method prepares the operands for reading.
+	 */
+	void prepare() const
+	{
+		_left.prepare();
+		_right.prepare();
+	}
+
+	/**
+	 * This method checks if the expression can be read by linear index in row-major order.
+	 * @return true if both operands can, false otherwise.
+	 */
+	bool isContiguous() const
+	{
+		return _left.isContiguous() && _right.isContiguous();
+	}
+
+	/**
+	 * This method computes a coordinate of the expression.
+	 * @param row - the coordinate row.
+	 * @param column - the coordinate column.
+	 * @return the coordinate (row, column).
+	 */
+	T at(unsigned int row, unsigned int column) const
+	{
+		return Operation::apply(_left.at(row, column), _right.at(row, column));
+	}
+
+	/**
+	 * This method computes a coordinate of a contiguous expression by its row-major index.
+	 * @param index - the index.
+	 * @return the coordinate.
+	 */
+	T atIndex(std::size_t index) const
+	{
+		return Operation::apply(_left.atIndex(index), _right.atIndex(index));
+	}
+
+	/**
+	 * This method evaluates the expression into the storage of a matrix. A product operand is
+	 * computed by the GEMM directly into the destination: P + E and E + P evaluate E and then
+	 * accumulate P onto it, P - E evaluates P and then subtracts E from it in the same pass.
+	 * Otherwise the whole expression is evaluated in a single fused pass.
+	 * @param destination - the row-major storage of a matrix of the dimensions of the expression.
+	 */
+	void evaluateInto(T* destination) const
+	{
+		constexpr bool isAddition = std::is_same<Operation, AddOperation>::value;
+		if constexpr (IsProductExpression<Left>::value && isAddition)
+		{
+			_right.evaluateInto(destination);
+			_left.accumulateInto(destination);
+		}
+		else if constexpr (IsProductExpression<Right>::value && isAddition)
+		{
+			_left.evaluateInto(destination);
+			_right.accumulateInto(destination);
+		}
+		else if constexpr (IsProductExpression<Left>::value)
+		{
+			_left.evaluateInto(destination);
+			_right.combineElementwise(destination, [](T& coord, const T& value)
+			{
+				coord = Operation::apply(coord, value);
+			});
+		}
+		else
+		{
+			this->assignElementwise(destination);
+		}
+	}
+
+	/**
+	 * This method checks if one of the operands reads the storage of a matrix.
+	 * @param data - the storage of the matrix.
+	 * @return true if the expression refers to the storage, false otherwise.
+	 */
+	bool refersTo(const T* data) const
+	{
+		return _left.refersTo(data) || _right.refersTo(data);
+	}
+
+	/**
+	 * This method checks if one of the operands reads a region of the storage of a matrix.
+	 * @param region - the region.
+	 * @return true if an operand reads coordinates of the region, false otherwise.
+	 */
+	bool reads(const StorageRegion<T>& region) const
+	{
+		return _left.reads(region) || _right.reads(region);
+	}
+
+	/**
+	 * This method evaluates the expression as a GEMM operand, into a buffer.
+	 * @param buffer - the buffer which holds the value of the expression.
+	 * @return the expression as a GEMM operand.
+	 */
+	StridedOperand<T> strided(std::vector<T>& buffer) const
+	{
+		buffer.resize((std::size_t) rows() * cols());
+		evaluateInto(buffer.data());
+		return {buffer.data(), cols(), 1};
+	}
+
+	private:
+
+	/**
+	 * The left operand.
+	 */
+	Left _left;
+
+	/**
+	 * The right operand.
+	 */
+	Right _right;
+
+};
+
+/**
+ * This class represents the product of two expressions. Operands which are matrices or
+ * transposed matrices are passed to the GEMM as strided storage, other operands are evaluated
+ * first. When the product is read coordinate by coordinate (inside an element-wise expression
+ * which cannot fold it), it is computed once into a buffer by prepare().
+ * @tparam T - the generic type of a coordinate.
+ * @tparam Left - the type of the left operand.
+ * @tparam Right - the type of the right operand.
+ */
+template <class T, class Left, class Right>
+class ProductExpression : public MatrixExpression<T, ProductExpression<T, Left, Right>>
+{
+	public:
+
+	/**
+	 * This constructor multiplies two expressions.
+	 * @param left - the left operand.
+	 * @param right - the right operand.
+	 * @throw logic error of incompatible matrices dimensions.
+	 */
+	ProductExpression(const Left& left, const Right& right) : _left(left), _right(right)
+	{
+		if(left.cols() != right.rows())
+		{
+			throw std :: logic_error(INVALID_MULTIPLICATION_OF_MATRICES_ERROR);
+		}
+	}
+
+	/**
+	 * This method returns number of rows of the product.
+	 * @return number of rows of the product.
+	 */
+	unsigned int rows() const
+	{
+		return _left.rows();
+	}
+
+	/**
+	 * This method returns number of columns of the product.
+	 * @return number of columns of the product.
+	 */
+	unsigned int cols() const
+	{
+		return _right.cols();
+	}
+
+	/**
+	 * This method computes the product into a buffer, so it can be read coordinate by
+	 * coordinate.
+	 */
+	void prepare() const
+	{
+		if(_value.empty())
+		{
+			_value.resize((std::size_t) rows() * cols());
+			evaluateInto(_value.data());
+		}
+	}
+
+	/**
+	 * This method checks if the product can be read by linear index (it always can once it is
+	 * prepared).
+	 * @return true.
+	 */
+	bool isContiguous() const
+	{
+		return true;
+	}
+
+	/**
+	 * This method reads a coordinate of the prepared product.
+	 * @param row - the coordinate row.
+	 * @param column - the coordinate column.
+	 * @return the coordinate (row, column).
+	 */
+	const T& at(unsigned int row, unsigned int column) const
+	{
+		return _value[(std::size_t) row * cols() + column];
+	}
+
+	/**
+	 * This method reads a coordinate of the prepared product by its row-major index.
+	 * @param index - the index.
+	 * @return the coordinate.
+	 */
+	const T& atIndex(std::size_t index) const
+	{
+		return _value[index];
+	}
+
+	/**
+	 * This method computes the product into the storage of a matrix.
+	 * @param destination - the row-major storage of a matrix of the dimensions of the product.
+	 */
+	void evaluateInto(T* destination) const
+	{
+		multiply(destination, false);
+	}
+
+	/**
+	 * This method adds the product to the storage of a matrix (a GEMM with accumulation).
+	 * @param destination - the row-major storage of a matrix of the dimensions of the product.
+	 */
+	void accumulateInto(T* destination) const
+	{
+		multiply(destination, true);
+	}
+
+	/**
+	 * This method checks if one of the operands reads the storage of a matrix.
+	 * @param data - the storage of the matrix.
+	 * @return true if the expression refers to the storage, false otherwise.
+	 */
+	bool refersTo(const T* data) const
+	{
+		return _left.refersTo(data) || _right.refersTo(data);
+	}
+
+	/**
+	 * This method checks if one of the operands reads a region of the storage of a matrix.
+	 * @param region - the region.
+	 * @return true if an operand reads coordinates of the region, false otherwise.
+	 */
+	bool reads(const StorageRegion<T>& region) const
+	{
+		return _left.reads(region) || _right.reads(region);
+	}
+
+	/**
+	 * This method computes the product as a GEMM operand, into a buffer.
+	 * @param buffer - the buffer which holds the product.
+	 * @return the product as a GEMM operand.
+	 */
+	StridedOperand<T> strided(std::vector<T>& buffer) const
+	{
+		buffer.resize((std::size_t) rows() * cols());
+		evaluateInto(buffer.data());
+		return {buffer.data(), cols(), 1};
+	}
+
+	/**
+	 * This method runs the GEMM of the operands into strided storage, such as a block of a
+	 * matrix. The destination should not overlap the operands.
+	 * @param destination - the storage of a matrix of the dimensions of the product.
+	 * @param rowStride - the distance between two rows of the destination.
+	 * @param colStride - the distance between two columns of the destination.
+	 * @param accumulate - true to add the product to the destination, false to overwrite it.
+	 */
+	void multiplyInto(T* destination, std::ptrdiff_t rowStride, std::ptrdiff_t colStride,
+					  bool accumulate) const
+	{
+		std::vector<T> leftBuffer, rightBuffer;
+		StridedOperand<T> left = _left.strided(leftBuffer);
+		StridedOperand<T> right = _right.strided(rightBuffer);
+		MatrixKernels<T>::parallelGemm(rows(), cols(), _left.cols(),
+									   left.data, left.rowStride, left.colStride,
+									   right.data, right.rowStride, right.colStride,
+									   destination, rowStride, colStride, accumulate);
+	}
+
+	private:
+
+	/**
+	 * This method runs the GEMM of the operands into the storage of a matrix.
+	 * @param destination - the row-major storage of a matrix of the dimensions of the product.
+	 * @param accumulate - true to add the product to the destination, false to overwrite it.
+	 */
+	void multiply(T* destination, bool accumulate) const
+	{
+		multiplyInto(destination, cols(), 1, accumulate);
+	}
+
+	/**
+	 * The left operand.
+	 */
+	Left _left;
+
+	/**
+	 * The right operand.
+	 */
+	Right _right;
+
+	/**
+	 * The value of the product, once it is prepared.
+	 */
+	mutable std::vector<T> _value;
+
+};
+
+/**
+ * This class represents the transposed view of an expression which is not a plain matrix
+ * (a plain matrix is transposed by swapping the strides of its MatrixReference).
+ * @tparam T - the generic type of a coordinate.
+ * @tparam Operand - the type of the transposed expression.
+ */
+template <class T, class Operand>
+class TransposeExpression : public MatrixExpression<T, TransposeExpression<T, Operand>>
+{
+	public:
+
+	/**
+	 * This constructor transposes an expression.
+	 * @param operand - the transposed expression.
+	 */
+	explicit TransposeExpression(const Operand& operand) : _operand(operand)
+	{
+
+	}
+
+	/**
+	 * This method returns number of rows of the transposed expression.
+	 * @return number of rows of the transposed expression.
+	 */
+	unsigned int rows() const
+	{
+		return _operand.cols();
+	}
+
+	/**
+	 * This method returns number of columns of the transposed expression.
+	 * @return number of columns of the transposed expression.
+	 */
+	unsigned int cols() const
+	{
+		return _operand.rows();
+	}
+
+	/**
+	 * This method prepares the operand for reading.
+	 */
+	void prepare() const
+	{
+		_operand.prepare();
+	}
+
+	/**
+	 * This method checks if the expression can be read by linear index (a transposed
+	 * expression cannot).
+	 * @return false.
+	 */
+	bool isContiguous() const
+	{
+		return false;
+	}
+
+	/**
+	 * This method computes a coordinate of the transposed expression.
+	 * @param row - the coordinate row.
+	 * @param column - the coordinate column.
+	 * @return the coordinate (row, column).
+	 */
+	T at(unsigned int row, unsigned int column) const
+	{
+		return _operand.at(column, row);
+	}
+
+	/**
+	 * This method is not used, since the expression is not contiguous.
+	 * @param index - the index.
+	 * @return the coordinate of the operand at that index.
+	 */
+	T atIndex(std::size_t index) const
+	{
+		return _operand.atIndex(index);
+	}
+
+	/**
+	 * This method evaluates the transposed expression into the storage of a matrix.
+	 * @param destination - the row-major storage of a matrix of the dimensions of the expression.
+	 */
+	void evaluateInto(T* destination) const
+	{
+		this->assignElementwise(destination);
+	}
+
+	/**
+	 * This method checks if the operand reads the storage of a matrix.
+	 * @param data - the storage of the matrix.
+	 * @return true if the expression refers to the storage, false otherwise.
+	 */
+	bool refersTo(const T* data) const
+	{
+		return _operand.refersTo(data);
+	}
+
+	/**
+	 * This method checks if the operand reads a region of the storage of a matrix.
+	 * @param region - the region.
+	 * @return true if the operand reads coordinates of the region, false otherwise.
+	 */
+	bool reads(const StorageRegion<T>& region) const
+	{
+		return _operand.reads(region);
+	}
+
+	/**
+	 * This method evaluates the operand into a buffer, and returns it transposed (with swapped
+	 * strides) as a GEMM operand.
+	 * @param buffer - the buffer which holds the operand.
+	 * @return the transposed expression as a GEMM operand.
+	 */
+	StridedOperand<T> strided(std::vector<T>& buffer) const
+	{
+		StridedOperand<T> operand = _operand.strided(buffer);
+		return {operand.data, operand.colStride, operand.rowStride};
+	}
+
+	private:
+
+	/**
+	 * The transposed expression.
+	 */
+	Operand _operand;
+
+};
+
+/**
+ * This function starts a lazy expression from a matrix.
+ * @tparam T - the generic type of a coordinate.
+ * @param m - the matrix, which should outlive the expression.
+ * @return the matrix as an expression.
+ */
+template <class T> MatrixReference<T> lazy(const Matrix<T>& m)
+{
+	return MatrixReference<T>(m);
+}
+
+/**
+ * This function adds two expressions lazily.
+ * @param left - the left expression.
+ * @param right - the right expression.
+ * @return the sum expression.
+ * @throw logic error exception if the dimensions do not suit each other.
+ */
+template <class T, class L, class R>
+ElementwiseExpression<T, L, R, AddOperation> operator+(const MatrixExpression<T, L>& left,
+													   const MatrixExpression<T, R>& right)
+{
+	return ElementwiseExpression<T, L, R, AddOperation>(left.derived(), right.derived());
+}
+
+/**
+ * This function adds an expression and a matrix lazily.
+ * @param left - the left expression.
+ * @param right - the right matrix.
+ * @return the sum expression.
+ * @throw logic error exception if the dimensions do not suit each other.
+ */
+template <class T, class L>
+ElementwiseExpression<T, L, MatrixReference<T>, AddOperation>
+operator+(const MatrixExpression<T, L>& left, const Matrix<T>& right)
+{
+	return left + lazy(right);
+}
+
+/**
+ * This function adds a matrix and an expression lazily.
+ * @param left - the left matrix.
+ * @param right - the right expression.
+ * @return the sum expression.
+ * @throw logic error exception if the dimensions do not suit each other.
+ */
+template <class T, class R>
+ElementwiseExpression<T, MatrixReference<T>, R, AddOperation>
+operator+(const Matrix<T>& left, const MatrixExpression<T, R>& right)
+{
+	return lazy(left) + right;
+}
+
+/**
+ * This function subtracts two expressions lazily.
+ * @param left - the left expression.
+ * @param right - the right expression.
+ * @return the difference expression.
+ * @throw logic error exception if the dimensions do not suit each other.
+ */
+template <class T, class L, class R>
+ElementwiseExpression<T, L, R, SubtractOperation> operator-(const MatrixExpression<T, L>& left,
+															const MatrixExpression<T, R>& right)
+{
+	return ElementwiseExpression<T, L, R, SubtractOperation>(left.derived(), right.derived());
+}
+
+/**
+ * This function subtracts a matrix from an expression lazily.
+ * @param left - the left expression.
+ * @param right - the right matrix.
+ * @return the difference expression.
+ * @throw logic error exception if the dimensions do not suit each other.
+ */
+template <class T, class L>
+ElementwiseExpression<T, L, MatrixReference<T>, SubtractOperation>
+operator-(const MatrixExpression<T, L>& left, const Matrix<T>& right)
+{
+	return left - lazy(right);
+}
+
+/**
+ * This function subtracts an expression from a matrix lazily.
+ * @param left - the left matrix.
+ * @param right - the right expression.
+ * @return the difference expression.
+ * @throw logic error exception if the dimensions do not suit each other.
+ */
+template <class T, class R>
+ElementwiseExpression<T, MatrixReference<T>, R, SubtractOperation>
+operator-(const Matrix<T>& left, const MatrixExpression<T, R>& right)
+{
+	return lazy(left) - right;
+}
+
+/**
+ * This function multiplies two expressions lazily.
+ * @param left - the left expression.
+ * @param right - the right expression.
+ * @return the product expression.
+ * @throw logic error of incompatible matrices dimensions.
+ */
+template <class T, class L, class R>
+ProductExpression<T, L, R> operator*(const MatrixExpression<T, L>& left,
+									 const MatrixExpression<T, R>& right)
+{
+	return ProductExpression<T, L, R>(left.derived(), right.derived());
+}
+
+/**
+ * This function multiplies an expression by a matrix lazily.
+ * @param left - the left expression.
+ * @param right - the right matrix.
+ * @return the product expression.
+ * @throw logic error of incompatible matrices dimensions.
+ */
+template <class T, class L>
+ProductExpression<T, L, MatrixReference<T>> operator*(const MatrixExpression<T, L>& left,
+													  const Matrix<T>& right)
+{
+	return left * lazy(right);
+}
+
+/**
+ * This function multiplies a matrix by an expression lazily.
+ * @param left - the left matrix.
+ * @param right - the right expression.
+ * @return the product expression.
+ * @throw logic error of incompatible matrices dimensions.
+ */
+template <class T, class R>
+ProductExpression<T, MatrixReference<T>, R> operator*(const Matrix<T>& left,
+													  const MatrixExpression<T, R>& right)
+{
+	return lazy(left) * right;
+}
+
+#endif
@@ -0,0 +1,717 @@
+//================================ Includes =====================================================
+#include "Complex.h"
+#include "Matrix.hpp"
+#include "MatrixView.hpp"
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define MATRIX_IO_HAS_MMAP 1
+#else
+#define MATRIX_IO_HAS_MMAP 0
+#endif
+//================================ Constants ====================================================
+#ifndef CPP3_MATRIX_IO_H
+#define CPP3_MATRIX_IO_H
+#define MATRIX_FILE_MAGIC "CPP3MTX"
+#define MATRIX_FILE_MAGIC_SIZE 8
+#define MATRIX_FILE_VERSION 1u
+#define MATRIX_FILE_BYTE_ORDER 0x01020304u
+#define MATRIX_FILE_HEADER_SIZE 64
+#define MATRIX_IO_CHUNK_BYTES (1 << 22)
+#define MATRIX_FILE_OPEN_ERROR "Cannot open the matrix file"
+#define MATRIX_FILE_READ_ERROR "Cannot read the matrix file"
+#define MATRIX_FILE_WRITE_ERROR "Cannot write the matrix file"
+#define MATRIX_FILE_FORMAT_ERROR "The file is not a matrix file of this version and byte order"
+#define MATRIX_FILE_TYPE_ERROR "The matrix file holds coordinates of another type"
+#define MATRIX_FILE_DIMENSIONS_ERROR "The dimensions of the matrix file are not valid"
+#define MATRIX_FILE_TRUNCATED_ERROR "The matrix file is shorter than its dimensions"
+#define MATRIX_FILE_OVERFLOW_ERROR "More coordinates were written than the matrix holds"
+#define MATRIX_FILE_INCOMPLETE_ERROR "The matrix file was closed before all its coordinates " \
+									 "were written"
+#define MATRIX_FILE_VIEW_ERROR "The view does not fit the lines of the matrix file"
+#define MATRIX_FILE_BLOCK_ERROR "The block does not fit in the matrix of the file"
+#define MATRIX_FILE_OVERLAP_ERROR "The block overlaps a block which was already written"
+#define MATRIX_FILE_MAP_ERROR "Cannot map the matrix file"
+//================================ Code Segment =================================================
+
+/**
+ * This file adds a binary format for matrices. A matrix file is a header of
+ * MATRIX_FILE_HEADER_SIZE bytes - the magic, the version, the byte order, the element type and
+ * size, the storage order and the dimensions - followed by the coordinates in the storage order,
+ * exactly as a Matrix<T> holds them in memory. So saving and loading are single large writes and
+ * reads, and a file can be mapped and used in place: MappedMatrix<T> maps a file read-only and
+ * views it as a ConstMatrixView<T>, without copying it, and the pages are only read from disk when
+ * the coordinates are. ChunkedMatrixWriter<T> writes a file piece by piece, so a matrix that does
+ * not fit in memory can be written as it is computed. The coordinates must be trivially copyable;
+ * files are not portable between machines of different byte orders.
+ */
+
+/**
+ * This enum represents the kind of the coordinates of a matrix file. Together with their size,
+ * it identifies the type: a FloatingPoint of 4 bytes is a float, for example.
+ */
+enum class MatrixFileElement : std :: uint32_t
+{
+	Other,
+	SignedInteger,
+	UnsignedInteger,
+	FloatingPoint,
+	Complex
+};
+
+/**
+ * This struct maps a coordinate type to its kind in a matrix file.
+ * @tparam T - the coordinate type.
+ */
+template <class T> struct MatrixFileElementOf
+{
+	static constexpr MatrixFileElement VALUE = std :: is_floating_point<T>::value ?
+		MatrixFileElement::FloatingPoint : std :: is_integral<T>::value ?
+		(std :: is_signed<T>::value ? MatrixFileElement::SignedInteger :
+		 MatrixFileElement::UnsignedInteger) : MatrixFileElement::Other;
+};
+
+template <> struct MatrixFileElementOf<Complex>
+{
+	static constexpr MatrixFileElement VALUE = MatrixFileElement::Complex;
+};
+
+/**
+ * This struct is the header of a matrix file.
+ */
+struct MatrixFileHeader
+{
+	char magic[MATRIX_FILE_MAGIC_SIZE];
+	std :: uint32_t version;
+	std :: uint32_t byteOrder;
+	std :: uint32_t element;
+	std :: uint32_t elementSize;
+	std :: uint32_t storageOrder;
+	std :: uint32_t reserved;
+	std :: uint64_t rows;
+	std :: uint64_t cols;
+	char padding[16];
+
+	/**
+	 * This method makes the header of a matrix.
+	 * @tparam T - the coordinate type.
+	 * @param rows - number of rows.
+	 * @param cols - number of columns.
+	 * @param order - the storage order.
+	 * @return the header.
+	 */
+	template <class T> static MatrixFileHeader of(unsigned int rows, unsigned int cols,
+												  StorageOrder order)
+	{
+		MatrixFileHeader header;
+		std :: memset(&header, 0, sizeof(header));
+		std :: memcpy(header.magic, MATRIX_FILE_MAGIC, MATRIX_FILE_MAGIC_SIZE);
+		header.version = MATRIX_FILE_VERSION;
+		header.byteOrder = MATRIX_FILE_BYTE_ORDER;
+		header.element = (std :: uint32_t) MatrixFileElementOf<T>::VALUE;
+		header.elementSize = sizeof(T);
+		header.storageOrder = (std :: uint32_t) order;
+		header.rows = rows;
+		header.cols = cols;
+		return header;
+	}
+
+	/**
+	 * This method checks that the header is of a valid file of coordinates of type T.
+	 * @tparam T - the coordinate type.
+	 * @throw runtime error if the file is not a matrix file of this version and byte order, or
+	 * its dimensions are not valid.
+	 * @throw invalid argument error if the coordinates are not of type T.
+	 */
+	template <class T> void check() const
+	{
+		if(std :: memcmp(magic, MATRIX_FILE_MAGIC, MATRIX_FILE_MAGIC_SIZE) != 0 ||
+		   version != MATRIX_FILE_VERSION || byteOrder != MATRIX_FILE_BYTE_ORDER ||
+		   storageOrder > (std :: uint32_t) StorageOrder::ColMajor)
+		{
+			throw std :: runtime_error(MATRIX_FILE_FORMAT_ERROR);
+		}
+		if(element != (std :: uint32_t) MatrixFileElementOf<T>::VALUE || elementSize != sizeof(T))
+		{
+			throw std :: invalid_argument(MATRIX_FILE_TYPE_ERROR);
+		}
+		if(rows == 0 || cols == 0 || rows > INT_MAX || cols > INT_MAX)
+		{
+			throw std :: runtime_error(MATRIX_FILE_DIMENSIONS_ERROR);
+		}
+	}
+
+	/**
+	 * This method returns the number of coordinates of the file.
+	 * @return rows * cols.
+	 */
+	std :: size_t size() const
+	{
+		return (std :: size_t) rows * cols;
+	}
+
+	/**
+	 * This method returns the storage order of the file.
+	 * @return the storage order.
+	 */
+	StorageOrder order() const
+	{
+		return (StorageOrder) storageOrder;
+	}
+
+};
+
+static_assert(sizeof(MatrixFileHeader) == MATRIX_FILE_HEADER_SIZE, MATRIX_FILE_FORMAT_ERROR);
+
+/**
+ * This class writes a matrix file piece by piece: the coordinates are appended in the storage
+ * order of the file, through a buffer of MATRIX_IO_CHUNK_BYTES, until all of them are written.
+ * A file can also be written block by block, each block at its place (see writeBlock).
+ * @tparam T - the coordinate type.
+ */
+template <class T> class ChunkedMatrixWriter
+{
+	static_assert(std :: is_trivially_copyable<T>::value, MATRIX_FILE_TYPE_ERROR);
+
+	public:
+
+	/**
+	 * This constructor creates a matrix file and writes its header.
+	 * @param path - the path of the file.
+	 * @param rows - number of rows of the matrix.
+	 * @param cols - number of columns of the matrix.
+	 * @param order - the storage order of the file.
+	 * @throw invalid argument error if the dimensions are not positive.
+	 * @throw runtime error if the file cannot be created.
+	 */
+	ChunkedMatrixWriter(const std :: string& path, unsigned int rows, unsigned int cols,
+						StorageOrder order = StorageOrder::RowMajor) :
+	_buffer(MATRIX_IO_CHUNK_BYTES), _header(MatrixFileHeader::of<T>(rows, cols, order)),
+	_numOfWritten(0)
+	{
+		if(!((int) rows > 0 && (int) cols > 0))
+		{
+			throw std :: invalid_argument(INVALID_ARGUMENT_ERROR);
+		}
+		_file.rdbuf()->pubsetbuf(_buffer.data(), _buffer.size());
+		_file.open(path, std :: ios::binary | std :: ios::trunc);
+		if(!_file)
+		{
+			throw std :: runtime_error(MATRIX_FILE_OPEN_ERROR);
+		}
+		writeBytes(&_header, sizeof(_header));
+	}
+
+	/**
+	 * This destructor closes the file. A file which is not complete is left as it is, and
+	 * loading it fails.
+	 */
+	~ChunkedMatrixWriter()
+	{
+		if(_file.is_open())
+		{
+			_file.close();
+		}
+	}
+
+	ChunkedMatrixWriter(const ChunkedMatrixWriter&) = delete;
+
+	ChunkedMatrixWriter& operator=(const ChunkedMatrixWriter&) = delete;
+
+	/**
+	 * This method returns the number of coordinates of the matrix.
+	 * @return rows * cols.
+	 */
+	std :: size_t size() const
+	{
+		return _header.size();
+	}
+
+	/**
+	 * This method returns the number of coordinates written so far.
+	 * @return number of coordinates written.
+	 */
+	std :: size_t written() const
+	{
+		return _numOfWritten;
+	}
+
+	/**
+	 * This method appends coordinates to the file.
+	 * @param coords - the coordinates, in the storage order of the file.
+	 * @param count - number of coordinates.
+	 * @throw out of range exception if the file would hold more coordinates than the matrix.
+	 * @throw runtime error if the file cannot be written.
+	 */
+	void write(const T* coords, std :: size_t count)
+	{
+		if(count > size() - _numOfWritten)
+		{
+			throw std :: out_of_range(MATRIX_FILE_OVERFLOW_ERROR);
+		}
+		writeBytes(coords, count * sizeof(T));
+		_numOfWritten += count;
+	}
+
+	/**
+	 * This method appends the whole major lines of a view to the file: rows of a row-major file,
+	 * columns of a column-major one.
+	 * @param view - the view, as long as a major line of the file.
+	 * @throw invalid argument error if the lines of the view are not as long.
+	 * @throw out of range exception if the file would hold more coordinates than the matrix.
+	 * @throw runtime error if the file cannot be written.
+	 */
+	void write(const ConstMatrixView<T>& view)
+	{
+		bool isRowMajor = _header.order() == StorageOrder::RowMajor;
+		unsigned int majors = isRowMajor ? view.rows() : view.cols();
+		unsigned int minors = isRowMajor ? view.cols() : view.rows();
+		std :: ptrdiff_t majorStride = isRowMajor ? view.rowStride() : view.colStride();
+		std :: ptrdiff_t minorStride = isRowMajor ? view.colStride() : view.rowStride();
+		if(minors != (isRowMajor ? _header.cols : _header.rows))
+		{
+			throw std :: invalid_argument(MATRIX_FILE_VIEW_ERROR);
+		}
+		if(minorStride == 1 && majorStride == (std :: ptrdiff_t) minors)
+		{
+			write(view.data(), (std :: size_t) majors * minors);
+			return;
+		}
+		if((std :: size_t) majors * minors > size() - _numOfWritten)
+		{
+			throw std :: out_of_range(MATRIX_FILE_OVERFLOW_ERROR);
+		}
+		std :: vector<T> line(minorStride == 1 ? 0 : minors);
+		for(unsigned int major = 0 ; major < majors ; ++major)
+		{
+			const T* first = view.data() + major * majorStride;
+			if(minorStride != 1)
+			{
+				for(unsigned int minor = 0 ; minor < minors ; ++minor)
+				{
+					line[minor] = first[minor * minorStride];
+				}
+				first = line.data();
+			}
+			write(first, minors);
+		}
+	}
+
+	/**
+	 * This method writes a block of the matrix at its place in the file, so a file can also be
+	 * written block by block, in any order (a file should be written either by write or by
+	 * writeBlock, not by both). The blocks must be disjoint: the runs of every major line
+	 * which were written are kept, so a block which overlaps them is rejected before any of it
+	 * is written, and close() accepts the file only when the blocks cover the whole matrix.
+	 * @param row - the row of the first coordinate of the block in the matrix.
+	 * @param col - the column of the first coordinate of the block in the matrix.
+	 * @param block - the view of the block.
+	 * @throw out of range exception if the block does not fit in the matrix.
+	 * @throw invalid argument error if the block overlaps a block which was already written.
+	 * @throw runtime error if the file cannot be written.
+	 */
+	void writeBlock(unsigned int row, unsigned int col, const ConstMatrixView<T>& block)
+	{
+		if((std :: size_t) row + block.rows() > _header.rows ||
+		   (std :: size_t) col + block.cols() > _header.cols)
+		{
+			throw std :: out_of_range(MATRIX_FILE_BLOCK_ERROR);
+		}
+		bool isRowMajor = _header.order() == StorageOrder::RowMajor;
+		unsigned int majors = isRowMajor ? block.rows() : block.cols();
+		unsigned int minors = isRowMajor ? block.cols() : block.rows();
+		std :: ptrdiff_t majorStride = isRowMajor ? block.rowStride() : block.colStride();
+		std :: ptrdiff_t minorStride = isRowMajor ? block.colStride() : block.rowStride();
+		std :: size_t firstMajor = isRowMajor ? row : col;
+		unsigned int firstMinor = isRowMajor ? col : row;
+		std :: size_t lineLength = isRowMajor ? _header.cols : _header.rows;
+		if(minors == 0)
+		{
+			return;
+		}
+		if(_writtenRuns.empty())
+		{
+			_writtenRuns.resize(isRowMajor ? _header.rows : _header.cols);
+		}
+		for(unsigned int major = 0 ; major < majors ; ++major)
+		{
+			if(isWritten(_writtenRuns[firstMajor + major], firstMinor, firstMinor + minors))
+			{
+				throw std :: invalid_argument(MATRIX_FILE_OVERLAP_ERROR);
+			}
+		}
+		std :: vector<T> line(minorStride == 1 ? 0 : minors);
+		for(unsigned int major = 0 ; major < majors ; ++major)
+		{
+			const T* first = block.data() + major * majorStride;
+			if(minorStride != 1)
+			{
+				for(unsigned int minor = 0 ; minor < minors ; ++minor)
+				{
+					line[minor] = first[minor * minorStride];
+				}
+				first = line.data();
+			}
+			std :: size_t offset = ((firstMajor + major) * lineLength + firstMinor) * sizeof(T);
+			if(!_file.seekp((std :: streamoff) (sizeof(_header) + offset)))
+			{
+				throw std :: runtime_error(MATRIX_FILE_WRITE_ERROR);
+			}
+			writeBytes(first, (std :: size_t) minors * sizeof(T));
+			addRun(_writtenRuns[firstMajor + major], firstMinor, firstMinor + minors);
+			_numOfWritten += minors;
+		}
+	}
+
+	/**
+	 * This method flushes and closes the file. Since the blocks of writeBlock are disjoint, all
+	 * the coordinates were written exactly when their number is the size of the matrix.
+	 * @throw runtime error if not all the coordinates were written, or the file cannot be
+	 * written.
+	 */
+	void close()
+	{
+		_file.close();
+		if(_file.fail())
+		{
+			throw std :: runtime_error(MATRIX_FILE_WRITE_ERROR);
+		}
+		if(_numOfWritten != size())
+		{
+			throw std :: runtime_error(MATRIX_FILE_INCOMPLETE_ERROR);
+		}
+	}
+
+	private:
+
+	/**
+	 * The runs of a major line which were written: the first minor index of every run, mapped
+	 * to the index after its last one. Adjacent runs are merged.
+	 */
+	typedef std :: map<unsigned int, unsigned int> Runs;
+
+	/**
+	 * This method writes bytes to the file.
+	 * @param bytes - the bytes.
+	 * @param count - number of bytes.
+	 * @throw runtime error if the file cannot be written.
+	 */
+	void writeBytes(const void* bytes, std :: size_t count)
+	{
+		if(!_file.write((const char*) bytes, count))
+		{
+			throw std :: runtime_error(MATRIX_FILE_WRITE_ERROR);
+		}
+	}
+
+	/**
+	 * This method checks if any coordinate of a run of a major line was already written.
+	 * @param runs - the written runs of the line.
+	 * @param first - the first minor index of the run.
+	 * @param end - the minor index after the last one of the run.
+	 * @return true if the run overlaps a written run.
+	 */
+	static bool isWritten(const Runs& runs, unsigned int first, unsigned int end)
+	{
+		Runs::const_iterator next = runs.lower_bound(first);
+		if(next != runs.end() && next->first < end)
+		{
+			return true;
+		}
+		return next != runs.begin() && std :: prev(next)->second > first;
+	}
+
+	/**
+	 * This method adds a run, which was not written before, to the written runs of a major line.
+	 * @param runs - the written runs of the line.
+	 * @param first - the first minor index of the run.
+	 * @param end - the minor index after the last one of the run.
+	 */
+	static void addRun(Runs& runs, unsigned int first, unsigned int end)
+	{
+		Runs::iterator next = runs.lower_bound(first);
+		if(next != runs.end() && next->first == end)
+		{
+			end = next->second;
+			next = runs.erase(next);
+		}
+		if(next != runs.begin() && std :: prev(next)->second == first)
+		{
+			std :: prev(next)->second = end;
+			return;
+		}
+		runs.emplace_hint(next, first, end);
+	}
+
+	/**
+	 * The buffer of the file.
+	 */
+	std :: vector<char> _buffer;
+
+	/**
+	 * The file.
+	 */
+	std :: ofstream _file;
+
+	/**
+	 * The header of the file.
+	 */
+	MatrixFileHeader _header;
+
+	/**
+	 * Number of coordinates written so far.
+	 */
+	std :: size_t _numOfWritten;
+
+	/**
+	 * The written runs of every major line, allocated by the first writeBlock.
+	 */
+	std :: vector<Runs> _writtenRuns;
+
+};
+
+/**
+ * This method saves a matrix to a matrix file, in its storage order.
+ * @tparam T - the coordinate type.
+ * @tparam Allocator - the allocator of the matrix.
+ * @tparam Order - the storage order of the matrix.
+ * @param m - the matrix.
+ * @param path - the path of the file.
+ * @throw runtime error if the file cannot be written.
+ */
+template <class T, class Allocator, StorageOrder Order>
+void save(const Matrix<T, Allocator, Order>& m, const std :: string& path)
+{
+	ChunkedMatrixWriter<T> writer(path, m.rows(), m.cols(), Order);
+	writer.write(m.data(), (std :: size_t) m.rows() * m.cols());
+	writer.close();
+}
+
+/**
+ * This method loads a matrix from a matrix file. A file of the other storage order is
+ * transposed into the requested one.
+ * @tparam T - the coordinate type.
+ * @tparam Order - the storage order of the matrix.
+ * @tparam Allocator - the allocator of the matrix.
+ * @param path - the path of the file.
+ * @return the matrix.
+ * @throw runtime error if the file cannot be read or is not a valid matrix file.
+ * @throw invalid argument error if the coordinates of the file are not of type T.
+ */
+template <class T, StorageOrder Order = StorageOrder::RowMajor,
+		  class Allocator = PooledAllocator<T>>
+Matrix<T, Allocator, Order> load(const std :: string& path)
+{
+	static_assert(std :: is_trivially_copyable<T>::value, MATRIX_FILE_TYPE_ERROR);
+	std :: ifstream file(path, std :: ios::binary);
+	if(!file)
+	{
+		throw std :: runtime_error(MATRIX_FILE_OPEN_ERROR);
+	}
+	MatrixFileHeader header;
+	if(!file.read((char*) &header, sizeof(header)))
+	{
+		throw std :: runtime_error(MATRIX_FILE_READ_ERROR);
+	}
+	header.check<T>();
+	auto read = [&file](T* coords, std :: size_t count)
+	{
+		if(!file.read((char*) coords, count * sizeof(T)))
+		{
+			throw std :: runtime_error(MATRIX_FILE_TRUNCATED_ERROR);
+		}
+	};
+	constexpr StorageOrder OTHER_ORDER = Order == StorageOrder::RowMajor ?
+										 StorageOrder::ColMajor : StorageOrder::RowMajor;
+	if(header.order() == OTHER_ORDER)
+	{
+		Matrix<T, Allocator, OTHER_ORDER> m((unsigned int) header.rows, (unsigned int) header.cols);
+		read(m.data(), header.size());
+		return Matrix<T, Allocator, Order>(m);
+	}
+	Matrix<T, Allocator, Order> m((unsigned int) header.rows, (unsigned int) header.cols);
+	read(m.data(), header.size());
+	return m;
+}
+
+/**
+ * This class maps a matrix file read-only into memory, and views it without copying it. The
+ * operating system reads the pages when they are accessed and may drop them under memory
+ * pressure, so a file larger than the memory can be viewed. The view (and blocks of it) mix
+ * with matrices in expressions like any ConstMatrixView; Matrix<T>(mapped.view()) copies it.
+ * @tparam T - the coordinate type.
+ */
+template <class T> class MappedMatrix
+{
+	static_assert(std :: is_trivially_copyable<T>::value, MATRIX_FILE_TYPE_ERROR);
+
+	public:
+
+	/**
+	 * This constructor maps a matrix file.
+	 * @param path - the path of the file.
+	 * @throw runtime error if the file cannot be mapped or is not a valid matrix file.
+	 * @throw invalid argument error if the coordinates of the file are not of type T.
+	 */
+	explicit MappedMatrix(const std :: string& path) : _mapping(nullptr), _mappingSize(0)
+	{
+#if MATRIX_IO_HAS_MMAP
+		int descriptor = open(path.c_str(), O_RDONLY);
+		if(descriptor < 0)
+		{
+			throw std :: runtime_error(MATRIX_FILE_OPEN_ERROR);
+		}
+		struct stat status;
+		if(fstat(descriptor, &status) != 0 || status.st_size < MATRIX_FILE_HEADER_SIZE)
+		{
+			::close(descriptor);
+			throw std :: runtime_error(MATRIX_FILE_FORMAT_ERROR);
+		}
+		_mappingSize = (std :: size_t) status.st_size;
+		void* mapping = mmap(nullptr, _mappingSize, PROT_READ, MAP_SHARED, descriptor, 0);
+		::close(descriptor);
+		if(mapping == MAP_FAILED)
+		{
+			throw std :: runtime_error(MATRIX_FILE_MAP_ERROR);
+		}
+		_mapping = mapping;
+		try
+		{
+			std :: memcpy(&_header, _mapping, sizeof(_header));
+			_header.check<T>();
+			if((_mappingSize - MATRIX_FILE_HEADER_SIZE) / sizeof(T) < _header.size())
+			{
+				throw std :: runtime_error(MATRIX_FILE_TRUNCATED_ERROR);
+			}
+		}
+		catch(...)
+		{
+			munmap(_mapping, _mappingSize);
+			throw;
+		}
+#else
+		(void) path;
+		throw std :: runtime_error(MATRIX_FILE_MAP_ERROR);
+#endif
+	}
+
+	/**
+	 * This constructor is a move constructor. m is left without a mapping.
+	 * @param m - the mapped matrix that we move from.
+	 */
+	MappedMatrix(MappedMatrix&& m) noexcept : _mapping(m._mapping), _mappingSize(m._mappingSize),
+	_header(m._header)
+	{
+		m._mapping = nullptr;
+		m._mappingSize = 0;
+	}
+
+	/**
+	 * This destructor unmaps the file. Views of it are invalidated.
+	 */
+	~MappedMatrix()
+	{
+#if MATRIX_IO_HAS_MMAP
+		if(_mapping != nullptr)
+		{
+			munmap(_mapping, _mappingSize);
+		}
+#endif
+	}
+
+	MappedMatrix(const MappedMatrix&) = delete;
+
+	MappedMatrix& operator=(const MappedMatrix&) = delete;
+
+	/**
+	 * This method returns number of rows of the matrix.
+	 * @return number of rows of the matrix.
+	 */
+	unsigned int rows() const
+	{
+		return (unsigned int) _header.rows;
+	}
+
+	/**
+	 * This method returns number of columns of the matrix.
+	 * @return number of columns of the matrix.
+	 */
+	unsigned int cols() const
+	{
+		return (unsigned int) _header.cols;
+	}
+
+	/**
+	 * This method returns the storage order of the file.
+	 * @return the storage order.
+	 */
+	StorageOrder order() const
+	{
+		return _header.order();
+	}
+
+	/**
+	 * This method returns the mapped coordinates, in the storage order of the file. They are
+	 * aligned to MATRIX_FILE_HEADER_SIZE bytes, like the storage of a Matrix<T>.
+	 * @return the coordinates.
+	 */
+	const T* data() const
+	{
+		return (const T*) ((const char*) _mapping + MATRIX_FILE_HEADER_SIZE);
+	}
+
+	/**
+	 * This method returns a view of the whole matrix.
+	 * @return the view.
+	 */
+	ConstMatrixView<T> view() const
+	{
+		bool isColMajor = order() == StorageOrder::ColMajor;
+		return ConstMatrixView<T>(data(), data(), isColMajor ? rows() : cols(), rows(), cols(),
+								  isColMajor);
+	}
+
+	/**
+	 * This method tells the operating system that the matrix will be read sequentially, so it
+	 * reads ahead more aggressively.
+	 */
+	void adviseSequential() const
+	{
+#if MATRIX_IO_HAS_MMAP
+		madvise(_mapping, _mappingSize, MADV_SEQUENTIAL);
+#endif
+	}
+
+	private:
+
+	/**
+	 * The mapping of the file.
+	 */
+	void* _mapping;
+
+	/**
+	 * The size of the mapping in bytes.
+	 */
+	std :: size_t _mappingSize;
+
+	/**
+	 * The header of the file.
+	 */
+	MatrixFileHeader _header;
+
+};
+
+#endif
@@ -0,0 +1,1059 @@
+//================================ Includes =====================================================
+#include "Complex.h"
+#include "ElementwiseKernels.hpp"
+#include "ThreadPool.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+//================================ Constants ====================================================
+#ifndef CPP3_MATRIX_KERNELS_H
+#define CPP3_MATRIX_KERNELS_H
+#if defined(__AVX512F__)
+#define GEMM_VECTOR_BYTES 64
+#elif defined(__AVX__)
+#define GEMM_VECTOR_BYTES 32
+#else
+#define GEMM_VECTOR_BYTES 16
+#endif
+#if ELEMENTWISE_RUNTIME_DISPATCH && GEMM_VECTOR_BYTES < AVX512_VECTOR_BYTES
+#define GEMM_WIDEST_VECTOR_BYTES AVX512_VECTOR_BYTES
+#else
+#define GEMM_WIDEST_VECTOR_BYTES GEMM_VECTOR_BYTES
+#endif
+#define GEMM_MICRO_TILE_ROWS 6
+#define GEMM_VECTORS_PER_TILE_ROW 2
+#define GEMM_DEPTH_BLOCK 256
+#define GEMM_ROWS_BLOCK 144
+#define GEMM_COLS_BLOCK 2048
+#define GEMM_PARALLEL_THRESHOLD (1 << 18)
+#if defined(__AVX__)
+#define TRANSPOSE_WIDE_VECTOR_BYTES 32
+#else
+#define TRANSPOSE_WIDE_VECTOR_BYTES 16
+#endif
+#define TRANSPOSE_NARROW_VECTOR_BYTES 16
+#if defined(__GNUC__) && !defined(__clang__)
+#define TRANSPOSE_IN_REGISTERS 1
+#else
+#define TRANSPOSE_IN_REGISTERS 0
+#endif
+#define TRANSPOSE_BLOCK 64u
+#define TRANSPOSE_PARALLEL_THRESHOLD (1 << 18)
+//================================ Code Segment =================================================
+
+/**
+ * This struct is the coordinate operation of a plain transpose: it returns the coordinate as is.
+ */
+struct IdentityCoordinate
+{
+	template <class T> const T& operator()(const T& coord) const
+	{
+		return coord;
+	}
+};
+
+/**
+ * This struct is the accumulator policy of products: the type in which the products of
+ * coordinates of type T are summed by Matrix<T>::widenedProduct, so narrow coordinates save
+ * memory bandwidth without overflowing or losing precision in long sums. 8 and 16 bit integers
+ * are summed in 32 bits (like the VNNI dot products), 32 bit integers in 64 bits, and float in
+ * double; other types in themselves. It can be specialized for other types.
+ * @tparam T - the coordinate type.
+ */
+template <class T> struct AccumulatorOf
+{
+	typedef typename std::conditional<std::is_same<T, float>::value, double,
+			typename std::conditional<std::is_integral<T>::value && !std::is_same<T, bool>::value &&
+									  sizeof(T) < 4, std::int32_t,
+			typename std::conditional<std::is_integral<T>::value && !std::is_same<T, bool>::value &&
+									  sizeof(T) == 4, std::int64_t, T>::type>::type>::type type;
+};
+
+/**
+ * This class holds the computational kernels behind the Matrix operators. The kernels work on
+ * raw strided storage: element (row, col) of an operand is at data[row * rowStride +
+ * col * colStride], so the same kernel serves row-major storage, transposed operands and
+ * sub-blocks without copying them. The products also take operands of a narrower type Source,
+ * which is converted to T as the operands are packed, so T is the accumulator (see
+ * AccumulatorOf) and the micro-kernel is the same. The micro-kernel is compiled with the
+ * vectors of the build (GEMM_VECTOR_BYTES) and, on x86, also with AVX2 and AVX-512 vectors,
+ * and the widest one the running CPU supports is chosen at run time (see detectSimdLevel).
+ * @tparam T - the generic type of a coordinate in the generic matrix.
+ */
+template <class T> class MatrixKernels
+{
+	public:
+
+	/**
+	 * True if T goes through the packed kernel: arithmetic types that fit in a SIMD lane.
+	 */
+	static constexpr bool IS_BLOCKED = std::is_arithmetic<T>::value &&
+									   !std::is_same<T, bool>::value && sizeof(T) <= 8;
+
+	/**
+	 * True if T is Complex, whose products go through the packed kernel of double.
+	 */
+	static constexpr bool IS_COMPLEX = std::is_same<T, Complex>::value;
+
+	/**
+	 * The number of T in the widest SIMD register which the micro-kernel may use.
+	 */
+	static constexpr unsigned LANES = IS_BLOCKED ? GEMM_WIDEST_VECTOR_BYTES / sizeof(T) : 1;
+
+	/**
+	 * The number of rows of the register tile that the micro-kernel keeps in registers.
+	 */
+	static constexpr unsigned MICRO_ROWS = GEMM_MICRO_TILE_ROWS;
+
+	/**
+	 * The number of columns of the widest register tile: a few SIMD registers per tile row.
+	 * The tiles of narrower registers divide it.
+	 */
+	static constexpr unsigned MICRO_COLS = GEMM_VECTORS_PER_TILE_ROW * LANES;
+
+	/**
+	 * The depth (shared dimension) of a packed block, chosen so a packed sliver of B stays in L1.
+	 */
+	static constexpr unsigned DEPTH_BLOCK = GEMM_DEPTH_BLOCK;
+
+	/**
+	 * The number of rows of a packed block of A, chosen so the whole block stays in L2.
+	 */
+	static constexpr unsigned ROWS_BLOCK = GEMM_ROWS_BLOCK / MICRO_ROWS * MICRO_ROWS;
+
+	/**
+	 * The number of columns of a packed panel of B, chosen so the panel stays in L3.
+	 */
+	static constexpr unsigned COLS_BLOCK = GEMM_COLS_BLOCK / MICRO_COLS * MICRO_COLS;
+
+	/**
+	 * This method multiplies two strided matrices: C = A * B, or C += A * B if accumulate.
+	 * Arithmetic types go through the packed, cache-blocked kernel, Complex through the same
+	 * kernel of double (see gemmComplex), and other types through the generic kernel.
+	 * @tparam Source - the coordinate type of A and B, converted to T. By default, T.
+	 * @param rows - number of rows of A and C.
+	 * @param cols - number of columns of B and C.
+	 * @param depth - number of columns of A and rows of B.
+	 * @param a - the storage of A.
+	 * @param aRowStride - the distance between two rows of A.
+	 * @param aColStride - the distance between two columns of A.
+	 * @param b - the storage of B.
+	 * @param bRowStride - the distance between two rows of B.
+	 * @param bColStride - the distance between two columns of B.
+	 * @param c - the storage of C.
+	 * @param cRowStride - the distance between two rows of C.
+	 * @param cColStride - the distance between two columns of C.
+	 * @param accumulate - true to add the product to C, false to overwrite C with it.
+	 */
+	template <class Source = T>
+	static void gemm(unsigned rows, unsigned cols, unsigned depth,
+					 const Source* a, std::ptrdiff_t aRowStride, std::ptrdiff_t aColStride,
+					 const Source* b, std::ptrdiff_t bRowStride, std::ptrdiff_t bColStride,
+					 T* c, std::ptrdiff_t cRowStride, std::ptrdiff_t cColStride, bool accumulate)
+	{
+		if constexpr (IS_BLOCKED && std::is_arithmetic<Source>::value)
+		{
+			gemmBlocked(rows, cols, depth, a, aRowStride, aColStride, b, bRowStride, bColStride,
+						c, cRowStride, cColStride, accumulate);
+		}
+		else if constexpr (IS_COMPLEX && std::is_same<Source, T>::value)
+		{
+			gemmComplex(rows, cols, depth, a, aRowStride, aColStride, b, bRowStride, bColStride,
+						c, cRowStride, cColStride, accumulate);
+		}
+		else
+		{
+			gemmGeneric(rows, cols, depth, a, aRowStride, aColStride, b, bRowStride, bColStride,
+						c, cRowStride, cColStride, accumulate);
+		}
+	}
+
+	/**
+	 * This method multiplies two strided matrices on the threads of the global thread pool: C is
+	 * split into tiles, and every task runs gemm on one tile. Products with fewer than
+	 * GEMM_PARALLEL_THRESHOLD multiply-adds run serially. A column-major C is computed as the
+	 * row-major C^T = B^T * A^T (the same storage), so the kernels always write C along its
+	 * rows, whatever the storage orders of A, B and C. The parameters are the same as in gemm.
+	 */
+	template <class Source = T>
+	static void parallelGemm(unsigned rows, unsigned cols, unsigned depth,
+							 const Source* a, std::ptrdiff_t aRowStride,
+							 std::ptrdiff_t aColStride, const Source* b,
+							 std::ptrdiff_t bRowStride, std::ptrdiff_t bColStride,
+							 T* c, std::ptrdiff_t cRowStride, std::ptrdiff_t cColStride,
+							 bool accumulate)
+	{
+		if(cRowStride == 1 && cColStride != 1)
+		{
+			parallelGemm(cols, rows, depth, b, bColStride, bRowStride, a, aColStride, aRowStride,
+						 c, cColStride, cRowStride, accumulate);
+			return;
+		}
+		ThreadPool& pool = ThreadPool::instance();
+		unsigned numOfThreads = pool.numOfThreads();
+		if(numOfThreads == 1 || (double) rows * cols * depth < GEMM_PARALLEL_THRESHOLD)
+		{
+			gemm(rows, cols, depth, a, aRowStride, aColStride, b, bRowStride, bColStride,
+				 c, cRowStride, cColStride, accumulate);
+			return;
+		}
+		// the tiles are as wide as a packed panel of B, and become shorter than a packed block
+		// of A only if there are not enough of them for all the threads
+		unsigned tileCols = COLS_BLOCK;
+		unsigned numOfColTiles = (cols + tileCols - 1) / tileCols;
+		unsigned neededRowTiles = (numOfThreads + numOfColTiles - 1) / numOfColTiles;
+		unsigned tileRows = (rows + neededRowTiles - 1) / neededRowTiles;
+		tileRows = std::min(ROWS_BLOCK, (tileRows + MICRO_ROWS - 1) / MICRO_ROWS * MICRO_ROWS);
+		unsigned numOfRowTiles = (rows + tileRows - 1) / tileRows;
+		pool.parallelFor((std::size_t) numOfRowTiles * numOfColTiles, [&](std::size_t tile)
+		{
+			unsigned row = (unsigned) (tile / numOfColTiles) * tileRows;
+			unsigned col = (unsigned) (tile % numOfColTiles) * tileCols;
+			gemm(std::min(tileRows, rows - row), std::min(tileCols, cols - col), depth,
+				 a + row * aRowStride, aRowStride, aColStride,
+				 b + col * bColStride, bRowStride, bColStride,
+				 c + row * cRowStride + col * cColStride, cRowStride, cColStride, accumulate);
+		});
+	}
+
+	/**
+	 * This method multiplies two strided matrices with the textbook algorithm, in row, depth,
+	 * column order so the innermost loop walks along rows of B and C. It only needs T(0),
+	 * += and * from T, and sums every coordinate in the same order as the naive algorithm.
+	 * The parameters are the same as in gemm.
+	 */
+	template <class Source>
+	static void gemmGeneric(unsigned rows, unsigned cols, unsigned depth,
+							const Source* a, std::ptrdiff_t aRowStride, std::ptrdiff_t aColStride,
+							const Source* b, std::ptrdiff_t bRowStride, std::ptrdiff_t bColStride,
+							T* c, std::ptrdiff_t cRowStride, std::ptrdiff_t cColStride,
+							bool accumulate)
+	{
+		for(unsigned row = 0 ; row < rows ; ++row)
+		{
+			T* cRow = c + row * cRowStride;
+			if(!accumulate)
+			{
+				for(unsigned col = 0 ; col < cols ; ++col)
+				{
+					cRow[col * cColStride] = T(0);
+				}
+			}
+			for(unsigned i = 0 ; i < depth ; ++i)
+			{
+				const T& aCoord = widen(a[row * aRowStride + i * aColStride]);
+				const Source* bRow = b + i * bRowStride;
+				for(unsigned col = 0 ; col < cols ; ++col)
+				{
+					cRow[col * cColStride] += aCoord * widen(bRow[col * bColStride]);
+				}
+			}
+		}
+	}
+
+	/**
+	 * This method multiplies two strided matrices with the packed, cache-blocked algorithm:
+	 * B is packed panel by panel into slivers of MICRO_COLS columns, A block by block into
+	 * slivers of MICRO_ROWS rows, and the micro-kernel multiplies a sliver of A by a sliver of B
+	 * into a register tile of C. The parameters are the same as in gemm.
+	 */
+	template <class Source>
+	static void gemmBlocked(unsigned rows, unsigned cols, unsigned depth,
+							const Source* a, std::ptrdiff_t aRowStride, std::ptrdiff_t aColStride,
+							const Source* b, std::ptrdiff_t bRowStride, std::ptrdiff_t bColStride,
+							T* c, std::ptrdiff_t cRowStride, std::ptrdiff_t cColStride,
+							bool accumulate)
+	{
+		switch(gemmSimdLevel())
+		{
+			case SimdLevel::Avx512:
+				gemmBlockedLanes<std::max(GEMM_VECTOR_BYTES, AVX512_VECTOR_BYTES)>(
+						rows, cols, depth, a, aRowStride, aColStride, b, bRowStride, bColStride,
+						c, cRowStride, cColStride, accumulate);
+				break;
+			case SimdLevel::Avx2:
+				gemmBlockedLanes<std::max(GEMM_VECTOR_BYTES, AVX2_VECTOR_BYTES)>(
+						rows, cols, depth, a, aRowStride, aColStride, b, bRowStride, bColStride,
+						c, cRowStride, cColStride, accumulate);
+				break;
+			default:
+				gemmBlockedLanes<GEMM_VECTOR_BYTES>(
+						rows, cols, depth, a, aRowStride, aColStride, b, bRowStride, bColStride,
+						c, cRowStride, cColStride, accumulate);
+				break;
+		}
+	}
+
+	/**
+	 * This method is gemmBlocked with registers of BYTES bytes. The parameters are the same as
+	 * in gemm.
+	 * @tparam BYTES - the size of a SIMD register.
+	 */
+	template <unsigned BYTES, class Source>
+	static void gemmBlockedLanes(unsigned rows, unsigned cols, unsigned depth, const Source* a,
+								 std::ptrdiff_t aRowStride, std::ptrdiff_t aColStride,
+								 const Source* b, std::ptrdiff_t bRowStride,
+								 std::ptrdiff_t bColStride, T* c, std::ptrdiff_t cRowStride,
+								 std::ptrdiff_t cColStride, bool accumulate)
+	{
+		if(depth == 0)
+		{
+			if(!accumulate)
+			{
+				fill(rows, cols, c, cRowStride, cColStride, T(0));
+			}
+			return;
+		}
+		std::vector<T>& packedA = packingBuffer(0);
+		std::vector<T>& packedB = packingBuffer(1);
+		packedA.resize((std::size_t) ROWS_BLOCK * DEPTH_BLOCK);
+		packedB.resize((std::size_t) COLS_BLOCK * DEPTH_BLOCK);
+		for(unsigned colBlock = 0 ; colBlock < cols ; colBlock += COLS_BLOCK)
+		{
+			unsigned blockCols = std::min(COLS_BLOCK, cols - colBlock);
+			for(unsigned depthBlock = 0 ; depthBlock < depth ; depthBlock += DEPTH_BLOCK)
+			{
+				unsigned blockDepth = std::min(DEPTH_BLOCK, depth - depthBlock);
+				// only the first depth block may overwrite C, the next ones add to it
+				bool accumulateBlock = accumulate || depthBlock > 0;
+				packB(blockDepth, blockCols, b + depthBlock * bRowStride + colBlock * bColStride,
+					  bRowStride, bColStride, microCols<BYTES>(), packedB.data());
+				for(unsigned rowBlock = 0 ; rowBlock < rows ; rowBlock += ROWS_BLOCK)
+				{
+					unsigned blockRows = std::min(ROWS_BLOCK, rows - rowBlock);
+					packA(blockRows, blockDepth,
+						  a + rowBlock * aRowStride + depthBlock * aColStride,
+						  aRowStride, aColStride, packedA.data());
+					multiplyPackedBlocks<BYTES>(blockRows, blockCols, blockDepth,
+												packedA.data(), packedB.data(),
+												c + rowBlock * cRowStride + colBlock * cColStride,
+												cRowStride, cColStride, accumulateBlock);
+				}
+			}
+		}
+	}
+
+	/**
+	 * This method multiplies two strided complex matrices with the real packed kernel (the 4M
+	 * method, with its four real products fused into one). An interleaved complex matrix A is a
+	 * real matrix with twice the columns, (re, im) per coordinate, and
+	 * [re(a) im(a)] * [re(b) im(b); -im(b) re(b)] = [re(ab) im(ab)], so C = A * B is the real
+	 * product of A and of B expanded to 2 x 2 real blocks, written straight into C. B is expanded
+	 * one block at a time, of the size the real kernel packs, and A is used in place when its
+	 * columns are contiguous (it is copied otherwise). A C whose columns are not contiguous goes
+	 * through the generic kernel. The parameters are the same as in gemm.
+	 */
+	static void gemmComplex(unsigned rows, unsigned cols, unsigned depth,
+							const T* a, std::ptrdiff_t aRowStride, std::ptrdiff_t aColStride,
+							const T* b, std::ptrdiff_t bRowStride, std::ptrdiff_t bColStride,
+							T* c, std::ptrdiff_t cRowStride, std::ptrdiff_t cColStride,
+							bool accumulate)
+	{
+		if(cColStride != 1)
+		{
+			gemmGeneric(rows, cols, depth, a, aRowStride, aColStride, b, bRowStride, bColStride,
+						c, cRowStride, cColStride, accumulate);
+			return;
+		}
+		if(depth == 0)
+		{
+			if(!accumulate)
+			{
+				fill(rows, cols, c, cRowStride, cColStride, T(0));
+			}
+			return;
+		}
+		if(aColStride != 1)
+		{
+			std::vector<T>& copyOfA = packingBuffer(0);
+			copyOfA.resize((std::size_t) rows * depth);
+			for(unsigned row = 0 ; row < rows ; ++row)
+			{
+				for(unsigned i = 0 ; i < depth ; ++i)
+				{
+					copyOfA[(std::size_t) row * depth + i] = a[row * aRowStride + i * aColStride];
+				}
+			}
+			a = copyOfA.data();
+			aRowStride = depth;
+		}
+		typedef MatrixKernels<double> RealKernels;
+		const unsigned depthBlock = RealKernels::DEPTH_BLOCK / 2;
+		const unsigned colsBlock = RealKernels::COLS_BLOCK / 2;
+		const double* realA = reinterpret_cast<const double*>(a);
+		double* realC = reinterpret_cast<double*>(c);
+		std::vector<double>& expandedB = RealKernels::packingBuffer(2);
+		expandedB.resize((std::size_t) 4 * depthBlock * colsBlock);
+		for(unsigned col = 0 ; col < cols ; col += colsBlock)
+		{
+			unsigned blockCols = std::min(colsBlock, cols - col);
+			for(unsigned i = 0 ; i < depth ; i += depthBlock)
+			{
+				unsigned blockDepth = std::min(depthBlock, depth - i);
+				double* expanded = expandedB.data();
+				for(unsigned row = 0 ; row < blockDepth ; ++row)
+				{
+					const T* bRow = b + (i + row) * bRowStride + col * bColStride;
+					double* upper = expanded + (std::size_t) 4 * row * blockCols;
+					double* lower = upper + 2 * blockCols;
+					for(unsigned index = 0 ; index < blockCols ; ++index)
+					{
+						const T& coord = bRow[index * bColStride];
+						upper[2 * index] = coord.real();
+						upper[2 * index + 1] = coord.imag();
+						lower[2 * index] = -coord.imag();
+						lower[2 * index + 1] = coord.real();
+					}
+				}
+				RealKernels::gemm(rows, 2 * blockCols, 2 * blockDepth, realA + 2 * i,
+								  2 * aRowStride, 1, expanded, 2 * blockCols, 1, realC + 2 * col,
+								  2 * cRowStride, 1, accumulate || i > 0);
+			}
+		}
+	}
+
+	/**
+	 * This method sets all the coordinates of a strided matrix to a value.
+	 * @param rows - number of rows.
+	 * @param cols - number of columns.
+	 * @param c - the storage of the matrix.
+	 * @param rowStride - the distance between two rows.
+	 * @param colStride - the distance between two columns.
+	 * @param value - the value.
+	 */
+	static void fill(unsigned rows, unsigned cols, T* c, std::ptrdiff_t rowStride,
+					 std::ptrdiff_t colStride, const T& value)
+	{
+		for(unsigned row = 0 ; row < rows ; ++row)
+		{
+			for(unsigned col = 0 ; col < cols ; ++col)
+			{
+				c[row * rowStride + col * colStride] = value;
+			}
+		}
+	}
+
+	/**
+	 * True if T is transposed in SIMD registers: arithmetic types of 4 or 8 bytes.
+	 */
+	static constexpr bool IS_TRANSPOSED_IN_REGISTERS = TRANSPOSE_IN_REGISTERS && IS_BLOCKED &&
+													   (sizeof(T) == 4 || sizeof(T) == 8);
+
+	/**
+	 * This method transposes a strided matrix into another one: dst = operation(src)^T. It works
+	 * block by block, so both matrices are walked within cache-sized blocks; inside a block,
+	 * arithmetic types are transposed in square tiles of SIMD registers. The tiles are as wide
+	 * as the widest vector when the rows of dst are aligned to it, and 16 bytes wide otherwise
+	 * (a store which splits a cache line costs more than the narrower tile). Large matrices are
+	 * split into bands of blocks which run on the threads of the global thread pool.
+	 * @tparam Operation - the type of the coordinate operation.
+	 * @param rows - number of rows of src (and columns of dst).
+	 * @param cols - number of columns of src (and rows of dst).
+	 * @param src - the storage of src.
+	 * @param srcRowStride - the distance between two rows of src.
+	 * @param dst - the storage of dst, which should not overlap src.
+	 * @param dstRowStride - the distance between two rows of dst.
+	 * @param operation - applied to every coordinate (such as the conjugate of a complex number).
+	 */
+	template <class Operation = IdentityCoordinate>
+	static void transpose(unsigned rows, unsigned cols, const T* src, std::ptrdiff_t srcRowStride,
+						  T* dst, std::ptrdiff_t dstRowStride, Operation operation = Operation())
+	{
+		bool isWide = isAlignedTo(dst, dstRowStride, TRANSPOSE_WIDE_VECTOR_BYTES);
+		unsigned numOfBands = (rows + TRANSPOSE_BLOCK - 1) / TRANSPOSE_BLOCK;
+		std::size_t minimalBands = (double) rows * cols < TRANSPOSE_PARALLEL_THRESHOLD ?
+								   numOfBands : 1;
+		ThreadPool::instance().parallelRanges(numOfBands, minimalBands,
+											  [&](std::size_t beginBand, std::size_t endBand)
+		{
+			for(unsigned row = beginBand * TRANSPOSE_BLOCK ;
+				row < std::min<std::size_t>(rows, endBand * TRANSPOSE_BLOCK) ;
+				row += TRANSPOSE_BLOCK)
+			{
+				for(unsigned col = 0 ; col < cols ; col += TRANSPOSE_BLOCK)
+				{
+					unsigned blockRows = std::min(TRANSPOSE_BLOCK, rows - row);
+					unsigned blockCols = std::min(TRANSPOSE_BLOCK, cols - col);
+					const T* srcBlock = src + row * srcRowStride + col;
+					T* dstBlock = dst + col * dstRowStride + row;
+					if(isWide)
+					{
+						transposeBlock<TRANSPOSE_WIDE_VECTOR_BYTES>(blockRows, blockCols,
+								srcBlock, srcRowStride, dstBlock, dstRowStride, operation);
+					}
+					else
+					{
+						transposeBlock<TRANSPOSE_NARROW_VECTOR_BYTES>(blockRows, blockCols,
+								srcBlock, srcRowStride, dstBlock, dstRowStride, operation);
+					}
+				}
+			}
+		});
+	}
+
+	/**
+	 * This method transposes a square strided matrix in place: m = operation(m)^T, without a
+	 * second matrix. Every pair of blocks which are mirrored by the diagonal is swapped and
+	 * transposed together, with the same SIMD tiles as transpose. The band of blocks of a row
+	 * is a task of the global thread pool: the bands get shorter down the diagonal, so they are
+	 * handed out one by one rather than in equal ranges.
+	 * @tparam Operation - the type of the coordinate operation.
+	 * @param size - number of rows and columns of the matrix.
+	 * @param data - the storage of the matrix.
+	 * @param rowStride - the distance between two rows.
+	 * @param operation - applied to every coordinate (such as the conjugate of a complex number).
+	 */
+	template <class Operation = IdentityCoordinate>
+	static void transposeInPlace(unsigned size, T* data, std::ptrdiff_t rowStride,
+								 Operation operation = Operation())
+	{
+		bool isWide = isAlignedTo(data, rowStride, TRANSPOSE_WIDE_VECTOR_BYTES);
+		unsigned numOfBands = (size + TRANSPOSE_BLOCK - 1) / TRANSPOSE_BLOCK;
+		auto transposeBand = [&](std::size_t band)
+		{
+			unsigned row = band * TRANSPOSE_BLOCK;
+			unsigned blockRows = std::min(TRANSPOSE_BLOCK, size - row);
+			for(unsigned col = row ; col < size ; col += TRANSPOSE_BLOCK)
+			{
+				unsigned blockCols = std::min(TRANSPOSE_BLOCK, size - col);
+				T* a = data + row * rowStride + col;
+				T* b = data + col * rowStride + row;
+				if(isWide)
+				{
+					swapTransposedBlocks<TRANSPOSE_WIDE_VECTOR_BYTES>(blockRows, blockCols, a, b,
+																	  rowStride, operation);
+				}
+				else
+				{
+					swapTransposedBlocks<TRANSPOSE_NARROW_VECTOR_BYTES>(blockRows, blockCols, a,
+																		b, rowStride, operation);
+				}
+			}
+		};
+		if((double) size * size < TRANSPOSE_PARALLEL_THRESHOLD)
+		{
+			for(unsigned band = 0 ; band < numOfBands ; ++band)
+			{
+				transposeBand(band);
+			}
+			return;
+		}
+		ThreadPool::instance().parallelFor(numOfBands, transposeBand);
+	}
+
+	private:
+
+	/**
+	 * The complex kernel runs on the packing buffers of the real one.
+	 */
+	template <class Other> friend class MatrixKernels;
+
+	/**
+	 * This type represents a lane of a SIMD register of T (a GCC / Clang vector extension).
+	 * Types that do not go through the packed kernel never use it, so they get a placeholder.
+	 */
+	typedef typename std::conditional<IS_BLOCKED, T, float>::type VectorLane;
+
+	/**
+	 * This type represents a lane of a SIMD register of T for the transpose, and a lane of the
+	 * mask which shuffles it (a signed integer of the same size as T).
+	 */
+	typedef typename std::conditional<IS_TRANSPOSED_IN_REGISTERS, T, float>::type TransposeLane;
+	typedef typename std::conditional<sizeof(TransposeLane) == 8, long long, int>::type MaskLane;
+
+	/**
+	 * This method checks if all the rows of a strided matrix start at a multiple of a vector.
+	 * @param data - the storage of the matrix.
+	 * @param rowStride - the distance between two rows.
+	 * @param vectorBytes - the size of the vector.
+	 * @return true if the rows are aligned, false otherwise.
+	 */
+	static bool isAlignedTo(const T* data, std::ptrdiff_t rowStride, std::size_t vectorBytes)
+	{
+		return (std::uintptr_t) data % vectorBytes == 0 && rowStride * sizeof(T) % vectorBytes == 0;
+	}
+
+	/**
+	 * This method transposes a block: dst = operation(src)^T. Full tiles of an identity
+	 * transpose are transposed in registers, the rest coordinate by coordinate.
+	 * @tparam BYTES - the size of the vectors of a tile.
+	 * The other parameters are the same as in transpose.
+	 */
+	template <unsigned BYTES, class Operation>
+	static void transposeBlock(unsigned rows, unsigned cols, const T* src,
+							   std::ptrdiff_t srcRowStride, T* dst, std::ptrdiff_t dstRowStride,
+							   Operation operation)
+	{
+		unsigned tileRows = 0, tileCols = 0;
+		if constexpr (IS_TRANSPOSED_IN_REGISTERS &&
+					  std::is_same<Operation, IdentityCoordinate>::value)
+		{
+			typedef TransposeLane Vector __attribute__((vector_size(BYTES)));
+			constexpr unsigned lanes = BYTES / sizeof(T);
+			tileRows = rows / lanes * lanes;
+			tileCols = cols / lanes * lanes;
+			for(unsigned row = 0 ; row < tileRows ; row += lanes)
+			{
+				for(unsigned col = 0 ; col < tileCols ; col += lanes)
+				{
+					Vector tile[lanes];
+					loadTile(tile, src + row * srcRowStride + col, srcRowStride);
+					transposeTile(tile);
+					storeTile(tile, dst + col * dstRowStride + row, dstRowStride);
+				}
+			}
+		}
+		for(unsigned row = 0 ; row < rows ; ++row)
+		{
+			// the tiles already covered the first tileCols columns of the first tileRows rows
+			for(unsigned col = row < tileRows ? tileCols : 0 ; col < cols ; ++col)
+			{
+				dst[col * dstRowStride + row] = operation(src[row * srcRowStride + col]);
+			}
+		}
+	}
+
+	/**
+	 * This method swaps a block with its mirror block by the diagonal, transposing both:
+	 * a = operation(b)^T and b = operation(a)^T. If a and b are the same (square) block on
+	 * the diagonal, it is transposed in place.
+	 * @tparam BYTES - the size of the vectors of a tile.
+	 * @param rows - number of rows of a (and columns of b).
+	 * @param cols - number of columns of a (and rows of b).
+	 * @param a - the storage of the block above the diagonal.
+	 * @param b - the storage of the mirror block.
+	 * @param rowStride - the distance between two rows.
+	 * @param operation - applied to every coordinate.
+	 */
+	template <unsigned BYTES, class Operation>
+	static void swapTransposedBlocks(unsigned rows, unsigned cols, T* a, T* b,
+									 std::ptrdiff_t rowStride, Operation operation)
+	{
+		bool isDiagonal = a == b;
+		unsigned tileRows = 0, tileCols = 0;
+		if constexpr (IS_TRANSPOSED_IN_REGISTERS &&
+					  std::is_same<Operation, IdentityCoordinate>::value)
+		{
+			typedef TransposeLane Vector __attribute__((vector_size(BYTES)));
+			constexpr unsigned lanes = BYTES / sizeof(T);
+			tileRows = rows / lanes * lanes;
+			tileCols = cols / lanes * lanes;
+			for(unsigned row = 0 ; row < tileRows ; row += lanes)
+			{
+				// on the diagonal only the tiles on and above it are visited, each one with its
+				// mirror tile
+				for(unsigned col = isDiagonal ? row : 0 ; col < tileCols ; col += lanes)
+				{
+					T* aTile = a + row * rowStride + col;
+					T* bTile = b + col * rowStride + row;
+					Vector aVectors[lanes], bVectors[lanes];
+					loadTile(aVectors, aTile, rowStride);
+					loadTile(bVectors, bTile, rowStride);
+					transposeTile(aVectors);
+					transposeTile(bVectors);
+					storeTile(aVectors, bTile, rowStride);
+					storeTile(bVectors, aTile, rowStride);
+				}
+			}
+		}
+		for(unsigned row = 0 ; row < rows ; ++row)
+		{
+			// the tiles already covered the first tileCols columns of the first tileRows rows
+			unsigned firstCol = std::max(isDiagonal ? row : 0, row < tileRows ? tileCols : 0);
+			for(unsigned col = firstCol ; col < cols ; ++col)
+			{
+				T& aCoord = a[row * rowStride + col];
+				T& bCoord = b[col * rowStride + row];
+				if(&aCoord == &bCoord)
+				{
+					aCoord = operation(aCoord);
+				}
+				else
+				{
+					T transposedA = operation(aCoord);
+					aCoord = operation(bCoord);
+					bCoord = transposedA;
+				}
+			}
+		}
+	}
+
+	/**
+	 * This method loads a square tile into SIMD registers, a row per register.
+	 * @tparam Vector - the type of a register.
+	 * @param tile - the registers.
+	 * @param data - the storage of the tile.
+	 * @param rowStride - the distance between two rows.
+	 */
+	template <class Vector>
+	static void loadTile(Vector* tile, const T* data, std::ptrdiff_t rowStride)
+	{
+		constexpr unsigned lanes = sizeof(Vector) / sizeof(T);
+#pragma GCC unroll 16
+		for(unsigned row = 0 ; row < lanes ; ++row)
+		{
+			std::memcpy(&tile[row], data + row * rowStride, sizeof(Vector));
+		}
+	}
+
+	/**
+	 * This method stores a square tile from SIMD registers, a row per register.
+	 * @tparam Vector - the type of a register.
+	 * @param tile - the registers.
+	 * @param data - the storage of the tile.
+	 * @param rowStride - the distance between two rows.
+	 */
+	template <class Vector>
+	static void storeTile(const Vector* tile, T* data, std::ptrdiff_t rowStride)
+	{
+		constexpr unsigned lanes = sizeof(Vector) / sizeof(T);
+#pragma GCC unroll 16
+		for(unsigned row = 0 ; row < lanes ; ++row)
+		{
+			std::memcpy(data + row * rowStride, &tile[row], sizeof(Vector));
+		}
+	}
+
+	/**
+	 * This method transposes a square tile in SIMD registers. For h = 1, 2, 4, ... every pair of
+	 * rows i and i + h (with bit h of i clear) exchanges its h-wide blocks across the diagonal:
+	 * the first row keeps its even blocks and takes the even blocks of the second row, and the
+	 * second row takes the odd blocks of the first row and keeps its odd blocks. After all the
+	 * levels the tile is transposed.
+	 * @tparam Vector - the type of a register.
+	 * @param tile - the registers of the tile.
+	 */
+	template <class Vector>
+	static void transposeTile(Vector* tile)
+	{
+#if TRANSPOSE_IN_REGISTERS
+		typedef MaskLane Mask __attribute__((vector_size(sizeof(Vector))));
+		constexpr unsigned lanes = sizeof(Vector) / sizeof(T);
+#pragma GCC unroll 16
+		for(unsigned h = 1 ; h < lanes ; h *= 2)
+		{
+			Mask low = {}, high = {};
+#pragma GCC unroll 16
+			for(unsigned lane = 0 ; lane < lanes ; ++lane)
+			{
+				// lanes of the second row are numbered from lanes on in the shuffle
+				low[lane] = (lane & h) ? lanes + lane - h : lane;
+				high[lane] = (lane & h) ? lanes + lane : lane + h;
+			}
+#pragma GCC unroll 16
+			for(unsigned row = 0 ; row < lanes ; ++row)
+			{
+				if(!(row & h))
+				{
+					Vector first = tile[row], second = tile[row + h];
+					tile[row] = __builtin_shuffle(first, second, low);
+					tile[row + h] = __builtin_shuffle(first, second, high);
+				}
+			}
+		}
+#else
+		(void) tile;
+#endif
+	}
+
+	/**
+	 * This method converts a coordinate of the operands to T. A coordinate of type T is
+	 * returned as is, without a copy.
+	 * @param coord - the coordinate.
+	 * @return the coordinate.
+	 */
+	static const T& widen(const T& coord)
+	{
+		return coord;
+	}
+
+	template <class Source> static T widen(const Source& coord)
+	{
+		return T(coord);
+	}
+
+	/**
+	 * This method returns a packing buffer of the calling thread, which is reused between calls.
+	 * @param index - 0 for the buffer of A, 1 for the buffer of B, 2 for the expanded complex B
+	 * of gemmComplex.
+	 * @return the packing buffer.
+	 */
+	static std::vector<T>& packingBuffer(int index)
+	{
+		thread_local std::vector<T> buffers[3];
+		return buffers[index];
+	}
+
+	/**
+	 * This method packs a block of A into slivers of MICRO_ROWS rows. Inside a sliver the
+	 * coordinates are stored depth by depth, so the micro-kernel reads them sequentially.
+	 * Missing rows of the last sliver are padded with zeros.
+	 * @tparam Source - the coordinate type of A, converted to T.
+	 * @param rows - number of rows of the block.
+	 * @param depth - number of columns of the block.
+	 * @param a - the storage of the block.
+	 * @param rowStride - the distance between two rows.
+	 * @param colStride - the distance between two columns.
+	 * @param packed - the destination.
+	 */
+	template <class Source>
+	static void packA(unsigned rows, unsigned depth, const Source* a, std::ptrdiff_t rowStride,
+					  std::ptrdiff_t colStride, T* packed)
+	{
+		for(unsigned sliver = 0 ; sliver < rows ; sliver += MICRO_ROWS)
+		{
+			unsigned sliverRows = std::min(MICRO_ROWS, rows - sliver);
+			for(unsigned i = 0 ; i < depth ; ++i)
+			{
+				for(unsigned row = 0 ; row < MICRO_ROWS ; ++row)
+				{
+					*packed++ = row < sliverRows ?
+								widen(a[(sliver + row) * rowStride + i * colStride]) : T(0);
+				}
+			}
+		}
+	}
+
+	/**
+	 * This method packs a panel of B into slivers of microCols columns. Inside a sliver the
+	 * coordinates are stored depth by depth, so the micro-kernel reads them sequentially.
+	 * Missing columns of the last sliver are padded with zeros.
+	 * @tparam Source - the coordinate type of B, converted to T.
+	 * @param depth - number of rows of the panel.
+	 * @param cols - number of columns of the panel.
+	 * @param b - the storage of the panel.
+	 * @param rowStride - the distance between two rows.
+	 * @param colStride - the distance between two columns.
+	 * @param microCols - the number of columns of the register tile (see microCols).
+	 * @param packed - the destination.
+	 */
+	template <class Source>
+	static void packB(unsigned depth, unsigned cols, const Source* b, std::ptrdiff_t rowStride,
+					  std::ptrdiff_t colStride, unsigned microCols, T* packed)
+	{
+		for(unsigned sliver = 0 ; sliver < cols ; sliver += microCols)
+		{
+			unsigned sliverCols = std::min(microCols, cols - sliver);
+			for(unsigned i = 0 ; i < depth ; ++i)
+			{
+				const Source* bRow = b + i * rowStride + sliver * colStride;
+				for(unsigned col = 0 ; col < microCols ; ++col)
+				{
+					*packed++ = col < sliverCols ? widen(bRow[col * colStride]) : T(0);
+				}
+			}
+		}
+	}
+
+	/**
+	 * This method returns the number of columns of the register tile of registers of BYTES
+	 * bytes: a few SIMD registers per tile row.
+	 * @tparam BYTES - the size of a SIMD register.
+	 * @return the number of columns of the register tile.
+	 */
+	template <unsigned BYTES>
+	static constexpr unsigned microCols()
+	{
+		return GEMM_VECTORS_PER_TILE_ROW * (IS_BLOCKED ? BYTES / sizeof(T) : 1);
+	}
+
+	/**
+	 * This method detects (once) which registers the micro-kernel uses on the running CPU:
+	 * the SIMD level of the element-wise kernels, except that the AVX-512 kernel also needs the
+	 * BW, DQ and VL extensions (for the products of narrow integers), and the AVX2 one FMA.
+	 * @return the SIMD level of the micro-kernel.
+	 */
+	static SimdLevel gemmSimdLevel()
+	{
+#if ELEMENTWISE_RUNTIME_DISPATCH
+		static const SimdLevel level = []
+		{
+			SimdLevel detected = detectSimdLevel();
+			if(detected == SimdLevel::Avx512 && !(__builtin_cpu_supports("avx512bw") &&
+												  __builtin_cpu_supports("avx512dq") &&
+												  __builtin_cpu_supports("avx512vl")))
+			{
+				detected = SimdLevel::Avx2;
+			}
+			if(detected == SimdLevel::Avx2 && !__builtin_cpu_supports("fma"))
+			{
+				detected = SimdLevel::Baseline;
+			}
+			return detected;
+		}();
+		return level;
+#else
+		return SimdLevel::Baseline;
+#endif
+	}
+
+	/**
+	 * This method multiplies a packed block of A by a packed panel of B into C with registers
+	 * of BYTES bytes. The AVX2 and AVX-512 kernels are compiled for their instruction sets (the
+	 * rest of the program may not be), and only called on CPUs which have them.
+	 * @tparam BYTES - the size of a SIMD register.
+	 * The parameters are the same as in multiplyPackedBlocksLanes.
+	 */
+	template <unsigned BYTES>
+	static void multiplyPackedBlocks(unsigned rows, unsigned cols, unsigned depth,
+									 const T* packedA, const T* packedB, T* c,
+									 std::ptrdiff_t rowStride, std::ptrdiff_t colStride,
+									 bool accumulate)
+	{
+		if constexpr (BYTES == GEMM_VECTOR_BYTES)
+		{
+			multiplyPackedBlocksLanes<BYTES>(rows, cols, depth, packedA, packedB, c, rowStride,
+											 colStride, accumulate);
+		}
+		else if constexpr (BYTES == AVX2_VECTOR_BYTES)
+		{
+			multiplyPackedBlocksAvx2(rows, cols, depth, packedA, packedB, c, rowStride,
+									 colStride, accumulate);
+		}
+		else
+		{
+			multiplyPackedBlocksAvx512(rows, cols, depth, packedA, packedB, c, rowStride,
+									   colStride, accumulate);
+		}
+	}
+
+#if ELEMENTWISE_RUNTIME_DISPATCH
+	/**
+	 * These methods compile the micro-kernel with AVX2 (and FMA) and AVX-512 registers.
+	 */
+	__attribute__((target("avx2,fma")))
+	static void multiplyPackedBlocksAvx2(unsigned rows, unsigned cols, unsigned depth,
+										 const T* packedA, const T* packedB, T* c,
+										 std::ptrdiff_t rowStride, std::ptrdiff_t colStride,
+										 bool accumulate)
+	{
+		multiplyPackedBlocksLanes<AVX2_VECTOR_BYTES>(rows, cols, depth, packedA, packedB, c,
+													 rowStride, colStride, accumulate);
+	}
+
+	__attribute__((target("avx512f,avx512bw,avx512dq,avx512vl,fma")))
+	static void multiplyPackedBlocksAvx512(unsigned rows, unsigned cols, unsigned depth,
+										   const T* packedA, const T* packedB, T* c,
+										   std::ptrdiff_t rowStride, std::ptrdiff_t colStride,
+										   bool accumulate)
+	{
+		multiplyPackedBlocksLanes<AVX512_VECTOR_BYTES>(rows, cols, depth, packedA, packedB, c,
+													   rowStride, colStride, accumulate);
+	}
+#else
+	/**
+	 * Without runtime dispatch only the registers of the build are used.
+	 */
+	static void multiplyPackedBlocksAvx2(unsigned rows, unsigned cols, unsigned depth,
+										 const T* packedA, const T* packedB, T* c,
+										 std::ptrdiff_t rowStride, std::ptrdiff_t colStride,
+										 bool accumulate)
+	{
+		multiplyPackedBlocksLanes<GEMM_VECTOR_BYTES>(rows, cols, depth, packedA, packedB, c,
+													 rowStride, colStride, accumulate);
+	}
+
+	static void multiplyPackedBlocksAvx512(unsigned rows, unsigned cols, unsigned depth,
+										   const T* packedA, const T* packedB, T* c,
+										   std::ptrdiff_t rowStride, std::ptrdiff_t colStride,
+										   bool accumulate)
+	{
+		multiplyPackedBlocksLanes<GEMM_VECTOR_BYTES>(rows, cols, depth, packedA, packedB, c,
+													 rowStride, colStride, accumulate);
+	}
+#endif
+
+	/**
+	 * This method multiplies a packed block of A by a packed panel of B into C, register tile
+	 * by register tile. It is always inlined, so it is compiled for the instruction set of the
+	 * kernel which calls it.
+	 * @tparam BYTES - the size of a SIMD register.
+	 * @param rows - number of rows of the block of A.
+	 * @param cols - number of columns of the panel of B.
+	 * @param depth - the shared dimension of the block and the panel.
+	 * @param packedA - the packed block of A.
+	 * @param packedB - the packed panel of B.
+	 * @param c - the storage of the block of C.
+	 * @param rowStride - the distance between two rows of C.
+	 * @param colStride - the distance between two columns of C.
+	 * @param accumulate - true to add the product to C, false to overwrite C with it.
+	 */
+	template <unsigned BYTES>
+	__attribute__((always_inline)) static inline void multiplyPackedBlocksLanes(
+			unsigned rows, unsigned cols, unsigned depth, const T* packedA, const T* packedB,
+			T* c, std::ptrdiff_t rowStride, std::ptrdiff_t colStride, bool accumulate)
+	{
+		constexpr unsigned sliverCols = microCols<BYTES>();
+		for(unsigned colSliver = 0 ; colSliver < cols ; colSliver += sliverCols)
+		{
+			const T* sliverB = packedB + (std::size_t) colSliver * depth;
+			for(unsigned rowSliver = 0 ; rowSliver < rows ; rowSliver += MICRO_ROWS)
+			{
+				microKernel<BYTES>(depth, packedA + (std::size_t) rowSliver * depth, sliverB,
+								   c + rowSliver * rowStride + colSliver * colStride, rowStride,
+								   colStride, std::min(MICRO_ROWS, rows - rowSliver),
+								   std::min(sliverCols, cols - colSliver), accumulate);
+			}
+		}
+	}
+
+	/**
+	 * This method is the register micro-kernel: it multiplies a packed sliver of A by a packed
+	 * sliver of B into a MICRO_ROWS x microCols tile of accumulators. The tile is an array of
+	 * SIMD vectors with compile time dimensions, so the compiler keeps it in registers, and each
+	 * step of the depth loop is one broadcast of A and one fused multiply-add per register.
+	 * Only the valid part of the tile is written to C.
+	 * @tparam BYTES - the size of a SIMD register.
+	 * @param depth - the shared dimension of the slivers.
+	 * @param sliverA - the packed sliver of A.
+	 * @param sliverB - the packed sliver of B.
+	 * @param c - the storage of the tile of C.
+	 * @param rowStride - the distance between two rows of C.
+	 * @param colStride - the distance between two columns of C.
+	 * @param validRows - the number of valid rows of the tile.
+	 * @param validCols - the number of valid columns of the tile.
+	 * @param accumulate - true to add the tile to C, false to overwrite C with it.
+	 */
+	template <unsigned BYTES>
+	__attribute__((always_inline)) static inline void microKernel(
+			unsigned depth, const T* __restrict sliverA, const T* __restrict sliverB, T* c,
+			std::ptrdiff_t rowStride, std::ptrdiff_t colStride, unsigned validRows,
+			unsigned validCols, bool accumulate)
+	{
+		typedef VectorLane Vector __attribute__((vector_size(BYTES)));
+		constexpr unsigned sliverCols = microCols<BYTES>();
+		Vector tile[MICRO_ROWS][GEMM_VECTORS_PER_TILE_ROW] = {};
+		for(unsigned i = 0 ; i < depth ; ++i)
+		{
+			Vector bVectors[GEMM_VECTORS_PER_TILE_ROW];
+			std::memcpy(bVectors, sliverB, sizeof(bVectors));
+			for(unsigned row = 0 ; row < MICRO_ROWS ; ++row)
+			{
+				Vector aBroadcast = Vector{} + sliverA[row];
+				for(unsigned vector = 0 ; vector < GEMM_VECTORS_PER_TILE_ROW ; ++vector)
+				{
+					tile[row][vector] += aBroadcast * bVectors[vector];
+				}
+			}
+			sliverA += MICRO_ROWS;
+			sliverB += sliverCols;
+		}
+		T tileCoords[MICRO_ROWS][sliverCols];
+		std::memcpy(tileCoords, tile, sizeof(tileCoords));
+		for(unsigned row = 0 ; row < validRows ; ++row)
+		{
+			T* cRow = c + row * rowStride;
+			for(unsigned col = 0 ; col < validCols ; ++col)
+			{
+				cRow[col * colStride] = accumulate ? cRow[col * colStride] + tileCoords[row][col] :
+									   tileCoords[row][col];
+			}
+		}
+	}
+
+};
+
+#endif
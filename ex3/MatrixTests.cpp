@@ -0,0 +1,407 @@
+//================================ Includes =====================================================
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <dirent.h>
+#include "Complex.h"
+#include "LinearSolvers.hpp"
+#include "Matrix.hpp"
+#include "MatrixIO.hpp"
+#include "MatrixView.hpp"
+#include "PerfCounters.hpp"
+#include "SparseMatrix.hpp"
+#include "StaticMatrix.hpp"
+#include "ThreadPool.hpp"
+#include "TiledMatrix.hpp"
+//================================ Constants ====================================================
+#define TEST_FILE_PATH "/tmp/cpp3_matrix_tests.mtx"
+#define DESCRIPTORS_DIRECTORY "/proc/self/fd"
+#define RANDOM_SEED 1
+#define TOLERANCE 1e-9
+#define NUM_OF_CHURN_ROUNDS 20
+#define NUM_OF_CHURN_THREADS 4
+#define CHURN_WORK 200000
+#define TILE_SIZE 16
+#define NUM_OF_CACHED_TILES 3
+#define NUM_OF_TILES_PER_THREAD 6
+#define NUM_OF_CACHE_THREADS 4
+#define NUM_OF_CACHE_ROUNDS 400
+#define PREFETCH_ONE_IN 3
+#define TILED_ROWS 70
+#define TILED_COLS 45
+#define TILED_INNER 38
+#define BLOCK_ROWS 10u
+#define BLOCK_COLS 8u
+#define SPARSE_SIZE 40
+#define NON_ZERO_ONE_IN 5
+#define SOLVER_SIZE 24
+#define PASSED_MESSAGE "passed"
+#define FAILED_MESSAGE "FAILED"
+#define SKIPPED_MESSAGE "skipped (no counter is available)"
+//================================ Code Segment =================================================
+
+/**
+ * This file holds the tests of the parts of our matrix library which the benchmark suite does
+ * not run: the performance counters across threads which start and end, the tile cache and the
+ * tiled matrices, the matrix files, and the sparse and static matrices. Every test returns
+ * whether it passed, and the program fails if any of them did not.
+ */
+
+/**
+ * This function fills a matrix with random coordinates in [-1, 1].
+ * @param m - the matrix.
+ * @param generator - the random generator.
+ */
+void fillRandom(Matrix<double>& m, std :: mt19937& generator)
+{
+	std :: uniform_real_distribution<double> distribution(-1, 1);
+	for(double& coord : m)
+	{
+		coord = distribution(generator);
+	}
+}
+
+/**
+ * This function returns the largest difference between the coordinates of two matrices.
+ * @param m1 - the first matrix.
+ * @param m2 - the second matrix, of the same dimensions.
+ * @return the largest absolute difference, or infinity if the dimensions differ.
+ */
+double maxDifference(const Matrix<double>& m1, const Matrix<double>& m2)
+{
+	if(m1.rows() != m2.rows() || m1.cols() != m2.cols())
+	{
+		return INFINITY;
+	}
+	double difference = 0;
+	for(unsigned int row = 0 ; row < m1.rows() ; ++row)
+	{
+		for(unsigned int col = 0 ; col < m1.cols() ; ++col)
+		{
+			difference = std :: max(difference, std :: abs(m1(row, col) - m2(row, col)));
+		}
+	}
+	return difference;
+}
+
+/**
+ * This function counts the open file descriptors of the process.
+ * @return the number of entries of /proc/self/fd.
+ */
+std :: size_t numOfOpenDescriptors()
+{
+	std :: size_t count = 0;
+	DIR* directory = opendir(DESCRIPTORS_DIRECTORY);
+	if(directory == nullptr)
+	{
+		return count;
+	}
+	while(readdir(directory) != nullptr)
+	{
+		++count;
+	}
+	closedir(directory);
+	return count;
+}
+
+/**
+ * This function tests that the counters follow threads which start and end: the pool is grown
+ * and shrunk every round, the total counts never decrease (the counts of the ended threads are
+ * kept) and the counters of the ended threads are closed.
+ * @return true if the test passed.
+ */
+bool testPerfCountersThreadChurn()
+{
+	PerfCounters& counters = PerfCounters::instance();
+	PerfCounter counter = PerfCounter::TaskClockNanoseconds;
+	while(!counters.isAvailable(counter) && counter != PerfCounter::Cycles)
+	{
+		counter = (PerfCounter) ((std :: size_t) counter - 1);
+	}
+	if(!counters.isAvailable(counter))
+	{
+		std :: cout << SKIPPED_MESSAGE << ' ';
+		return true;
+	}
+	ThreadPool& pool = ThreadPool::instance();
+	unsigned int numOfThreads = pool.numOfThreads();
+	pool.setNumOfThreads(1);
+	double last = counters.read()[counter];
+	std :: size_t descriptors = numOfOpenDescriptors();
+	bool passed = true;
+	for(unsigned int round = 0 ; round < NUM_OF_CHURN_ROUNDS ; ++round)
+	{
+		pool.setNumOfThreads(NUM_OF_CHURN_THREADS);
+		counters.read();
+		pool.parallelFor(NUM_OF_CHURN_THREADS, [](std :: size_t)
+		{
+			volatile double sum = 0;
+			for(unsigned int step = 0 ; step < CHURN_WORK ; ++step)
+			{
+				sum = sum + step;
+			}
+		});
+		double running = counters.read()[counter];
+		pool.setNumOfThreads(1);
+		double ended = counters.read()[counter];
+		passed = passed && last <= running && running <= ended;
+		last = ended;
+	}
+	passed = passed && numOfOpenDescriptors() == descriptors;
+	pool.setNumOfThreads(numOfThreads);
+	return passed;
+}
+
+/**
+ * This function tests the eviction of the tile cache: threads increment their own tiles many
+ * times through a cache which holds only a few of them, so most acquisitions evict a dirty
+ * tile, and no increment may be lost.
+ * @return true if the test passed.
+ */
+bool testTileCacheEviction()
+{
+	TileCache<int> cache(NUM_OF_CACHED_TILES * TILE_SIZE * TILE_SIZE * sizeof(int));
+	TileFile<int> file(cache.directory(), NUM_OF_CACHE_THREADS * NUM_OF_TILES_PER_THREAD,
+					   TILE_SIZE);
+	std :: vector<std :: thread> threads;
+	for(unsigned int thread = 0 ; thread < NUM_OF_CACHE_THREADS ; ++thread)
+	{
+		threads.emplace_back([&cache, &file, thread]
+		{
+			std :: mt19937 generator(thread);
+			std :: size_t firstTile = thread * NUM_OF_TILES_PER_THREAD;
+			for(unsigned int round = 0 ; round < NUM_OF_CACHE_ROUNDS ; ++round)
+			{
+				if(generator() % PREFETCH_ONE_IN == 0)
+				{
+					cache.prefetch(file, firstTile + generator() % NUM_OF_TILES_PER_THREAD);
+				}
+				std :: size_t index = firstTile + generator() % NUM_OF_TILES_PER_THREAD;
+				std :: shared_ptr<Matrix<int>> tile = cache.acquire(file, index,
+																	  TileAccess::Write);
+				for(int& coord : *tile)
+				{
+					++coord;
+				}
+			}
+		});
+	}
+	for(std :: thread& thread : threads)
+	{
+		thread.join();
+	}
+	long total = 0;
+	for(std :: size_t index = 0 ; index < NUM_OF_CACHE_THREADS * NUM_OF_TILES_PER_THREAD ; ++index)
+	{
+		std :: shared_ptr<Matrix<int>> tile = cache.acquire(file, index, TileAccess::Read);
+		total += (*tile)(TILE_SIZE - 1, TILE_SIZE - 1);
+	}
+	bool passed = total == NUM_OF_CACHE_THREADS * NUM_OF_CACHE_ROUNDS &&
+				  cache.size() <= cache.capacity() &&
+				  cache.misses() > NUM_OF_CACHE_THREADS * NUM_OF_TILES_PER_THREAD;
+	cache.drop(file);
+	return passed;
+}
+
+/**
+ * This function tests the tiled matrices through a cache of two tiles: a product and a sum
+ * against the ones of Matrix, then a save, which streams the tiles, loaded back both by load
+ * and by MappedMatrix.
+ * @return true if the test passed.
+ */
+bool testTiledSaveAndMappedLoad()
+{
+	std :: mt19937 generator(RANDOM_SEED);
+	Matrix<double> a(TILED_ROWS, TILED_INNER), b(TILED_INNER, TILED_COLS);
+	Matrix<double> c(TILED_ROWS, TILED_COLS);
+	fillRandom(a, generator);
+	fillRandom(b, generator);
+	fillRandom(c, generator);
+	TileCache<double> cache(2 * TILE_SIZE * TILE_SIZE * sizeof(double));
+	TiledMatrix<double> tiledA(view(a), cache, TILE_SIZE), tiledB(view(b), cache, TILE_SIZE);
+	TiledMatrix<double> tiledC(view(c), cache, TILE_SIZE);
+	TiledMatrix<double> result = tiledA * tiledB + tiledC;
+	Matrix<double> expected = a * b + c;
+	bool passed = maxDifference(result.block(0, 0, TILED_ROWS, TILED_COLS), expected) < TOLERANCE;
+	result.set(TILED_ROWS - 1, TILED_COLS - 1, 0);
+	expected(TILED_ROWS - 1, TILED_COLS - 1) = 0;
+	result.save(TEST_FILE_PATH);
+	Matrix<double> loaded = load<double>(TEST_FILE_PATH);
+	passed = passed && maxDifference(loaded, result.block(0, 0, TILED_ROWS, TILED_COLS)) == 0;
+	{
+		MappedMatrix<double> mapped(TEST_FILE_PATH);
+		passed = passed && maxDifference(Matrix<double>(mapped.view()), loaded) == 0;
+		TiledMatrix<double> tiledMapped(mapped.view(), cache, TILE_SIZE);
+		Matrix<double> mappedBlock = tiledMapped.block(0, 0, TILED_ROWS, TILED_COLS);
+		passed = passed && tiledMapped.get(TILED_ROWS - 1, TILED_COLS - 1) == 0 &&
+				 maxDifference(mappedBlock, expected) < TOLERANCE;
+	}
+	std :: remove(TEST_FILE_PATH);
+	return passed;
+}
+
+/**
+ * This function tests writing a matrix file block by block, in both storage orders and in a
+ * shuffled order of the blocks, and that overlapping blocks and missing blocks are rejected.
+ * @return true if the test passed.
+ */
+bool testChunkedWriterBlocks()
+{
+	std :: mt19937 generator(RANDOM_SEED);
+	Matrix<double> m(TILED_ROWS, TILED_COLS);
+	fillRandom(m, generator);
+	std :: vector<std :: pair<unsigned int, unsigned int>> corners;
+	for(unsigned int row = 0 ; row < TILED_ROWS ; row += BLOCK_ROWS)
+	{
+		for(unsigned int col = 0 ; col < TILED_COLS ; col += BLOCK_COLS)
+		{
+			corners.emplace_back(row, col);
+		}
+	}
+	std :: shuffle(corners.begin(), corners.end(), generator);
+	bool passed = true;
+	for(StorageOrder order : {StorageOrder::RowMajor, StorageOrder::ColMajor})
+	{
+		ChunkedMatrixWriter<double> writer(TEST_FILE_PATH, TILED_ROWS, TILED_COLS, order);
+		for(const std :: pair<unsigned int, unsigned int>& corner : corners)
+		{
+			unsigned int rows = std :: min(BLOCK_ROWS, TILED_ROWS - corner.first);
+			unsigned int cols = std :: min(BLOCK_COLS, TILED_COLS - corner.second);
+			writer.writeBlock(corner.first, corner.second,
+							  view(m).block(corner.first, corner.second, rows, cols));
+		}
+		writer.close();
+		passed = passed && maxDifference(load<double>(TEST_FILE_PATH), m) == 0;
+	}
+	ChunkedMatrixWriter<double> writer(TEST_FILE_PATH, TILED_ROWS, TILED_COLS);
+	writer.writeBlock(0, 0, view(m).block(0, 0, BLOCK_ROWS, BLOCK_COLS));
+	try
+	{
+		writer.writeBlock(1, 1, view(m).block(1, 1, BLOCK_ROWS, BLOCK_COLS));
+		passed = false;
+	}
+	catch(const std :: invalid_argument&)
+	{
+	}
+	try
+	{
+		writer.close();
+		passed = false;
+	}
+	catch(const std :: runtime_error&)
+	{
+	}
+	std :: remove(TEST_FILE_PATH);
+	return passed;
+}
+
+/**
+ * This function tests the sparse matrices against the dense ones: a product by a vector and
+ * by a matrix, in both layouts, a sum and a transpose.
+ * @return true if the test passed.
+ */
+bool testSparseMatrix()
+{
+	std :: mt19937 generator(RANDOM_SEED);
+	Matrix<double> dense(SPARSE_SIZE, SPARSE_SIZE), other(SPARSE_SIZE, SPARSE_SIZE);
+	fillRandom(dense, generator);
+	fillRandom(other, generator);
+	for(double& coord : dense)
+	{
+		coord = generator() % NON_ZERO_ONE_IN == 0 ? coord : 0;
+	}
+	std :: vector<double> x(SPARSE_SIZE);
+	Matrix<double> column(SPARSE_SIZE, 1);
+	for(unsigned int row = 0 ; row < SPARSE_SIZE ; ++row)
+	{
+		x[row] = column(row, 0) = other(row, 0);
+	}
+	bool passed = true;
+	for(SparseLayout layout : {SparseLayout::Csr, SparseLayout::Csc})
+	{
+		SparseMatrix<double> sparse(dense, layout);
+		std :: vector<double> y = sparse * x;
+		Matrix<double> expectedY = dense * column;
+		for(unsigned int row = 0 ; row < SPARSE_SIZE ; ++row)
+		{
+			passed = passed && std :: abs(y[row] - expectedY(row, 0)) < TOLERANCE;
+		}
+		passed = passed && maxDifference(sparse * other, dense * other) < TOLERANCE &&
+				 maxDifference((sparse + sparse).toDense(), dense + dense) == 0 &&
+				 maxDifference(sparse.trans().toDense(), dense.trans()) == 0;
+	}
+	return passed;
+}
+
+/**
+ * This function tests the static matrices and the LU solver against Matrix.
+ * @return true if the test passed.
+ */
+bool testStaticMatrixAndSolver()
+{
+	std :: mt19937 generator(RANDOM_SEED);
+	Matrix<double> left(3, 4), right(4, 2);
+	fillRandom(left, generator);
+	fillRandom(right, generator);
+	StaticMatrix<double, 3, 4> staticLeft(left);
+	StaticMatrix<double, 4, 2> staticRight(right);
+	bool passed = maxDifference(Matrix<double>(staticLeft * staticRight), left * right) < TOLERANCE
+				  && maxDifference(Matrix<double>(staticLeft.trans()), left.trans()) == 0;
+	Matrix<double> a(SOLVER_SIZE, SOLVER_SIZE), b(SOLVER_SIZE, 1);
+	fillRandom(a, generator);
+	fillRandom(b, generator);
+	for(unsigned int diagonal = 0 ; diagonal < SOLVER_SIZE ; ++diagonal)
+	{
+		// a dominant diagonal keeps the system well conditioned
+		a(diagonal, diagonal) += SOLVER_SIZE;
+	}
+	return passed && maxDifference(a * solve(a, b), b) < TOLERANCE;
+}
+
+/**
+ * This struct represents a test: its name and its function.
+ */
+struct Test
+{
+	const char* name;
+	bool (*run)();
+};
+
+/**
+ * This is the main function of the tests. It runs every test and reports whether it passed.
+ * @return 0 if all the tests passed, non-zero otherwise.
+ */
+int main()
+{
+	const Test tests[] = {{"perf counters thread churn", testPerfCountersThreadChurn},
+						  {"tile cache eviction", testTileCacheEviction},
+						  {"tiled save and mapped load", testTiledSaveAndMappedLoad},
+						  {"chunked writer blocks", testChunkedWriterBlocks},
+						  {"sparse matrix", testSparseMatrix},
+						  {"static matrix and solver", testStaticMatrixAndSolver}};
+	int result = EXIT_SUCCESS;
+	for(const Test& test : tests)
+	{
+		std :: cout << test.name << ": ";
+		bool passed = false;
+		try
+		{
+			passed = test.run();
+		}
+		catch(const std :: exception& e)
+		{
+			std :: cout << e.what() << ' ';
+		}
+		std :: cout << (passed ? PASSED_MESSAGE : FAILED_MESSAGE) << std :: endl;
+		result = passed ? result : EXIT_FAILURE;
+	}
+	return result;
+}
@@ -0,0 +1,735 @@
+//================================ Includes =====================================================
+#include "Matrix.hpp"
+#include "MatrixExpressions.hpp"
+#include "MatrixKernels.hpp"
+#include "ThreadPool.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <iostream>
+#include <stdexcept>
+//================================ Constants ====================================================
+#ifndef CPP3_MATRIX_VIEW_H
+#define CPP3_MATRIX_VIEW_H
+//================================ Code Segment =================================================
+
+template <class T> class MappedMatrix;
+
+/**
+ * This file adds non-owning views of matrices. view(A) refers to the storage of A, and block(),
+ * row(), col() and trans() of a view are views of the same storage, so blocks of a matrix are
+ * read and written in place, without copies. Views are lazy expressions (see
+ * MatrixExpressions.hpp): they mix with matrices and other expressions in +, - and *, a product
+ * of views runs as a strided GEMM, and assigning an expression to a MatrixView writes it into
+ * the block directly. For example, the update of a blocked LU factorization:
+ * view(A).block(k, k, m, m) -= view(A).block(k, 0, m, k) * view(A).block(0, k, k, m);
+ * A view should not outlive the matrix it refers to, and it is invalidated when the matrix is
+ * assigned a matrix of other dimensions.
+ */
+
+/**
+ * This class represents a read-only view of a block of a matrix, possibly transposed. Unlike
+ * Matrix<T>::trans(), trans() of a view of complex numbers does not conjugate them.
+ * @tparam T - the generic type of a coordinate.
+ */
+template <class T> class ConstMatrixView : public MatrixExpression<T, ConstMatrixView<T>>
+{
+	public:
+
+	/**
+	 * This constructor views a whole matrix. A column-major matrix is viewed as the transpose of
+	 * its row-major storage.
+	 * @tparam Allocator - the allocator of the matrix.
+	 * @tparam Order - the storage order of the matrix.
+	 * @param m - the matrix.
+	 */
+	template <class Allocator, StorageOrder Order>
+	explicit ConstMatrixView(const Matrix<T, Allocator, Order>& m) :
+	ConstMatrixView(m._vectorMatrix.data(), m._vectorMatrix.data(), m.numOfMinors(), m._numOfRows,
+					m._numOfCols, Order == StorageOrder::ColMajor)
+	{
+
+	}
+
+	/**
+	 * This method returns number of rows of the view.
+	 * @return number of rows of the view.
+	 */
+	unsigned int rows() const
+	{
+		return _numOfRows;
+	}
+
+	/**
+	 * This method returns number of columns of the view.
+	 * @return number of columns of the view.
+	 */
+	unsigned int cols() const
+	{
+		return _numOfCols;
+	}
+
+	/**
+	 * This method returns the storage of the first coordinate of the view.
+	 * @return the storage of coordinate (0, 0).
+	 */
+	const T* data() const
+	{
+		return _data;
+	}
+
+	/**
+	 * This method returns the distance between two rows of the view in the storage.
+	 * @return the row stride.
+	 */
+	std::ptrdiff_t rowStride() const
+	{
+		return _isTransposed ? 1 : _originCols;
+	}
+
+	/**
+	 * This method returns the distance between two columns of the view in the storage.
+	 * @return the column stride.
+	 */
+	std::ptrdiff_t colStride() const
+	{
+		return _isTransposed ? _originCols : 1;
+	}
+
+	/**
+	 * This method accesses a coordinate of the view.
+	 * @param row - the coordinate row
+	 * @param column - the coordinate column
+	 * @return view coordinate (row, column).
+	 * @throw out of range exception of index out of bounds.
+	 */
+	const T& operator()(const unsigned int row, const unsigned int column) const
+	{
+		checkIndex(row, column);
+		return at(row, column);
+	}
+
+	/**
+	 * This method returns a view of a block of the view.
+	 * @param row - the first row of the block.
+	 * @param col - the first column of the block.
+	 * @param rows - number of rows of the block.
+	 * @param cols - number of columns of the block.
+	 * @return the view of the block.
+	 * @throw out of range exception if the block is not inside the view.
+	 */
+	ConstMatrixView block(unsigned int row, unsigned int col, unsigned int rows,
+						  unsigned int cols) const
+	{
+		checkBlock(row, col, rows, cols);
+		return ConstMatrixView(_data + row * rowStride() + col * colStride(), _origin, _originCols,
+							   rows, cols, _isTransposed);
+	}
+
+	/**
+	 * This method returns a view of a row of the view.
+	 * @param row - the row.
+	 * @return the view of the row, a 1 * cols() view.
+	 * @throw out of range exception of index out of bounds.
+	 */
+	ConstMatrixView row(unsigned int row) const
+	{
+		return block(row, 0, 1, _numOfCols);
+	}
+
+	/**
+	 * This method returns a view of a column of the view.
+	 * @param col - the column.
+	 * @return the view of the column, a rows() * 1 view.
+	 * @throw out of range exception of index out of bounds.
+	 */
+	ConstMatrixView col(unsigned int col) const
+	{
+		return block(0, col, _numOfRows, 1);
+	}
+
+	/**
+	 * This method returns the transposed view: the same storage with swapped strides.
+	 * @return the transposed view.
+	 */
+	ConstMatrixView trans() const
+	{
+		return ConstMatrixView(_data, _origin, _originCols, _numOfCols, _numOfRows, !_isTransposed);
+	}
+
+	/**
+	 * This method returns the rectangle of the storage of the matrix which the view covers.
+	 * @return the region of the view.
+	 */
+	StorageRegion<T> region() const
+	{
+		std::size_t offset = _data - _origin;
+		unsigned int firstRow = _originCols == 0 ? 0 : (unsigned int) (offset / _originCols);
+		unsigned int firstCol = _originCols == 0 ? 0 : (unsigned int) (offset % _originCols);
+		unsigned int numOfRows = _isTransposed ? _numOfCols : _numOfRows;
+		unsigned int numOfCols = _isTransposed ? _numOfRows : _numOfCols;
+		return {_origin, firstRow, firstRow + numOfRows, firstCol, firstCol + numOfCols};
+	}
+
+	/**
+	 * This method prepares the view for reading (nothing to do).
+	 */
+	void prepare() const
+	{
+
+	}
+
+	/**
+	 * This method checks if the view can be read by linear index in row-major order.
+	 * @return true if the rows of the view are consecutive in the storage, false otherwise.
+	 */
+	bool isContiguous() const
+	{
+		return !_isTransposed && (_numOfCols == _originCols || _numOfRows == 1);
+	}
+
+	/**
+	 * This method reads a coordinate of the view.
+	 * @param row - the coordinate row.
+	 * @param column - the coordinate column.
+	 * @return the coordinate (row, column).
+	 */
+	const T& at(unsigned int row, unsigned int column) const
+	{
+		return _data[row * rowStride() + column * colStride()];
+	}
+
+	/**
+	 * This method reads a coordinate of a contiguous view by its row-major index.
+	 * @param index - the index.
+	 * @return the coordinate.
+	 */
+	const T& atIndex(std::size_t index) const
+	{
+		return _data[index];
+	}
+
+	/**
+	 * This method evaluates the view into the storage of a matrix.
+	 * @param destination - the row-major storage of a matrix of the dimensions of the view.
+	 */
+	void evaluateInto(T* destination) const
+	{
+		this->assignElementwise(destination);
+	}
+
+	/**
+	 * This method checks if the view is a view of the storage of a matrix.
+	 * @param data - the storage of the matrix.
+	 * @return true if the view refers to the storage, false otherwise.
+	 */
+	bool refersTo(const T* data) const
+	{
+		return _origin == data;
+	}
+
+	/**
+	 * This method checks if the view reads a region of the storage of a matrix.
+	 * @param region - the region.
+	 * @return true if the view and the region share coordinates, false otherwise.
+	 */
+	bool reads(const StorageRegion<T>& region) const
+	{
+		return this->region().intersects(region);
+	}
+
+	/**
+	 * This method returns the view as a GEMM operand, without copying it.
+	 * @return the view as a GEMM operand.
+	 */
+	StridedOperand<T> strided(std::vector<T>&) const
+	{
+		return {_data, rowStride(), colStride()};
+	}
+
+	/**
+	 * This method prints a view like a matrix.
+	 * @param os - the output stream reference.
+	 * @param view - the view we want to print.
+	 * @return the output stream reference.
+	 */
+	friend std :: ostream& operator<<(std :: ostream& os, const ConstMatrixView& view)
+	{
+		for(unsigned int row = 0 ; row < view._numOfRows ; ++row)
+		{
+			for(unsigned int col = 0 ; col < view._numOfCols ; ++col)
+			{
+				os << view.at(row, col);
+				os << SEPARATOR_OF_A_TAB;
+			}
+
+			os << '\n';
+
+		}
+
+		return os;
+
+	}
+
+	protected:
+
+	friend class MappedMatrix<T>;
+
+	/**
+	 * This constructor initializes a view of a block of the storage of a matrix.
+	 * @param data - the storage of coordinate (0, 0) of the view.
+	 * @param origin - the storage of the matrix.
+	 * @param originCols - number of columns of the matrix.
+	 * @param rows - number of rows of the view.
+	 * @param cols - number of columns of the view.
+	 * @param isTransposed - true if the rows of the view are columns of the matrix.
+	 */
+	ConstMatrixView(const T* data, const T* origin, unsigned int originCols, unsigned int rows,
+					unsigned int cols, bool isTransposed) : _data(data), _origin(origin),
+	_originCols(originCols), _numOfRows(rows), _numOfCols(cols), _isTransposed(isTransposed)
+	{
+
+	}
+
+	/**
+	 * This method checks if a coordinate is inside the view, unless MATRIX_BOUNDS_CHECK is 0.
+	 * @param row - the coordinate row.
+	 * @param column - the coordinate column.
+	 * @throw out of range exception of index out of bounds.
+	 */
+	void checkIndex(unsigned int row, unsigned int column) const
+	{
+#if MATRIX_BOUNDS_CHECK
+		if(!(column < _numOfCols && row < _numOfRows))
+		{
+			throw std :: out_of_range(INDEX_OUT_OF_BOUNDS_ERROR);
+		}
+#else
+		(void) row;
+		(void) column;
+#endif
+	}
+
+	/**
+	 * This method checks if a block is inside the view.
+	 * @param row - the first row of the block.
+	 * @param col - the first column of the block.
+	 * @param rows - number of rows of the block.
+	 * @param cols - number of columns of the block.
+	 * @throw out of range exception if the block is not inside the view.
+	 */
+	void checkBlock(unsigned int row, unsigned int col, unsigned int rows, unsigned int cols) const
+	{
+		if(rows > _numOfRows || row > _numOfRows - rows || cols > _numOfCols ||
+		   col > _numOfCols - cols)
+		{
+			throw std :: out_of_range(INDEX_OUT_OF_BOUNDS_ERROR);
+		}
+	}
+
+	/**
+	 * The storage of coordinate (0, 0) of the view.
+	 */
+	const T* _data;
+
+	/**
+	 * The storage of the matrix.
+	 */
+	const T* _origin;
+
+	/**
+	 * Number of columns of the matrix.
+	 */
+	unsigned int _originCols;
+
+	/**
+	 * Number of rows of the view.
+	 */
+	unsigned int _numOfRows;
+
+	/**
+	 * Number of columns of the view.
+	 */
+	unsigned int _numOfCols;
+
+	/**
+	 * True if the rows of the view are columns of the matrix.
+	 */
+	bool _isTransposed;
+
+};
+
+/**
+ * This class represents a view of a block of a matrix, possibly transposed, through which the
+ * block is written in place. Like a pointer, the view itself can be const while the coordinates
+ * are not. Assigning to a view (even another view) writes the coordinates; if the assigned
+ * expression reads the block, it is evaluated into a temporary matrix first.
+ * @tparam T - the generic type of a coordinate.
+ */
+template <class T> class MatrixView : public ConstMatrixView<T>
+{
+	public:
+
+	/**
+	 * This constructor views a whole matrix.
+	 * @tparam Allocator - the allocator of the matrix.
+	 * @tparam Order - the storage order of the matrix.
+	 * @param m - the matrix.
+	 */
+	template <class Allocator, StorageOrder Order>
+	explicit MatrixView(Matrix<T, Allocator, Order>& m) :
+	ConstMatrixView<T>(m)
+	{
+
+	}
+
+	/**
+	 * This is the copy constructor, the copy views the same block.
+	 * @param view - the view to copy.
+	 */
+	MatrixView(const MatrixView& view) = default;
+
+	/**
+	 * This method returns the storage of the first coordinate of the view.
+	 * @return the storage of coordinate (0, 0).
+	 */
+	T* data() const
+	{
+		return const_cast<T*>(this->_data);
+	}
+
+	/**
+	 * This method accesses a coordinate of the view.
+	 * @param row - the coordinate row
+	 * @param column - the coordinate column
+	 * @return view coordinate (row, column).
+	 * @throw out of range exception of index out of bounds.
+	 */
+	T& operator()(const unsigned int row, const unsigned int column) const
+	{
+		this->checkIndex(row, column);
+		return data()[row * this->rowStride() + column * this->colStride()];
+	}
+
+	/**
+	 * This method returns a view of a block of the view.
+	 * @param row - the first row of the block.
+	 * @param col - the first column of the block.
+	 * @param rows - number of rows of the block.
+	 * @param cols - number of columns of the block.
+	 * @return the view of the block.
+	 * @throw out of range exception if the block is not inside the view.
+	 */
+	MatrixView block(unsigned int row, unsigned int col, unsigned int rows,
+					 unsigned int cols) const
+	{
+		return MatrixView(ConstMatrixView<T>::block(row, col, rows, cols));
+	}
+
+	/**
+	 * This method returns a view of a row of the view.
+	 * @param row - the row.
+	 * @return the view of the row, a 1 * cols() view.
+	 * @throw out of range exception of index out of bounds.
+	 */
+	MatrixView row(unsigned int row) const
+	{
+		return MatrixView(ConstMatrixView<T>::row(row));
+	}
+
+	/**
+	 * This method returns a view of a column of the view.
+	 * @param col - the column.
+	 * @return the view of the column, a rows() * 1 view.
+	 * @throw out of range exception of index out of bounds.
+	 */
+	MatrixView col(unsigned int col) const
+	{
+		return MatrixView(ConstMatrixView<T>::col(col));
+	}
+
+	/**
+	 * This method returns the transposed view: the same storage with swapped strides.
+	 * @return the transposed view.
+	 */
+	MatrixView trans() const
+	{
+		return MatrixView(ConstMatrixView<T>::trans());
+	}
+
+	/**
+	 * This method copies the coordinates of another view into this view.
+	 * @param view - the view to copy.
+	 * @return a reference to this view.
+	 * @throw logic error exception if the dimensions do not suit each other.
+	 */
+	MatrixView& operator=(const MatrixView& view)
+	{
+		return *this = static_cast<const ConstMatrixView<T>&>(view);
+	}
+
+	/**
+	 * This method copies the coordinates of a matrix into this view.
+	 * @tparam Allocator - the allocator of the matrix.
+	 * @tparam Order - the storage order of the matrix.
+	 * @param m - the matrix.
+	 * @return a reference to this view.
+	 * @throw logic error exception if the dimensions do not suit each other.
+	 */
+	template <class Allocator, StorageOrder Order>
+	MatrixView& operator=(const Matrix<T, Allocator, Order>& m)
+	{
+		return *this = ConstMatrixView<T>(m);
+	}
+
+	/**
+	 * This method evaluates an expression into this view. A product is computed by a GEMM
+	 * directly into the block.
+	 * @tparam Expression - the type of the expression.
+	 * @param expression - the expression.
+	 * @return a reference to this view.
+	 * @throw logic error exception if the dimensions do not suit each other.
+	 */
+	template <class Expression> MatrixView& operator=(const MatrixExpression<T, Expression>&
+													  expression)
+	{
+		checkDimensions(expression);
+		if(expression.reads(this->region()))
+		{
+			return *this = ConstMatrixView<T>(Matrix<T>(expression));
+		}
+		if constexpr (IsProductExpression<Expression>::value)
+		{
+			expression.derived().multiplyInto(data(), this->rowStride(), this->colStride(), false);
+		}
+		else
+		{
+			combineElementwise(expression.derived(), [](T& coord, const T& value)
+			{
+				coord = value;
+			});
+		}
+		return *(this);
+	}
+
+	/**
+	 * This method adds a matrix to this view.
+	 * @tparam Allocator - the allocator of the matrix.
+	 * @tparam Order - the storage order of the matrix.
+	 * @param m - the matrix.
+	 * @return a reference to this view.
+	 * @throw logic error exception if the dimensions do not suit each other.
+	 */
+	template <class Allocator, StorageOrder Order>
+	MatrixView& operator+=(const Matrix<T, Allocator, Order>& m)
+	{
+		return *this += ConstMatrixView<T>(m);
+	}
+
+	/**
+	 * This method adds an expression to this view. A product is accumulated by a GEMM directly
+	 * into the block.
+	 * @tparam Expression - the type of the expression.
+	 * @param expression - the expression.
+	 * @return a reference to this view.
+	 * @throw logic error exception if the dimensions do not suit each other.
+	 */
+	template <class Expression> MatrixView& operator+=(const MatrixExpression<T, Expression>&
+													   expression)
+	{
+		checkDimensions(expression);
+		if(expression.reads(this->region()))
+		{
+			return *this += ConstMatrixView<T>(Matrix<T>(expression));
+		}
+		if constexpr (IsProductExpression<Expression>::value)
+		{
+			expression.derived().multiplyInto(data(), this->rowStride(), this->colStride(), true);
+		}
+		else
+		{
+			combineElementwise(expression.derived(), [](T& coord, const T& value)
+			{
+				coord = coord + value;
+			});
+		}
+		return *(this);
+	}
+
+	/**
+	 * This method subtracts a matrix from this view.
+	 * @tparam Allocator - the allocator of the matrix.
+	 * @tparam Order - the storage order of the matrix.
+	 * @param m - the matrix.
+	 * @return a reference to this view.
+	 * @throw logic error exception if the dimensions do not suit each other.
+	 */
+	template <class Allocator, StorageOrder Order>
+	MatrixView& operator-=(const Matrix<T, Allocator, Order>& m)
+	{
+		return *this -= ConstMatrixView<T>(m);
+	}
+
+	/**
+	 * This method subtracts an expression from this view. A product is subtracted without a
+	 * temporary, as -(-C + A * B): the GEMM only accumulates, and negation is exact.
+	 * @tparam Expression - the type of the expression.
+	 * @param expression - the expression.
+	 * @return a reference to this view.
+	 * @throw logic error exception if the dimensions do not suit each other.
+	 */
+	template <class Expression> MatrixView& operator-=(const MatrixExpression<T, Expression>&
+													   expression)
+	{
+		checkDimensions(expression);
+		if(expression.reads(this->region()))
+		{
+			return *this -= ConstMatrixView<T>(Matrix<T>(expression));
+		}
+		if constexpr (IsProductExpression<Expression>::value)
+		{
+			*this *= T(-1);
+			expression.derived().multiplyInto(data(), this->rowStride(), this->colStride(), true);
+			*this *= T(-1);
+		}
+		else
+		{
+			combineElementwise(expression.derived(), [](T& coord, const T& value)
+			{
+				coord = coord - value;
+			});
+		}
+		return *(this);
+	}
+
+	/**
+	 * This method multiplies the coordinates of this view by a scalar.
+	 * @param scalar - the scalar.
+	 * @return a reference to this view.
+	 */
+	MatrixView& operator*=(const T& scalar)
+	{
+		forEachCoordinate([&scalar](T& coord, unsigned int, unsigned int)
+		{
+			coord = coord * scalar;
+		});
+		return *(this);
+	}
+
+	/**
+	 * This method sets all the coordinates of this view to a value.
+	 * @param value - the value.
+	 */
+	void fill(const T& value) const
+	{
+		MatrixKernels<T>::fill(this->_numOfRows, this->_numOfCols, data(), this->rowStride(),
+							   this->colStride(), value);
+	}
+
+	private:
+
+	/**
+	 * This constructor turns a read-only view into a writable one. It is only used for the
+	 * blocks of a writable view.
+	 * @param view - the read-only view.
+	 */
+	explicit MatrixView(const ConstMatrixView<T>& view) : ConstMatrixView<T>(view)
+	{
+
+	}
+
+	/**
+	 * This method checks if the dimensions of an expression suit this view.
+	 * @tparam Expression - the type of the expression.
+	 * @param expression - the expression.
+	 * @throw logic error exception if the dimensions do not suit each other.
+	 */
+	template <class Expression>
+	void checkDimensions(const MatrixExpression<T, Expression>& expression) const
+	{
+		if(expression.rows() != this->_numOfRows || expression.cols() != this->_numOfCols)
+		{
+			throw std :: logic_error(INCOMPATIBLE_DIMENSIONS_OF_MATRICES_ERROR);
+		}
+	}
+
+	/**
+	 * This method calls a function on every coordinate of the view, row by row. Large views
+	 * run on the threads of the global thread pool.
+	 * @tparam Function - the type of the function.
+	 * @param function - called as function(coordinate, row, column).
+	 */
+	template <class Function> void forEachCoordinate(const Function& function) const
+	{
+		T* destination = data();
+		std::ptrdiff_t rowStride = this->rowStride(), colStride = this->colStride();
+		unsigned int numOfCols = this->_numOfCols;
+		unsigned int minimalRows = std::max(1u, PARALLEL_ELEMENTWISE_CHUNK /
+												std::max(numOfCols, 1u));
+		ThreadPool::instance().parallelRanges(this->_numOfRows, minimalRows,
+											  [&](std::size_t beginRow, std::size_t endRow)
+		{
+			for(std::size_t row = beginRow ; row < endRow ; ++row)
+			{
+				T* destinationRow = destination + row * rowStride;
+				for(unsigned int col = 0 ; col < numOfCols ; ++col)
+				{
+					function(destinationRow[col * colStride], (unsigned int) row, col);
+				}
+			}
+		});
+	}
+
+	/**
+	 * This method combines every coordinate of an element-wise expression with this view.
+	 * @tparam Expression - the type of the expression.
+	 * @tparam Combine - the type of the combine function.
+	 * @param expression - the expression, which does not read the view.
+	 * @param combine - called as combine(view coordinate, expression coordinate).
+	 */
+	template <class Expression, class Combine>
+	void combineElementwise(const Expression& expression, Combine combine) const
+	{
+		expression.prepare();
+		forEachCoordinate([&](T& coord, unsigned int row, unsigned int col)
+		{
+			combine(coord, expression.at(row, col));
+		});
+	}
+
+};
+
+/**
+ * This function returns a writable view of a whole matrix.
+ * @tparam T - the generic type of a coordinate.
+ * @tparam Allocator - the allocator of the matrix.
+ * @tparam Order - the storage order of the matrix.
+ * @param m - the matrix, which should outlive the view.
+ * @return the view of the matrix.
+ */
+template <class T, class Allocator, StorageOrder Order>
+MatrixView<T> view(Matrix<T, Allocator, Order>& m)
+{
+	return MatrixView<T>(m);
+}
+
+/**
+ * This function returns a read-only view of a whole matrix.
+ * @tparam T - the generic type of a coordinate.
+ * @tparam Allocator - the allocator of the matrix.
+ * @tparam Order - the storage order of the matrix.
+ * @param m - the matrix, which should outlive the view.
+ * @return the view of the matrix.
+ */
+template <class T, class Allocator, StorageOrder Order>
+ConstMatrixView<T> view(const Matrix<T, Allocator, Order>& m)
+{
+	return ConstMatrixView<T>(m);
+}
+
+/**
+ * A view of a temporary matrix would dangle at the end of the statement.
+ */
+template <class T, class Allocator, StorageOrder Order>
+void view(const Matrix<T, Allocator, Order>&& m) = delete;
+
+#endif
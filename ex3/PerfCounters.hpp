@@ -0,0 +1,663 @@
+//================================ Includes =====================================================
+#include "Complex.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#ifdef __linux__
+#include <dirent.h>
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+//================================ Constants ====================================================
+#ifndef CPP3_PERF_COUNTERS_H
+#define CPP3_PERF_COUNTERS_H
+#ifndef MATRIX_PERF_COUNTERS
+#define MATRIX_PERF_COUNTERS 0
+#endif
+#if MATRIX_PERF_COUNTERS
+#define MATRIX_PERF_SCOPE(operation, flops) PerfScope perfScope(operation, flops)
+#else
+#define MATRIX_PERF_SCOPE(operation, flops)
+#endif
+#define PERF_NUM_OF_COUNTERS 6
+#define PERF_UNAVAILABLE_COUNT (-1.0)
+#define PERF_CLOSED_DESCRIPTOR (-1)
+#define PERF_THREADS_DIRECTORY "/proc/self/task"
+#define PERF_THREADS_REFRESH_PERIOD std :: chrono :: milliseconds(10)
+//================================ Code Segment =================================================
+
+/**
+ * This file adds hardware performance counters (Linux perf_event_open) to the Matrix<T>
+ * operations. The counters of a thread only count its own work, so PerfCounters opens them for
+ * every thread of the process (the ones of the global thread pool included) and sums them:
+ * the counts of an operation are those of the whole process while it runs. They count user
+ * space only, which perf_event_open allows without privileges (perf_event_paranoid <= 2).
+ * A counter which cannot be opened - no PMU in a virtual machine, a stricter paranoid level,
+ * another system than Linux - is reported as unavailable, and the others still work; the
+ * task clock is a software counter, so it is available almost everywhere.
+ * Listing the threads is far slower than reading the counters, so it is done only when a thread
+ * of the library starts or ends (see PerfCounters::threadsChanged) and every
+ * PERF_THREADS_REFRESH_PERIOD for the threads which the library does not own.
+ * The operations of Matrix<T> record themselves when the library is compiled with
+ * MATRIX_PERF_COUNTERS=1, and PerfScope measures any other code the same way.
+ */
+
+/**
+ * This enum represents the counters, in the order of PerfCounts::values.
+ */
+enum class PerfCounter
+{
+	Cycles,
+	Instructions,
+	L1DataMisses,
+	LastLevelCacheMisses,
+	BranchMisses,
+	TaskClockNanoseconds
+};
+
+/**
+ * This struct holds the number of floating point operations (of integer operations, for
+ * integer types) of the elementwise operations of T. They are counted from the dimensions of
+ * every operation, since the hardware has no portable FLOP counter.
+ * @tparam T - the generic type of a coordinate.
+ */
+template <class T> struct FlopsOf
+{
+	static constexpr double ADD = 1;
+	static constexpr double MULTIPLY = 1;
+	static constexpr double MULTIPLY_ADD = 2;
+};
+
+template <> struct FlopsOf<Complex>
+{
+	static constexpr double ADD = 2;
+	static constexpr double MULTIPLY = 6;
+	static constexpr double MULTIPLY_ADD = 8;
+};
+
+/**
+ * This struct holds the counts of an operation (or the sum of several calls of it).
+ */
+struct PerfCounts
+{
+	/**
+	 * The counts, indexed by PerfCounter; PERF_UNAVAILABLE_COUNT for unavailable counters.
+	 */
+	std :: array<double, PERF_NUM_OF_COUNTERS> values;
+
+	/**
+	 * The number of floating point operations.
+	 */
+	double flops;
+
+	/**
+	 * The number of calls which were counted.
+	 */
+	std :: uint64_t calls;
+
+	/**
+	 * This constructor initializes zero counts.
+	 */
+	PerfCounts() : flops(0), calls(0)
+	{
+		values.fill(0);
+	}
+
+	/**
+	 * This method checks if a counter is available.
+	 * @param counter - the counter.
+	 * @return true if the counter is available.
+	 */
+	bool isAvailable(PerfCounter counter) const
+	{
+		return values[(std :: size_t) counter] >= 0;
+	}
+
+	/**
+	 * This method returns a count.
+	 * @param counter - the counter.
+	 * @return the count, or PERF_UNAVAILABLE_COUNT.
+	 */
+	double operator[](PerfCounter counter) const
+	{
+		return values[(std :: size_t) counter];
+	}
+
+	/**
+	 * This method adds counts to these ones. A counter is unavailable if it is unavailable in
+	 * either of them.
+	 * @param other - the counts.
+	 * @return these counts.
+	 */
+	PerfCounts& operator+=(const PerfCounts& other)
+	{
+		for(std :: size_t index = 0 ; index < PERF_NUM_OF_COUNTERS ; ++index)
+		{
+			values[index] = values[index] < 0 || other.values[index] < 0 ?
+							PERF_UNAVAILABLE_COUNT : values[index] + other.values[index];
+		}
+		flops += other.flops;
+		calls += other.calls;
+		return *(this);
+	}
+
+	/**
+	 * This method returns the counts between two readings of PerfCounters::read.
+	 * @param start - the earlier reading.
+	 * @return the counts from start to this reading.
+	 */
+	PerfCounts operator-(const PerfCounts& start) const
+	{
+		PerfCounts result;
+		for(std :: size_t index = 0 ; index < PERF_NUM_OF_COUNTERS ; ++index)
+		{
+			result.values[index] = values[index] < 0 || start.values[index] < 0 ?
+								   PERF_UNAVAILABLE_COUNT : values[index] - start.values[index];
+		}
+		result.flops = flops - start.flops;
+		result.calls = calls - start.calls;
+		return result;
+	}
+
+	/**
+	 * This method returns the average counts of a call.
+	 * @return the counts divided by the number of calls.
+	 */
+	PerfCounts perCall() const
+	{
+		PerfCounts result(*this);
+		if(calls > 1)
+		{
+			for(double& value : result.values)
+			{
+				value = value < 0 ? PERF_UNAVAILABLE_COUNT : value / calls;
+			}
+			result.flops /= calls;
+			result.calls = 1;
+		}
+		return result;
+	}
+
+	/**
+	 * This method returns the instructions per cycle.
+	 * @return the instructions per cycle, or PERF_UNAVAILABLE_COUNT.
+	 */
+	double instructionsPerCycle() const
+	{
+		double cycles = (*this)[PerfCounter::Cycles];
+		double instructions = (*this)[PerfCounter::Instructions];
+		return cycles > 0 && instructions >= 0 ? instructions / cycles : PERF_UNAVAILABLE_COUNT;
+	}
+
+	/**
+	 * This method returns the floating point operations per cycle.
+	 * @return the floating point operations per cycle, or PERF_UNAVAILABLE_COUNT.
+	 */
+	double flopsPerCycle() const
+	{
+		double cycles = (*this)[PerfCounter::Cycles];
+		return cycles > 0 ? flops / cycles : PERF_UNAVAILABLE_COUNT;
+	}
+
+	/**
+	 * This method returns the name of a counter.
+	 * @param counter - the counter.
+	 * @return the name, in snake case.
+	 */
+	static const char* nameOf(PerfCounter counter)
+	{
+		static const char* const names[PERF_NUM_OF_COUNTERS] = {"cycles", "instructions",
+																 "l1d_misses", "llc_misses",
+																 "branch_misses",
+																 "task_clock_ns"};
+		return names[(std :: size_t) counter];
+	}
+};
+
+/**
+ * This class owns the counters of all the threads of the process and the counts recorded by
+ * the operations. All the methods are thread safe.
+ */
+class PerfCounters
+{
+	public:
+
+	/**
+	 * This method returns the counters of the process.
+	 * @return the counters of the process.
+	 */
+	static PerfCounters& instance()
+	{
+		static PerfCounters counters;
+		return counters;
+	}
+
+	/**
+	 * This destructor closes the counters.
+	 */
+	~PerfCounters()
+	{
+#ifdef __linux__
+		for(auto& thread : _threads)
+		{
+			for(int descriptor : thread.second)
+			{
+				if(descriptor != PERF_CLOSED_DESCRIPTOR)
+				{
+					close(descriptor);
+				}
+			}
+		}
+#endif
+	}
+
+	PerfCounters(const PerfCounters&) = delete;
+
+	PerfCounters& operator=(const PerfCounters&) = delete;
+
+	/**
+	 * This method checks if a counter could be opened.
+	 * @param counter - the counter.
+	 * @return true if the counter is available.
+	 */
+	bool isAvailable(PerfCounter counter) const
+	{
+		return _isAvailable[(std :: size_t) counter];
+	}
+
+	/**
+	 * This method checks if any counter could be opened.
+	 * @return true if a counter is available.
+	 */
+	bool isSupported() const
+	{
+		for(bool isAvailable : _isAvailable)
+		{
+			if(isAvailable)
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	/**
+	 * This method checks if PerfScope measures and records.
+	 * @return true if the recording is enabled.
+	 */
+	bool isEnabled() const
+	{
+		return _isEnabled;
+	}
+
+	/**
+	 * This method enables or disables the recording of PerfScope (enabled by default).
+	 * @param isEnabled - true to enable the recording.
+	 */
+	void setEnabled(bool isEnabled)
+	{
+		_isEnabled = isEnabled;
+	}
+
+	/**
+	 * This method tells the counters that a thread of the process started or ended, so the next
+	 * read updates the set of counted threads. It does not open the counters if they are not.
+	 */
+	static void threadsChanged()
+	{
+		areThreadsChanged() = true;
+	}
+
+	/**
+	 * This method reads the counts of the process since the counters were opened: the sum of the
+	 * counters of all its threads, scaled up if the kernel multiplexed them, and the final
+	 * counts of the threads which ended. The set of threads is updated first if a thread
+	 * started or ended since the last update, or if PERF_THREADS_REFRESH_PERIOD passed.
+	 * @return the counts, with zero flops and calls.
+	 */
+	PerfCounts read()
+	{
+		PerfCounts result;
+		std :: lock_guard<std :: mutex> lock(_mutex);
+		std :: chrono :: steady_clock :: time_point now = std :: chrono :: steady_clock :: now();
+		// the flag is cleared before the update, so a thread which starts during it is not missed
+		if(areThreadsChanged().exchange(false) || now - _lastUpdate >= PERF_THREADS_REFRESH_PERIOD)
+		{
+			updateThreads();
+			_lastUpdate = now;
+		}
+		for(std :: size_t index = 0 ; index < PERF_NUM_OF_COUNTERS ; ++index)
+		{
+			result.values[index] = _isAvailable[index] ? _countsOfEndedThreads[index] :
+								   PERF_UNAVAILABLE_COUNT;
+		}
+#ifdef __linux__
+		for(const auto& thread : _threads)
+		{
+			for(std :: size_t index = 0 ; index < PERF_NUM_OF_COUNTERS ; ++index)
+			{
+				if(thread.second[index] != PERF_CLOSED_DESCRIPTOR)
+				{
+					result.values[index] += readScaled(thread.second[index]);
+				}
+			}
+		}
+#endif
+		return result;
+	}
+
+	/**
+	 * This method adds the counts of a call to the report of an operation.
+	 * @param operation - the name of the operation.
+	 * @param counts - the counts of the call.
+	 */
+	void record(const std :: string& operation, const PerfCounts& counts)
+	{
+		std :: lock_guard<std :: mutex> lock(_mutex);
+		auto found = _report.find(operation);
+		if(found == _report.end())
+		{
+			_report.emplace(operation, counts);
+		}
+		else
+		{
+			found->second += counts;
+		}
+	}
+
+	/**
+	 * This method returns the recorded counts of every operation, summed over its calls.
+	 * @return the counts by the name of the operation.
+	 */
+	std :: map<std :: string, PerfCounts> report() const
+	{
+		std :: lock_guard<std :: mutex> lock(_mutex);
+		return _report;
+	}
+
+	/**
+	 * This method clears the recorded counts.
+	 */
+	void reset()
+	{
+		std :: lock_guard<std :: mutex> lock(_mutex);
+		_report.clear();
+	}
+
+	private:
+
+	/**
+	 * This constructor probes every counter on the calling thread: the ones which cannot be
+	 * opened stay unavailable for all the threads.
+	 */
+	PerfCounters() : _lastUpdate(std :: chrono :: steady_clock :: now()), _isEnabled(true)
+	{
+		_isAvailable.fill(false);
+		_countsOfEndedThreads.fill(0);
+#ifdef __linux__
+		std :: array<int, PERF_NUM_OF_COUNTERS> descriptors;
+		pid_t thread = (pid_t) syscall(SYS_gettid);
+		for(std :: size_t index = 0 ; index < PERF_NUM_OF_COUNTERS ; ++index)
+		{
+			descriptors[index] = open((PerfCounter) index, thread);
+			_isAvailable[index] = descriptors[index] != PERF_CLOSED_DESCRIPTOR;
+		}
+		_threads.emplace(thread, descriptors);
+#endif
+		// the threads which started before the counters are attached at the first read
+		threadsChanged();
+	}
+
+	/**
+	 * This method returns the flag which tells that a thread started or ended since the last
+	 * update of the counted threads.
+	 * @return a reference to the flag.
+	 */
+	static std :: atomic<bool>& areThreadsChanged()
+	{
+		static std :: atomic<bool> threadsChanged(true);
+		return threadsChanged;
+	}
+
+#ifdef __linux__
+	/**
+	 * This method opens a user space counter of a thread.
+	 * @param counter - the counter.
+	 * @param thread - the id of the thread.
+	 * @return the file descriptor of the counter, or PERF_CLOSED_DESCRIPTOR.
+	 */
+	static int open(PerfCounter counter, pid_t thread)
+	{
+		perf_event_attr attributes;
+		std :: memset(&attributes, 0, sizeof(attributes));
+		attributes.size = sizeof(attributes);
+		attributes.exclude_kernel = 1;
+		attributes.exclude_hv = 1;
+		attributes.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+		switch(counter)
+		{
+			case PerfCounter::Cycles:
+				attributes.type = PERF_TYPE_HARDWARE;
+				attributes.config = PERF_COUNT_HW_CPU_CYCLES;
+				break;
+			case PerfCounter::Instructions:
+				attributes.type = PERF_TYPE_HARDWARE;
+				attributes.config = PERF_COUNT_HW_INSTRUCTIONS;
+				break;
+			case PerfCounter::L1DataMisses:
+				attributes.type = PERF_TYPE_HW_CACHE;
+				attributes.config = PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+									(PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+				break;
+			case PerfCounter::LastLevelCacheMisses:
+				attributes.type = PERF_TYPE_HARDWARE;
+				attributes.config = PERF_COUNT_HW_CACHE_MISSES;
+				break;
+			case PerfCounter::BranchMisses:
+				attributes.type = PERF_TYPE_HARDWARE;
+				attributes.config = PERF_COUNT_HW_BRANCH_MISSES;
+				break;
+			case PerfCounter::TaskClockNanoseconds:
+				attributes.type = PERF_TYPE_SOFTWARE;
+				attributes.config = PERF_COUNT_SW_TASK_CLOCK;
+				break;
+		}
+		long descriptor = syscall(SYS_perf_event_open, &attributes, thread, -1, -1, 0);
+		return descriptor < 0 ? PERF_CLOSED_DESCRIPTOR : (int) descriptor;
+	}
+
+	/**
+	 * This method reads a counter, scaled by the fraction of the time it was scheduled.
+	 * @param descriptor - the file descriptor of the counter.
+	 * @return the count.
+	 */
+	static double readScaled(int descriptor)
+	{
+		std :: uint64_t buffer[3];
+		if(::read(descriptor, buffer, sizeof(buffer)) != (ssize_t) sizeof(buffer) || buffer[2] == 0)
+		{
+			return 0;
+		}
+		return buffer[2] == buffer[1] ? (double) buffer[0] :
+			   (double) buffer[0] * ((double) buffer[1] / (double) buffer[2]);
+	}
+#endif
+
+	/**
+	 * This method updates the counted threads to the threads of the process: the final counts
+	 * of the threads which ended since the last call are added to _countsOfEndedThreads and
+	 * their counters are closed (so a thread id which the kernel reuses is attached again),
+	 * then the available counters of the threads which started are opened. The caller holds
+	 * the mutex.
+	 */
+	void updateThreads()
+	{
+#ifdef __linux__
+		if(!isSupported())
+		{
+			return;
+		}
+		DIR* directory = opendir(PERF_THREADS_DIRECTORY);
+		if(directory == nullptr)
+		{
+			return;
+		}
+		std :: set<pid_t> runningThreads;
+		while(dirent* entry = readdir(directory))
+		{
+			if(entry->d_name[0] >= '0' && entry->d_name[0] <= '9')
+			{
+				runningThreads.insert((pid_t) std :: strtol(entry->d_name, nullptr, 10));
+			}
+		}
+		closedir(directory);
+		for(auto thread = _threads.begin() ; thread != _threads.end() ; )
+		{
+			if(runningThreads.count((pid_t) thread->first) != 0)
+			{
+				++thread;
+				continue;
+			}
+			for(std :: size_t index = 0 ; index < PERF_NUM_OF_COUNTERS ; ++index)
+			{
+				if(thread->second[index] != PERF_CLOSED_DESCRIPTOR)
+				{
+					_countsOfEndedThreads[index] += readScaled(thread->second[index]);
+					close(thread->second[index]);
+				}
+			}
+			thread = _threads.erase(thread);
+		}
+		for(pid_t thread : runningThreads)
+		{
+			if(_threads.find(thread) != _threads.end())
+			{
+				continue;
+			}
+			std :: array<int, PERF_NUM_OF_COUNTERS> descriptors;
+			for(std :: size_t index = 0 ; index < PERF_NUM_OF_COUNTERS ; ++index)
+			{
+				descriptors[index] = _isAvailable[index] ? open((PerfCounter) index, thread) :
+									 PERF_CLOSED_DESCRIPTOR;
+			}
+			_threads.emplace(thread, descriptors);
+		}
+#endif
+	}
+
+	/**
+	 * The mutex which guards the counters and the report.
+	 */
+	mutable std :: mutex _mutex;
+
+	/**
+	 * Whether every counter could be opened.
+	 */
+	std :: array<bool, PERF_NUM_OF_COUNTERS> _isAvailable;
+
+	/**
+	 * The file descriptors of the counters of every running thread.
+	 */
+	std :: map<long, std :: array<int, PERF_NUM_OF_COUNTERS>> _threads;
+
+	/**
+	 * The sum of the final counts of the threads which ended.
+	 */
+	std :: array<double, PERF_NUM_OF_COUNTERS> _countsOfEndedThreads;
+
+	/**
+	 * The time of the last update of the counted threads.
+	 */
+	std :: chrono :: steady_clock :: time_point _lastUpdate;
+
+	/**
+	 * The recorded counts of every operation.
+	 */
+	std :: map<std :: string, PerfCounts> _report;
+
+	/**
+	 * Whether PerfScope measures and records.
+	 */
+	std :: atomic<bool> _isEnabled;
+};
+
+/**
+ * This class measures the counts of the process during its lifetime and records them, with a
+ * number of floating point operations, under the name of an operation (see
+ * PerfCounters::report). It does nothing while the recording is disabled.
+ */
+class PerfScope
+{
+	public:
+
+	/**
+	 * This constructor starts a measurement.
+	 * @param operation - the name of the operation; a string literal, since it is kept.
+	 * @param flops - the number of floating point operations of the operation.
+	 */
+	PerfScope(const char* operation, double flops) : _operation(operation), _flops(flops),
+	_isActive(PerfCounters::instance().isEnabled())
+	{
+		if(_isActive)
+		{
+			_start = PerfCounters::instance().read();
+		}
+	}
+
+	/**
+	 * This destructor ends the measurement and records it.
+	 */
+	~PerfScope()
+	{
+		if(!_isActive)
+		{
+			return;
+		}
+		try
+		{
+			PerfCounts counts = PerfCounters::instance().read() - _start;
+			counts.flops = _flops;
+			counts.calls = 1;
+			PerfCounters::instance().record(_operation, counts);
+		}
+		catch(...)
+		{
+			// a measurement which cannot be recorded is dropped, never thrown from a destructor
+		}
+	}
+
+	PerfScope(const PerfScope&) = delete;
+
+	PerfScope& operator=(const PerfScope&) = delete;
+
+	private:
+
+	/**
+	 * The name of the operation, under which the counts are recorded.
+	 */
+	const char* _operation;
+
+	/**
+	 * The number of floating point operations of the operation.
+	 */
+	double _flops;
+
+	/**
+	 * Whether the recording was enabled when the measurement started.
+	 */
+	bool _isActive;
+
+	/**
+	 * The counts of the process when the measurement started.
+	 */
+	PerfCounts _start;
+};
+
+#endif
@@ -0,0 +1,324 @@
+//================================ Includes =====================================================
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <new>
+#include <unordered_map>
+#include <vector>
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+//================================ Constants ====================================================
+#ifndef CPP3_POOLED_ALLOCATOR_H
+#define CPP3_POOLED_ALLOCATOR_H
+#define POOL_ALIGNMENT 64
+#define POOL_HUGE_PAGE_BYTES ((std::size_t) 1 << 21)
+#define POOL_SIZE_CLASS_STEPS 8
+#define POOL_DEFAULT_MAXIMAL_CACHED_BYTES ((std::size_t) 1 << 28)
+//================================ Code Segment =================================================
+
+/**
+ * This class represents the global pool of memory blocks behind PooledAllocator. Every block is
+ * aligned to a cache line (64 bytes, the widest SIMD vector) - but not further, since blocks
+ * aligned to the same huge page boundary would compete for the same cache sets. The sizes are
+ * rounded up to size classes - 4 classes per doubling, so at most a quarter of a block is
+ * wasted - and a freed block is kept in the free list of its class, so the next allocation of
+ * the same class (like the temporary of every iteration of an iterative algorithm) reuses it
+ * without a system call or page faults.
+ * The pool keeps up to maximalCachedBytes() in its free lists and returns the rest to the system.
+ * All the methods are thread safe.
+ */
+class MemoryPool
+{
+	public:
+
+	/**
+	 * This method returns the global memory pool.
+	 * @return the global memory pool.
+	 */
+	static MemoryPool& instance()
+	{
+		static MemoryPool pool;
+		return pool;
+	}
+
+	/**
+	 * This destructor returns the cached blocks to the system.
+	 */
+	~MemoryPool()
+	{
+		release();
+	}
+
+	MemoryPool(const MemoryPool&) = delete;
+
+	MemoryPool& operator=(const MemoryPool&) = delete;
+
+	/**
+	 * This method allocates a block, from the free list of its size class if possible.
+	 * @param bytes - the size of the block.
+	 * @return the block, aligned to POOL_ALIGNMENT bytes.
+	 * @throw bad alloc exception if the system is out of memory.
+	 */
+	void* allocate(std::size_t bytes)
+	{
+		std::size_t classBytes = classBytesOf(bytes);
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			auto freeList = _freeLists.find(classBytes);
+			if(freeList != _freeLists.end() && !freeList->second.empty())
+			{
+				void* block = freeList->second.back();
+				freeList->second.pop_back();
+				_cachedBytes -= classBytes;
+				return block;
+			}
+		}
+		void* block = ::operator new(classBytes, std::align_val_t(POOL_ALIGNMENT));
+#ifdef MADV_HUGEPAGE
+		if(classBytes >= 2 * POOL_HUGE_PAGE_BYTES && _isUsingHugePages)
+		{
+			// only the huge pages which are entirely inside the block can back it
+			std::uintptr_t begin = (reinterpret_cast<std::uintptr_t>(block) + POOL_HUGE_PAGE_BYTES -
+									1) & ~(std::uintptr_t) (POOL_HUGE_PAGE_BYTES - 1);
+			std::uintptr_t end = (reinterpret_cast<std::uintptr_t>(block) + classBytes) &
+								 ~(std::uintptr_t) (POOL_HUGE_PAGE_BYTES - 1);
+			madvise(reinterpret_cast<void*>(begin), end - begin, MADV_HUGEPAGE);
+		}
+#endif
+		return block;
+	}
+
+	/**
+	 * This method frees a block: it is kept in the free list of its size class, unless the pool
+	 * is full.
+	 * @param block - the block.
+	 * @param bytes - the size of the block, as it was allocated.
+	 */
+	void deallocate(void* block, std::size_t bytes) noexcept
+	{
+		std::size_t classBytes = classBytesOf(bytes);
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			if(_cachedBytes + classBytes <= _maximalCachedBytes)
+			{
+				try
+				{
+					_freeLists[classBytes].push_back(block);
+					_cachedBytes += classBytes;
+					return;
+				}
+				catch(const std::bad_alloc&)
+				{
+					// the free list could not grow, so the block goes back to the system
+				}
+			}
+		}
+		::operator delete(block, std::align_val_t(POOL_ALIGNMENT));
+	}
+
+	/**
+	 * This method returns all the cached blocks to the system.
+	 */
+	void release()
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		for(auto& freeList : _freeLists)
+		{
+			for(void* block : freeList.second)
+			{
+				::operator delete(block, std::align_val_t(POOL_ALIGNMENT));
+			}
+		}
+		_freeLists.clear();
+		_cachedBytes = 0;
+	}
+
+	/**
+	 * This method returns the number of bytes in the free lists.
+	 * @return the number of cached bytes.
+	 */
+	std::size_t cachedBytes() const
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		return _cachedBytes;
+	}
+
+	/**
+	 * This method returns the maximal number of bytes in the free lists.
+	 * @return the maximal number of cached bytes.
+	 */
+	std::size_t maximalCachedBytes() const
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		return _maximalCachedBytes;
+	}
+
+	/**
+	 * This method sets the maximal number of bytes in the free lists. Cached blocks are
+	 * released if needed.
+	 * @param maximalCachedBytes - the maximal number of cached bytes, 0 to disable the caching.
+	 */
+	void setMaximalCachedBytes(std::size_t maximalCachedBytes)
+	{
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_maximalCachedBytes = maximalCachedBytes;
+			if(_cachedBytes <= _maximalCachedBytes)
+			{
+				return;
+			}
+		}
+		release();
+	}
+
+	/**
+	 * This method returns whether new blocks of at least two huge pages are backed by
+	 * transparent huge pages.
+	 * @return true if huge pages are used.
+	 */
+	bool isUsingHugePages() const
+	{
+		return _isUsingHugePages;
+	}
+
+	/**
+	 * This method sets whether new blocks of at least two huge pages are backed by transparent
+	 * huge pages, which saves TLB misses in the products of large matrices. It has no effect where
+	 * transparent huge pages are not supported.
+	 * @param isUsingHugePages - true to use huge pages.
+	 */
+	void useHugePages(bool isUsingHugePages)
+	{
+		_isUsingHugePages = isUsingHugePages;
+	}
+
+	private:
+
+	/**
+	 * This constructor initializes an empty pool.
+	 */
+	MemoryPool() : _cachedBytes(0), _maximalCachedBytes(POOL_DEFAULT_MAXIMAL_CACHED_BYTES),
+	_isUsingHugePages(false)
+	{
+
+	}
+
+	/**
+	 * This method rounds a size up to its size class: a multiple of POOL_ALIGNMENT, with
+	 * POOL_SIZE_CLASS_STEPS / 2 to POOL_SIZE_CLASS_STEPS steps of a power of two.
+	 * @param bytes - the size.
+	 * @return the size of the class.
+	 */
+	static std::size_t classBytesOf(std::size_t bytes)
+	{
+		std::size_t units = std::max<std::size_t>((bytes + POOL_ALIGNMENT - 1) / POOL_ALIGNMENT,
+												  1);
+		std::size_t step = 1;
+		while(units > step * POOL_SIZE_CLASS_STEPS)
+		{
+			step <<= 1;
+		}
+		return (units + step - 1) / step * step * POOL_ALIGNMENT;
+	}
+
+	/**
+	 * The mutex which guards the free lists.
+	 */
+	mutable std::mutex _mutex;
+
+	/**
+	 * The free blocks of every size class.
+	 */
+	std::unordered_map<std::size_t, std::vector<void*>> _freeLists;
+
+	/**
+	 * The number of bytes in the free lists.
+	 */
+	std::size_t _cachedBytes;
+
+	/**
+	 * The maximal number of bytes in the free lists.
+	 */
+	std::size_t _maximalCachedBytes;
+
+	/**
+	 * Whether new blocks of at least two huge pages are backed by huge pages.
+	 */
+	std::atomic<bool> _isUsingHugePages;
+};
+
+/**
+ * This class represents a standard allocator which allocates from the global MemoryPool, so
+ * its blocks are aligned to 64 bytes and recycled between containers of the same size class.
+ * It is the default storage allocator of Matrix<T>.
+ * @tparam T - the type of the allocated objects.
+ */
+template <class T> class PooledAllocator
+{
+	public:
+
+	typedef T value_type;
+
+	/**
+	 * This is the default constructor. The allocator has no state.
+	 */
+	PooledAllocator() noexcept = default;
+
+	/**
+	 * This constructor converts an allocator of another type.
+	 */
+	template <class U> PooledAllocator(const PooledAllocator<U>&) noexcept
+	{
+
+	}
+
+	/**
+	 * This method allocates storage for objects.
+	 * @param n - the number of objects.
+	 * @return the storage.
+	 * @throw bad array new length exception if the size overflows.
+	 * @throw bad alloc exception if the system is out of memory.
+	 */
+	T* allocate(std::size_t n)
+	{
+		if(n > std::numeric_limits<std::size_t>::max() / sizeof(T))
+		{
+			throw std::bad_array_new_length();
+		}
+		return static_cast<T*>(MemoryPool::instance().allocate(n * sizeof(T)));
+	}
+
+	/**
+	 * This method frees storage for objects.
+	 * @param p - the storage.
+	 * @param n - the number of objects, as it was allocated.
+	 */
+	void deallocate(T* p, std::size_t n) noexcept
+	{
+		MemoryPool::instance().deallocate(p, n * sizeof(T));
+	}
+
+	/**
+	 * This method compares two allocators. All of them share the global pool.
+	 * @return true.
+	 */
+	template <class U> bool operator==(const PooledAllocator<U>&) const noexcept
+	{
+		return true;
+	}
+
+	/**
+	 * This method compares two allocators. All of them share the global pool.
+	 * @return false.
+	 */
+	template <class U> bool operator!=(const PooledAllocator<U>&) const noexcept
+	{
+		return false;
+	}
+};
+
+#endif
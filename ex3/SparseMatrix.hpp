@@ -0,0 +1,628 @@
+//================================ Includes =====================================================
+#include "ElementwiseKernels.hpp"
+#include "Matrix.hpp"
+#include "ThreadPool.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <numeric>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+//================================ Constants ====================================================
+#ifndef CPP3_SPARSE_MATRIX_H
+#define CPP3_SPARSE_MATRIX_H
+#define SPARSE_PARALLEL_NON_ZEROS (1 << 14)
+#define SPARSE_PARALLEL_DENSE_COLS 64
+//================================ Code Segment =================================================
+
+/**
+ * This enum represents the layout of a sparse matrix: compressed rows (CSR), where the non zero
+ * coordinates are stored row by row, or compressed columns (CSC), column by column.
+ */
+enum class SparseLayout
+{
+	Csr,
+	Csc
+};
+
+/**
+ * This class represents a generic sparse matrix, which stores only its non zero coordinates.
+ * In the CSR layout the major index is the row and the minor index is the column, in the CSC
+ * layout it is the other way around. The coordinates of major index i are stored in
+ * [offsets[i], offsets[i + 1]) of the minor indices and the values, sorted by their minor index.
+ * Products with a dense vector (SpMV) or a dense Matrix<T> (SpMM) only touch the non zero
+ * coordinates, and large ones run on the threads of the global thread pool.
+ * @tparam T - the generic type of a coordinate (with the same assumptions as in Matrix<T>).
+ */
+template <class T> class SparseMatrix
+{
+	public:
+
+	/**
+	 * This struct represents a coordinate of a sparse matrix, for building one.
+	 */
+	struct Triplet
+	{
+		unsigned int row;
+		unsigned int col;
+		T value;
+	};
+
+	/**
+	 * This constructor initializes a sparse matrix of zeros.
+	 * @param rows - number of rows in the matrix.
+	 * @param cols - number of columns in the matrix.
+	 * @param layout - the layout of the matrix.
+	 * @throw invalid argument error if not positive.
+	 */
+	SparseMatrix(unsigned int rows, unsigned int cols, SparseLayout layout = SparseLayout::Csr) :
+	_numOfRows(rows), _numOfCols(cols), _layout(layout)
+	{
+		checkPositiveRowAndColNumber();
+		_offsets.assign(numOfMajors() + 1, 0);
+	}
+
+	/**
+	 * This constructor initializes a sparse matrix from its coordinates, in any order.
+	 * Coordinates which appear more than once are summed, and zero sums are not stored.
+	 * @param rows - number of rows in the matrix.
+	 * @param cols - number of columns in the matrix.
+	 * @param triplets - the coordinates.
+	 * @param layout - the layout of the matrix.
+	 * @throw invalid argument error if not positive.
+	 * @throw out of range exception if a coordinate is out of the matrix.
+	 */
+	SparseMatrix(unsigned int rows, unsigned int cols, const std :: vector<Triplet>& triplets,
+				 SparseLayout layout = SparseLayout::Csr) : SparseMatrix(rows, cols, layout)
+	{
+		std :: vector<std :: size_t> counts(numOfMajors() + 1, 0);
+		for(const Triplet& triplet : triplets)
+		{
+			if(!(triplet.row < _numOfRows && triplet.col < _numOfCols))
+			{
+				throw std :: out_of_range(INDEX_OUT_OF_BOUNDS_ERROR);
+			}
+			++counts[majorOf(triplet.row, triplet.col) + 1];
+		}
+		std :: partial_sum(counts.begin(), counts.end(), counts.begin());
+		// bucket the coordinates by major index, then sort and merge every bucket
+		std :: vector<std :: pair<unsigned int, T>> buckets(triplets.size());
+		std :: vector<std :: size_t> next(counts.begin(), counts.end() - 1);
+		for(const Triplet& triplet : triplets)
+		{
+			buckets[next[majorOf(triplet.row, triplet.col)]++] =
+					std :: make_pair(minorOf(triplet.row, triplet.col), triplet.value);
+		}
+		_indices.reserve(triplets.size());
+		_values.reserve(triplets.size());
+		for(unsigned int major = 0 ; major < numOfMajors() ; ++major)
+		{
+			auto begin = buckets.begin() + counts[major], end = buckets.begin() + counts[major + 1];
+			std :: stable_sort(begin, end, [](const std :: pair<unsigned int, T>& left,
+											  const std :: pair<unsigned int, T>& right)
+			{
+				return left.first < right.first;
+			});
+			while(begin != end)
+			{
+				unsigned int minor = begin->first;
+				T value = begin->second;
+				for(++begin ; begin != end && begin->first == minor ; ++begin)
+				{
+					value += begin->second;
+				}
+				push(minor, value);
+			}
+			_offsets[major + 1] = _indices.size();
+		}
+	}
+
+	/**
+	 * This constructor copies the non zero coordinates of a dense matrix.
+	 * @param m - the dense matrix.
+	 * @param layout - the layout of the matrix.
+	 */
+	explicit SparseMatrix(const Matrix<T>& m, SparseLayout layout = SparseLayout::Csr) :
+	SparseMatrix(m.rows(), m.cols(), layout)
+	{
+		for(unsigned int major = 0 ; major < numOfMajors() ; ++major)
+		{
+			for(unsigned int minor = 0 ; minor < numOfMinors() ; ++minor)
+			{
+				push(minor, m._vectorMatrix[denseIndexOf(major, minor)]);
+			}
+			_offsets[major + 1] = _indices.size();
+		}
+	}
+
+	/**
+	 * This method converts the sparse matrix to a dense matrix.
+	 * @return the dense matrix.
+	 */
+	Matrix<T> toDense() const
+	{
+		Matrix<T> result(_numOfRows, _numOfCols);
+		for(unsigned int major = 0 ; major < numOfMajors() ; ++major)
+		{
+			for(std :: size_t index = _offsets[major] ; index < _offsets[major + 1] ; ++index)
+			{
+				result._vectorMatrix[denseIndexOf(major, _indices[index])] = _values[index];
+			}
+		}
+		return result;
+	}
+
+	/**
+	 * This method converts the sparse matrix to another layout, in time linear in the number
+	 * of non zero coordinates.
+	 * @param layout - the layout of the result.
+	 * @return the sparse matrix in the given layout.
+	 */
+	SparseMatrix toLayout(SparseLayout layout) const
+	{
+		if(layout == _layout)
+		{
+			return *(this);
+		}
+		SparseMatrix result(_numOfRows, _numOfCols, layout);
+		transposeStorageInto(result);
+		return result;
+	}
+
+	/**
+	 * This method checks if the matrix dimensions are positive.
+	 * @throw invalid argument error if not positive.
+	 */
+	void checkPositiveRowAndColNumber() const
+	{
+		if(!((int)_numOfCols > 0 && (int)_numOfRows > 0))
+		{
+			throw std :: invalid_argument(INVALID_ARGUMENT_ERROR);
+		}
+	}
+
+	/**
+	 * This method returns number of rows in the matrix.
+	 * @return number of rows in the matrix.
+	 */
+	unsigned int rows() const
+	{
+		return _numOfRows;
+	}
+
+	/**
+	 * This method returns number of columns in the matrix.
+	 * @return number of columns in the matrix.
+	 */
+	unsigned int cols() const
+	{
+		return _numOfCols;
+	}
+
+	/**
+	 * This method returns the layout of the matrix.
+	 * @return the layout of the matrix.
+	 */
+	SparseLayout layout() const
+	{
+		return _layout;
+	}
+
+	/**
+	 * This method returns number of stored (non zero) coordinates in the matrix.
+	 * @return number of stored coordinates.
+	 */
+	std :: size_t nonZeros() const
+	{
+		return _values.size();
+	}
+
+	/**
+	 * This method accesses a matrix coordinate, with a binary search in its row (CSR) or column
+	 * (CSC).
+	 * @param row - the coordinate row
+	 * @param column - the coordinate column
+	 * @return matrix coordinate (row, column).
+	 * @throw out of range exception of index out of bounds.
+	 */
+	T operator()(const unsigned int row, const unsigned int column) const
+	{
+		if(!(column < _numOfCols && row < _numOfRows))
+		{
+			throw std :: out_of_range(INDEX_OUT_OF_BOUNDS_ERROR);
+		}
+		unsigned int major = majorOf(row, column), minor = minorOf(row, column);
+		auto begin = _indices.begin() + _offsets[major];
+		auto end = _indices.begin() + _offsets[major + 1];
+		auto found = std :: lower_bound(begin, end, minor);
+		if(found == end || *found != minor)
+		{
+			return T(BASIC_MATRIX_VALUE);
+		}
+		return _values[found - _indices.begin()];
+	}
+
+	/**
+	 * This method multiplies the sparse matrix by a dense vector (SpMV). In the CSR layout the
+	 * rows are split into ranges of about the same number of non zero coordinates which run on
+	 * the threads of the global thread pool; in the CSC layout every range of columns scatters
+	 * into its own partial vector, and the partial vectors are summed in order.
+	 * @param x - the dense vector, of size cols().
+	 * @return the product, of size rows().
+	 * @throw logic error of incompatible matrices dimensions.
+	 */
+	std :: vector<T> operator*(const std :: vector<T>& x) const
+	{
+		if(x.size() != _numOfCols)
+		{
+			throw std :: logic_error(INVALID_MULTIPLICATION_OF_MATRICES_ERROR);
+		}
+		if(_layout == SparseLayout::Csr)
+		{
+			std :: vector<T> result(_numOfRows);
+			forBalancedMajors([&](unsigned int row)
+			{
+				T sum = T(BASIC_MATRIX_VALUE);
+				for(std :: size_t index = _offsets[row] ; index < _offsets[row + 1] ; ++index)
+				{
+					sum += _values[index] * x[_indices[index]];
+				}
+				result[row] = sum;
+			});
+			return result;
+		}
+		std :: size_t minimalChunk = minimalMajorsPerChunk();
+		return ThreadPool::instance().parallelReduce<std :: vector<T>>(_numOfCols, minimalChunk,
+				[&](std :: size_t begin, std :: size_t end)
+		{
+			std :: vector<T> partial(_numOfRows, T(BASIC_MATRIX_VALUE));
+			for(std :: size_t col = begin ; col < end ; ++col)
+			{
+				for(std :: size_t index = _offsets[col] ; index < _offsets[col + 1] ; ++index)
+				{
+					partial[_indices[index]] += _values[index] * x[col];
+				}
+			}
+			return partial;
+		}, [](const std :: vector<T>& left, const std :: vector<T>& right)
+		{
+			std :: vector<T> sum(left.size());
+			ElementwiseKernels<T>::add(left.size(), left.data(), right.data(), sum.data());
+			return sum;
+		});
+	}
+
+	/**
+	 * This method multiplies the sparse matrix by a dense matrix (SpMM): every non zero
+	 * coordinate (i, k) adds its value times row k of m to row i of the result. In the CSR
+	 * layout the rows of the result are split into balanced ranges like in SpMV; in the CSC
+	 * layout the columns of m and of the result are split into strips instead, so the threads
+	 * never write to the same coordinates.
+	 * @param m - the dense matrix.
+	 * @return the dense product.
+	 * @throw logic error of incompatible matrices dimensions.
+	 */
+	Matrix<T> operator*(const Matrix<T>& m) const
+	{
+		if(m.rows() != _numOfCols)
+		{
+			throw std :: logic_error(INVALID_MULTIPLICATION_OF_MATRICES_ERROR);
+		}
+		unsigned int denseCols = m.cols();
+		Matrix<T> result(_numOfRows, denseCols);
+		const T* dense = m._vectorMatrix.data();
+		T* out = result._vectorMatrix.data();
+		if(_layout == SparseLayout::Csr)
+		{
+			forBalancedMajors([&](unsigned int row)
+			{
+				for(std :: size_t index = _offsets[row] ; index < _offsets[row + 1] ; ++index)
+				{
+					ElementwiseKernels<T>::axpy(denseCols, _values[index],
+												dense + (std :: size_t) _indices[index] * denseCols,
+												out + (std :: size_t) row * denseCols);
+				}
+			});
+			return result;
+		}
+		std :: size_t minimalStrip = nonZeros() < SPARSE_PARALLEL_NON_ZEROS ?
+									 denseCols : SPARSE_PARALLEL_DENSE_COLS;
+		ThreadPool::instance().parallelRanges(denseCols, minimalStrip,
+											  [&](std :: size_t begin, std :: size_t end)
+		{
+			for(unsigned int col = 0 ; col < _numOfCols ; ++col)
+			{
+				for(std :: size_t index = _offsets[col] ; index < _offsets[col + 1] ; ++index)
+				{
+					ElementwiseKernels<T>::axpy(end - begin, _values[index],
+												dense + (std :: size_t) col * denseCols + begin,
+												out + (std :: size_t) _indices[index] * denseCols +
+												begin);
+				}
+			}
+		});
+		return result;
+	}
+
+	/**
+	 * This method adds two sparse matrices, merging the sorted coordinates of every row (CSR)
+	 * or column (CSC). The result has the layout of this matrix, m is converted if needed.
+	 * @param m - the right hand side matrix.
+	 * @return addition of two sparse matrices.
+	 * @throw logic error exception if the matrices dimensions do not suit each other.
+	 */
+	SparseMatrix operator+(const SparseMatrix& m) const
+	{
+		return merge(m, [](const T& left, const T& right)
+		{
+			return left + right;
+		});
+	}
+
+	/**
+	 * This method subtracts two sparse matrices, like operator+.
+	 * @param m - the right hand side matrix.
+	 * @return subtraction of two sparse matrices.
+	 * @throw logic error exception if the matrices dimensions do not suit each other.
+	 */
+	SparseMatrix operator-(const SparseMatrix& m) const
+	{
+		return merge(m, [](const T& left, const T& right)
+		{
+			return left - right;
+		});
+	}
+
+	/**
+	 * This method transposes the sparse matrix. The CSR storage of a matrix is the CSC storage
+	 * of its transpose, so the result has the other layout and the same arrays. Like Matrix<T>,
+	 * a complex numbers matrix is conjugated as well.
+	 * @return the transposed matrix.
+	 */
+	SparseMatrix trans() const
+	{
+		SparseMatrix result(*this);
+		std :: swap(result._numOfRows, result._numOfCols);
+		result._layout = _layout == SparseLayout::Csr ? SparseLayout::Csc : SparseLayout::Csr;
+		if constexpr (std :: is_same<T, Complex>::value)
+		{
+			for(Complex& value : result._values)
+			{
+				value = value.conj();
+			}
+		}
+		return result;
+	}
+
+	private:
+
+	/**
+	 * This method returns the number of major indices (rows in CSR, columns in CSC).
+	 * @return the number of major indices.
+	 */
+	unsigned int numOfMajors() const
+	{
+		return _layout == SparseLayout::Csr ? _numOfRows : _numOfCols;
+	}
+
+	/**
+	 * This method returns the number of minor indices (columns in CSR, rows in CSC).
+	 * @return the number of minor indices.
+	 */
+	unsigned int numOfMinors() const
+	{
+		return _layout == SparseLayout::Csr ? _numOfCols : _numOfRows;
+	}
+
+	/**
+	 * This method returns the major index of a coordinate.
+	 * @param row - the coordinate row.
+	 * @param col - the coordinate column.
+	 * @return the major index.
+	 */
+	unsigned int majorOf(unsigned int row, unsigned int col) const
+	{
+		return _layout == SparseLayout::Csr ? row : col;
+	}
+
+	/**
+	 * This method returns the minor index of a coordinate.
+	 * @param row - the coordinate row.
+	 * @param col - the coordinate column.
+	 * @return the minor index.
+	 */
+	unsigned int minorOf(unsigned int row, unsigned int col) const
+	{
+		return _layout == SparseLayout::Csr ? col : row;
+	}
+
+	/**
+	 * This method returns the index of a coordinate in the storage of a dense matrix of the
+	 * same dimensions.
+	 * @param major - the major index.
+	 * @param minor - the minor index.
+	 * @return the index in the dense storage.
+	 */
+	std :: size_t denseIndexOf(unsigned int major, unsigned int minor) const
+	{
+		return _layout == SparseLayout::Csr ? (std :: size_t) major * _numOfCols + minor :
+											  (std :: size_t) minor * _numOfCols + major;
+	}
+
+	/**
+	 * This method appends a coordinate to the last major index, unless it is zero.
+	 * @param minor - the minor index.
+	 * @param value - the value.
+	 */
+	void push(unsigned int minor, const T& value)
+	{
+		if(value != T(BASIC_MATRIX_VALUE))
+		{
+			_indices.push_back(minor);
+			_values.push_back(value);
+		}
+	}
+
+	/**
+	 * This method returns the minimal number of major indices in a parallel chunk, so a chunk
+	 * has about SPARSE_PARALLEL_NON_ZEROS non zero coordinates on average.
+	 * @return the minimal number of major indices.
+	 */
+	std :: size_t minimalMajorsPerChunk() const
+	{
+		return std :: max<std :: size_t>(1, (double) SPARSE_PARALLEL_NON_ZEROS * numOfMajors() /
+											std :: max<std :: size_t>(nonZeros(), 1));
+	}
+
+	/**
+	 * This method runs a function on every major index, on the threads of the global thread
+	 * pool. The major indices are split into one contiguous range per thread with about the
+	 * same number of non zero coordinates, found by a binary search in the offsets.
+	 * @tparam Function - the type of the function.
+	 * @param function - called with every major index.
+	 */
+	template <class Function> void forBalancedMajors(const Function& function) const
+	{
+		ThreadPool& pool = ThreadPool::instance();
+		std :: size_t numOfChunks = std :: min<std :: size_t>(pool.numOfThreads(),
+				std :: max<std :: size_t>(1, nonZeros() / SPARSE_PARALLEL_NON_ZEROS));
+		auto firstMajorOf = [&](std :: size_t chunk)
+		{
+			if(chunk == numOfChunks)
+			{
+				return (std :: size_t) numOfMajors();
+			}
+			std :: size_t firstNonZero = nonZeros() * chunk / numOfChunks;
+			return (std :: size_t) (std :: lower_bound(_offsets.begin(), _offsets.end() - 1,
+													   firstNonZero) - _offsets.begin());
+		};
+		auto runChunk = [&](std :: size_t chunk)
+		{
+			std :: size_t endOfChunk = firstMajorOf(chunk + 1);
+			for(std :: size_t major = firstMajorOf(chunk) ; major < endOfChunk ; ++major)
+			{
+				function(major);
+			}
+		};
+		if(numOfChunks == 1)
+		{
+			runChunk(0);
+			return;
+		}
+		pool.parallelFor(numOfChunks, runChunk);
+	}
+
+	/**
+	 * This method converts the storage to the other layout (a transpose of the index
+	 * structure), with a counting sort by minor index. Traversing the major indices in order
+	 * keeps the new minor indices sorted.
+	 * @param result - a matrix of zeros in the other layout, with the same dimensions.
+	 */
+	void transposeStorageInto(SparseMatrix& result) const
+	{
+		std :: vector<std :: size_t>& offsets = result._offsets;
+		for(unsigned int minor : _indices)
+		{
+			++offsets[minor + 1];
+		}
+		std :: partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+		result._indices.resize(nonZeros());
+		result._values.resize(nonZeros());
+		std :: vector<std :: size_t> next(offsets.begin(), offsets.end() - 1);
+		for(unsigned int major = 0 ; major < numOfMajors() ; ++major)
+		{
+			for(std :: size_t index = _offsets[major] ; index < _offsets[major + 1] ; ++index)
+			{
+				std :: size_t position = next[_indices[index]]++;
+				result._indices[position] = major;
+				result._values[position] = _values[index];
+			}
+		}
+	}
+
+	/**
+	 * This method merges the coordinates of two sparse matrices of the same dimensions.
+	 * Coordinates which appear in only one of them are combined with zero, and zero results are
+	 * not stored.
+	 * @tparam Combine - the type of the combine function.
+	 * @param m - the right hand side matrix.
+	 * @param combine - the function which combines two coordinates.
+	 * @return the merged matrix, in the layout of this matrix.
+	 * @throw logic error exception if the matrices dimensions do not suit each other.
+	 */
+	template <class Combine> SparseMatrix merge(const SparseMatrix& m, Combine combine) const
+	{
+		if(_numOfRows != m._numOfRows || _numOfCols != m._numOfCols)
+		{
+			throw std :: logic_error(INCOMPATIBLE_DIMENSIONS_OF_MATRICES_ERROR);
+		}
+		if(m._layout != _layout)
+		{
+			return merge(m.toLayout(_layout), combine);
+		}
+		const T zero = T(BASIC_MATRIX_VALUE);
+		SparseMatrix result(_numOfRows, _numOfCols, _layout);
+		result._indices.reserve(nonZeros() + m.nonZeros());
+		result._values.reserve(nonZeros() + m.nonZeros());
+		for(unsigned int major = 0 ; major < numOfMajors() ; ++major)
+		{
+			std :: size_t left = _offsets[major], leftEnd = _offsets[major + 1];
+			std :: size_t right = m._offsets[major], rightEnd = m._offsets[major + 1];
+			while(left < leftEnd || right < rightEnd)
+			{
+				if(right == rightEnd || (left < leftEnd && _indices[left] < m._indices[right]))
+				{
+					result.push(_indices[left], combine(_values[left], zero));
+					++left;
+				}
+				else if(left == leftEnd || m._indices[right] < _indices[left])
+				{
+					result.push(m._indices[right], combine(zero, m._values[right]));
+					++right;
+				}
+				else
+				{
+					result.push(_indices[left], combine(_values[left], m._values[right]));
+					++left;
+					++right;
+				}
+			}
+			result._offsets[major + 1] = result._indices.size();
+		}
+		return result;
+	}
+
+	/**
+	 * The number of rows in the matrix.
+	 */
+	unsigned int _numOfRows;
+
+	/**
+	 * The number of columns in the matrix.
+	 */
+	unsigned int _numOfCols;
+
+	/**
+	 * The layout of the matrix.
+	 */
+	SparseLayout _layout;
+
+	/**
+	 * The first stored coordinate of every major index, and the number of stored coordinates.
+	 */
+	std :: vector<std :: size_t> _offsets;
+
+	/**
+	 * The minor index of every stored coordinate.
+	 */
+	std :: vector<unsigned int> _indices;
+
+	/**
+	 * The value of every stored coordinate.
+	 */
+	std :: vector<T> _values;
+
+};
+
+#endif
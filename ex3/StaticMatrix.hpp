@@ -0,0 +1,543 @@
+//================================ Includes =====================================================
+#include "Matrix.hpp"
+#include "MatrixKernels.hpp"
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+//================================ Constants ====================================================
+#ifndef CPP3_STATIC_MATRIX_H
+#define CPP3_STATIC_MATRIX_H
+//================================ Code Segment =================================================
+
+/**
+ * This class represents a generic matrix whose dimensions are known at compile time, for the
+ * many small matrices (4 * 4, 6 * 6) which Matrix<T> handles poorly: its coordinates are stored
+ * inside the object instead of on the heap, its operators are unrolled over all the coordinates,
+ * and the dimensions of two operands are checked by the compiler instead of at run time. It is
+ * meant for small dimensions; large matrices compile slowly and belong in Matrix<T>.
+ * A static matrix converts to a Matrix<T>, and a Matrix<T> of the same dimensions converts
+ * back explicitly.
+ * @tparam T - the generic type of a coordinate in the matrix (with the same assumptions as in
+ * Matrix<T>).
+ * @tparam R - the number of rows.
+ * @tparam C - the number of columns.
+ */
+template <class T, unsigned int R, unsigned int C> class StaticMatrix
+{
+	static_assert(R > 0 && C > 0, INVALID_ARGUMENT_ERROR);
+
+	public:
+
+	/**
+	 * This type represents a constant iterator for a static matrix.
+	 */
+	typedef typename std :: array<T, R * C> :: const_iterator const_iterator;
+
+	/**
+	 * This is the default constructor which initializes a matrix of zeros.
+	 */
+	StaticMatrix()
+	{
+		_coords.fill(T(BASIC_MATRIX_VALUE));
+	}
+
+	/**
+	 * This constructor initializes a static matrix with the given coordinates, row by row.
+	 * @param cells - the coordinates.
+	 */
+	explicit StaticMatrix(const std :: array<T, R * C>& cells) : _coords(cells)
+	{
+
+	}
+
+	/**
+	 * This constructor copies a dynamic matrix of the same dimensions.
+	 * @param m - the dynamic matrix.
+	 * @throw logic error exception if the dimensions of m are not R * C.
+	 */
+	explicit StaticMatrix(const Matrix<T>& m)
+	{
+		if(m.rows() != R || m.cols() != C)
+		{
+			throw std :: logic_error(INCOMPATIBLE_DIMENSIONS_OF_MATRICES_ERROR);
+		}
+		std :: copy(m.begin(), m.end(), _coords.begin());
+	}
+
+	/**
+	 * This method converts the static matrix to a dynamic matrix.
+	 * @return the dynamic matrix.
+	 */
+	operator Matrix<T>() const
+	{
+		return Matrix<T>(R, C, std :: vector<T>(_coords.begin(), _coords.end()));
+	}
+
+	/**
+	 * This method returns number of rows in the matrix.
+	 * @return number of rows in the matrix.
+	 */
+	static constexpr unsigned int rows()
+	{
+		return R;
+	}
+
+	/**
+	 * This method returns number of columns in the matrix.
+	 * @return number of columns in the matrix.
+	 */
+	static constexpr unsigned int cols()
+	{
+		return C;
+	}
+
+	/**
+	 * This method adds a static matrix to this matrix in place.
+	 * @tparam OtherR - number of rows of m, which should be R.
+	 * @tparam OtherC - number of columns of m, which should be C.
+	 * @param m - the right hand side matrix.
+	 * @return a reference to this matrix.
+	 */
+	template <unsigned int OtherR, unsigned int OtherC>
+	StaticMatrix& operator+=(const StaticMatrix<T, OtherR, OtherC>& m)
+	{
+		static_assert(OtherR == R && OtherC == C, INCOMPATIBLE_DIMENSIONS_OF_MATRICES_ERROR);
+
+		combine(m, [](T& coord, const T& otherCoord)
+		{
+			coord += otherCoord;
+		}, std :: make_index_sequence<R * C>());
+		return *(this);
+	}
+
+	/**
+	 * This method subtracts a static matrix from this matrix in place.
+	 * @tparam OtherR - number of rows of m, which should be R.
+	 * @tparam OtherC - number of columns of m, which should be C.
+	 * @param m - the right hand side matrix.
+	 * @return a reference to this matrix.
+	 */
+	template <unsigned int OtherR, unsigned int OtherC>
+	StaticMatrix& operator-=(const StaticMatrix<T, OtherR, OtherC>& m)
+	{
+		static_assert(OtherR == R && OtherC == C, INCOMPATIBLE_DIMENSIONS_OF_MATRICES_ERROR);
+
+		combine(m, [](T& coord, const T& otherCoord)
+		{
+			coord -= otherCoord;
+		}, std :: make_index_sequence<R * C>());
+		return *(this);
+	}
+
+	/**
+	 * This method adds two static matrices.
+	 * @tparam OtherR - number of rows of m, which should be R.
+	 * @tparam OtherC - number of columns of m, which should be C.
+	 * @param m - the right hand side matrix.
+	 * @return addition of two static matrices.
+	 */
+	template <unsigned int OtherR, unsigned int OtherC>
+	StaticMatrix operator+(const StaticMatrix<T, OtherR, OtherC>& m) const
+	{
+		StaticMatrix result(*this);
+		result += m;
+		return result;
+	}
+
+	/**
+	 * This method subtracts two static matrices.
+	 * @tparam OtherR - number of rows of m, which should be R.
+	 * @tparam OtherC - number of columns of m, which should be C.
+	 * @param m - the right hand side matrix.
+	 * @return subtraction of two static matrices.
+	 */
+	template <unsigned int OtherR, unsigned int OtherC>
+	StaticMatrix operator-(const StaticMatrix<T, OtherR, OtherC>& m) const
+	{
+		StaticMatrix result(*this);
+		result -= m;
+		return result;
+	}
+
+	/**
+	 * This method multiplies two static matrices. If the rows of the result split into SIMD
+	 * registers of at least two lanes, every row of the result is accumulated in registers from
+	 * the rows of m (row i of the result is the sum of this(i, k) * row k of m); otherwise every
+	 * coordinate of the result is an unrolled dot product of a row of this matrix and a column
+	 * of m.
+	 * @tparam OtherR - number of rows of m, which should be C.
+	 * @tparam OtherC - number of columns of m.
+	 * @param m - the right hand side matrix.
+	 * @return multiplication of two static matrices.
+	 */
+	template <unsigned int OtherR, unsigned int OtherC>
+	StaticMatrix<T, R, OtherC> operator*(const StaticMatrix<T, OtherR, OtherC>& m) const
+	{
+		static_assert(OtherR == C, INVALID_MULTIPLICATION_OF_MATRICES_ERROR);
+
+		StaticMatrix<T, R, OtherC> result;
+		multiplyInto(m, result, std :: make_index_sequence<R * OtherC>());
+		return result;
+	}
+
+	/**
+	 * This method multiplies this matrix by a square static matrix (this = this * m).
+	 * @tparam OtherR - number of rows of m, which should be C.
+	 * @tparam OtherC - number of columns of m, which should be C.
+	 * @param m - the right hand side matrix.
+	 * @return a reference to this matrix.
+	 */
+	template <unsigned int OtherR, unsigned int OtherC>
+	StaticMatrix& operator*=(const StaticMatrix<T, OtherR, OtherC>& m)
+	{
+		static_assert(OtherR == C && OtherC == C, INVALID_MULTIPLICATION_OF_MATRICES_ERROR);
+
+		*this = *this * m;
+		return *(this);
+	}
+
+	/**
+	 * This method multiplies this matrix by a scalar in place.
+	 * @param scalar - the scalar.
+	 * @return a reference to this matrix.
+	 */
+	StaticMatrix& operator*=(const T& scalar)
+	{
+		combine(*this, [&scalar](T& coord, const T&)
+		{
+			coord *= scalar;
+		}, std :: make_index_sequence<R * C>());
+		return *(this);
+	}
+
+	/**
+	 * This method multiplies a static matrix by a scalar.
+	 * @param scalar - the scalar.
+	 * @return multiplication of the matrix by the scalar.
+	 */
+	StaticMatrix operator*(const T& scalar) const
+	{
+		StaticMatrix result(*this);
+		result *= scalar;
+		return result;
+	}
+
+	/**
+	 * This method compares between two static matrices of the same dimensions.
+	 * @param m - the right hand side matrix.
+	 * @return true if the two matrices are equal, false otherwise.
+	 */
+	bool operator==(const StaticMatrix& m) const
+	{
+		return _coords == m._coords;
+	}
+
+	/**
+	 * This method compares between two static matrices of the same dimensions.
+	 * @param m - the right hand side matrix.
+	 * @return true if the two matrices are not equal, false otherwise.
+	 */
+	bool operator!=(const StaticMatrix& m) const
+	{
+		return !(m == (*this));
+	}
+
+	/**
+	 * This method checks if the matrix is a square matrix.
+	 * @return true if the matrix is a square matrix, false otherwise.
+	 */
+	static constexpr bool isSquareMatrix()
+	{
+		return R == C;
+	}
+
+	/**
+	 * This method transposes the matrix. Like Matrix<T>, a complex numbers matrix is conjugated
+	 * as well, so its transpose is its Hermitian matrix.
+	 * @return the transposed matrix.
+	 */
+	StaticMatrix<T, C, R> trans() const
+	{
+		StaticMatrix<T, C, R> result;
+		transposeInto(result, std :: make_index_sequence<R * C>());
+		return result;
+	}
+
+	/**
+	 * This method calculates the trace of a square matrix (the sum of its diagonal).
+	 * @return the trace of the matrix.
+	 */
+	T trace() const
+	{
+		static_assert(isSquareMatrix(), TRACE_OF_NON_SQUARE_MATRIX_ERROR);
+
+		return traceOf(std :: make_index_sequence<R>());
+	}
+
+	/**
+	 * This method checks index out of bounds exception for accessing a matrix coordinate, unless
+	 * MATRIX_BOUNDS_CHECK is 0.
+	 * @param row - the coordinate row
+	 * @param column - the coordinate column
+	 * @throw out of range exception of index out of bounds.
+	 */
+	static void checkIndexOutOfBounds(const unsigned int row, const unsigned int column)
+	{
+#if MATRIX_BOUNDS_CHECK
+		if(!(column < C && row < R))
+		{
+			throw std :: out_of_range(INDEX_OUT_OF_BOUNDS_ERROR);
+		}
+#else
+		(void) row;
+		(void) column;
+#endif
+	}
+
+	/**
+	 * This method accesses a matrix coordinate.
+	 * @param row - the coordinate row
+	 * @param column - the coordinate column
+	 * @return matrix coordinate (row, column).
+	 * @throw out of range exception of index out of bounds.
+	 */
+	const T& operator()(const unsigned int row, const unsigned int column) const
+	{
+		checkIndexOutOfBounds(row, column);
+
+		return _coords[column + C * row];
+	}
+
+	/**
+	 * This method accesses a matrix coordinate.
+	 * @param row - the coordinate row
+	 * @param column - the coordinate column
+	 * @return matrix coordinate (row, column).
+	 * @throw out of range exception of index out of bounds.
+	 */
+	T& operator()(const unsigned int row, const unsigned int column)
+	{
+		checkIndexOutOfBounds(row, column);
+
+		return _coords[column + C * row];
+	}
+
+	/**
+	 * This method prints a static matrix, in the same format as Matrix<T>.
+	 * @param os - the output stream reference.
+	 * @param m - the matrix we want to print.
+	 * @return the output stream reference.
+	 */
+	friend std :: ostream& operator<<(std :: ostream& os, const StaticMatrix& m)
+	{
+		for(unsigned int row = 0 ; row < R ; ++row)
+		{
+			for(unsigned int col = 0 ; col < C ; ++col)
+			{
+				os << m._coords[col + C * row];
+				os << SEPARATOR_OF_A_TAB;
+			}
+
+			os << '\n';
+
+		}
+
+		return os;
+
+	}
+
+	/**
+	 * This method iterates over a static matrix.
+	 * @return static matrix iterator.
+	 */
+	const_iterator begin() const
+	{
+		return _coords.cbegin();
+	}
+
+	/**
+	 * This method returns the address after the last cell of a static matrix.
+	 * @return the address after the last cell of a static matrix.
+	 */
+	const_iterator end() const
+	{
+		return _coords.cend();
+	}
+
+	private:
+
+	template <class U, unsigned int OtherR, unsigned int OtherC> friend class StaticMatrix;
+
+	/**
+	 * This method combines every coordinate of this matrix with the same coordinate of m, in
+	 * place, unrolled over all the coordinates.
+	 * @tparam Combine - the type of the combine function.
+	 * @tparam Indices - the indices of the coordinates.
+	 * @param m - the other matrix.
+	 * @param operation - called as operation(coord of this, coord of m).
+	 */
+	template <class Combine, std :: size_t... Indices>
+	void combine(const StaticMatrix& m, Combine operation, std :: index_sequence<Indices...>)
+	{
+		(operation(_coords[Indices], m._coords[Indices]), ...);
+	}
+
+	/**
+	 * The number of lanes of the SIMD registers which hold a row of OtherC coordinates: the
+	 * largest power of two which divides OtherC and fits in a register, or 1 if T is not
+	 * arithmetic.
+	 * @tparam OtherC - number of coordinates in the row.
+	 * @return the number of lanes.
+	 */
+	template <unsigned int OtherC>
+	static constexpr unsigned int rowLanes()
+	{
+		unsigned int lanes = 1;
+		while(MatrixKernels<T>::IS_BLOCKED && OtherC % (2 * lanes) == 0 &&
+			  2 * lanes * sizeof(T) <= GEMM_VECTOR_BYTES)
+		{
+			lanes *= 2;
+		}
+		return lanes;
+	}
+
+	/**
+	 * This method multiplies this matrix by m into result: row by row in SIMD registers if a
+	 * row splits into registers of at least two lanes, and otherwise unrolled over all the
+	 * coordinates of the result.
+	 * @tparam OtherC - number of columns of m.
+	 * @tparam Indices - the indices of the coordinates of the result.
+	 * @param m - the right hand side matrix.
+	 * @param result - the product.
+	 */
+	template <unsigned int OtherC, std :: size_t... Indices>
+	void multiplyInto(const StaticMatrix<T, C, OtherC>& m, StaticMatrix<T, R, OtherC>& result,
+					  std :: index_sequence<Indices...>) const
+	{
+		constexpr unsigned int lanes = rowLanes<OtherC>();
+		if constexpr (lanes >= 2)
+		{
+			typedef T Vector __attribute__((vector_size(lanes * sizeof(T))));
+			constexpr unsigned int vectorsPerRow = OtherC / lanes;
+			Vector rowsOfM[C][vectorsPerRow];
+			std :: memcpy(rowsOfM, m._coords.data(), sizeof(rowsOfM));
+#pragma GCC unroll 16
+			for(unsigned int row = 0 ; row < R ; ++row)
+			{
+				Vector rowOfResult[vectorsPerRow] = {};
+#pragma GCC unroll 16
+				for(unsigned int k = 0 ; k < C ; ++k)
+				{
+#pragma GCC unroll 16
+					for(unsigned int vector = 0 ; vector < vectorsPerRow ; ++vector)
+					{
+						rowOfResult[vector] += _coords[row * C + k] * rowsOfM[k][vector];
+					}
+				}
+				std :: memcpy(&result._coords[row * OtherC], rowOfResult, sizeof(rowOfResult));
+			}
+		}
+		else
+		{
+			((result._coords[Indices] = dotProduct<OtherC>(&_coords[Indices / OtherC * C],
+														   &m._coords[Indices % OtherC],
+														   std :: make_index_sequence<C>())),
+			 ...);
+		}
+	}
+
+	/**
+	 * This method calculates the dot product of a row of this matrix and a column of another
+	 * matrix, unrolled.
+	 * @tparam OtherC - number of columns of the other matrix (the stride of its column).
+	 * @tparam Indices - the indices of the row.
+	 * @param row - the first coordinate of the row.
+	 * @param column - the first coordinate of the column.
+	 * @return the dot product.
+	 */
+	template <unsigned int OtherC, std :: size_t... Indices>
+	static T dotProduct(const T* row, const T* column, std :: index_sequence<Indices...>)
+	{
+		return (T(BASIC_MATRIX_VALUE) + ... + (row[Indices] * column[Indices * OtherC]));
+	}
+
+	/**
+	 * This method transposes this matrix into result, unrolled over all the coordinates.
+	 * @tparam Indices - the indices of the coordinates of this matrix.
+	 * @param result - the transposed matrix.
+	 */
+	template <std :: size_t... Indices>
+	void transposeInto(StaticMatrix<T, C, R>& result, std :: index_sequence<Indices...>) const
+	{
+		((result._coords[Indices % C * R + Indices / C] = transposedCoordinate(_coords[Indices])),
+		 ...);
+	}
+
+	/**
+	 * This method returns a coordinate of the transposed matrix: the conjugate of a complex
+	 * number, or the coordinate itself for other types.
+	 * @param coord - the coordinate.
+	 * @return the transposed coordinate.
+	 */
+	static T transposedCoordinate(const T& coord)
+	{
+		if constexpr (std :: is_same<T, Complex>::value)
+		{
+			return coord.conj();
+		}
+		else
+		{
+			return coord;
+		}
+	}
+
+	/**
+	 * This method sums the diagonal of a square matrix, unrolled.
+	 * @tparam Indices - the indices of the diagonal.
+	 * @return the sum of the diagonal.
+	 */
+	template <std :: size_t... Indices>
+	T traceOf(std :: index_sequence<Indices...>) const
+	{
+		return (T(BASIC_MATRIX_VALUE) + ... + _coords[Indices * (C + 1)]);
+	}
+
+	/**
+	 * The coordinates of the matrix, row by row, stored inside the object.
+	 */
+	std :: array<T, R * C> _coords;
+
+};
+
+/**
+ * This function multiplies a static matrix by a dynamic matrix.
+ * @param left - the static matrix.
+ * @param right - the dynamic matrix.
+ * @return multiplication of the two matrices.
+ * @throw logic error of incompatible matrices dimensions.
+ */
+template <class T, unsigned int R, unsigned int C>
+Matrix<T> operator*(const StaticMatrix<T, R, C>& left, const Matrix<T>& right)
+{
+	return Matrix<T>(left) * right;
+}
+
+/**
+ * This function multiplies a dynamic matrix by a static matrix.
+ * @param left - the dynamic matrix.
+ * @param right - the static matrix.
+ * @return multiplication of the two matrices.
+ * @throw logic error of incompatible matrices dimensions.
+ */
+template <class T, unsigned int R, unsigned int C>
+Matrix<T> operator*(const Matrix<T>& left, const StaticMatrix<T, R, C>& right)
+{
+	return left * Matrix<T>(right);
+}
+
+#endif
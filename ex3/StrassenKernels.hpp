@@ -0,0 +1,391 @@
+//================================ Includes =====================================================
+#include "ElementwiseKernels.hpp"
+#include "MatrixKernels.hpp"
+#include "ThreadPool.hpp"
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+//================================ Constants ====================================================
+#ifndef CPP3_STRASSEN_KERNELS_H
+#define CPP3_STRASSEN_KERNELS_H
+#define STRASSEN_CUTOFF 512
+#define STRASSEN_DEFAULT_MINIMAL_SIZE 4096
+#define STRASSEN_DISABLED 0
+#define STRASSEN_NUM_OF_PRODUCTS 7
+#define STRASSEN_NUM_OF_OPERANDS 8
+#define STRASSEN_NUM_OF_PRODUCT_BUFFERS 3
+#define STRASSEN_PARALLEL_ROWS_CHUNK 16
+//================================ Code Segment =================================================
+
+/**
+ * This class holds the Strassen-Winograd multiplication of large square matrices: 7 products
+ * of half the size and 15 additions per level instead of 8 products, recursively down to a
+ * cutoff below which the packed GEMM kernel of MatrixKernels is faster. An odd dimension is
+ * peeled: the even leading block goes through the recursion and the last row and column are
+ * fixed up with thin GEMMs.
+ * All the temporary blocks live in one workspace arena which is allocated once per product.
+ * Below the top level the products run one after the other with the two-temporaries schedule
+ * of Boyer, Dumas, Pernet and Zhou, which needs 2/3 n^2 coordinates of workspace in total.
+ * At the top level, if the global thread pool has more than one thread, the 7 products are
+ * independent tasks of the pool; this needs about 4 n^2 coordinates of workspace instead.
+ * The result is not bitwise equal to the classic product: the error bound of floating point
+ * coordinates grows by a factor of about 18 per level of the recursion. It is used only for
+ * floating point types (the intermediate sums of integers could overflow where the classic
+ * product does not), and only when enabled for the dimension (see setMinimalSize).
+ * @tparam T - the generic type of a coordinate.
+ */
+template <class T> class StrassenKernels
+{
+	public:
+
+	/**
+	 * True if T can be multiplied with Strassen-Winograd.
+	 */
+	static constexpr bool IS_SUPPORTED = std::is_floating_point<T>::value;
+
+	/**
+	 * This method returns the minimal dimension of a square product which is multiplied with
+	 * Strassen-Winograd, or STRASSEN_DISABLED.
+	 * @return the minimal dimension.
+	 */
+	static unsigned minimalSize()
+	{
+		return minimalSizeSetting();
+	}
+
+	/**
+	 * This method sets the minimal dimension of a square product which is multiplied with
+	 * Strassen-Winograd. Like the number of threads, it is a global setting (of T) which should
+	 * not be changed while a product is running.
+	 * @param size - the minimal dimension, or STRASSEN_DISABLED to always use the classic GEMM.
+	 */
+	static void setMinimalSize(unsigned size)
+	{
+		minimalSizeSetting() = size;
+	}
+
+	/**
+	 * This method checks if a product of the given dimensions is multiplied with
+	 * Strassen-Winograd.
+	 * @param rows - number of rows of the product.
+	 * @param cols - number of columns of the product.
+	 * @param depth - the inner dimension of the product.
+	 * @return true if the product is square, large enough and of a supported type.
+	 */
+	static bool isUsedFor(unsigned rows, unsigned cols, unsigned depth)
+	{
+		return IS_SUPPORTED && minimalSize() != STRASSEN_DISABLED && rows == cols &&
+			   cols == depth && rows >= minimalSize() && (rows & ~1u) > STRASSEN_CUTOFF;
+	}
+
+	/**
+	 * This method multiplies square row-major matrices: c = a * b.
+	 * @param size - the dimension of the matrices.
+	 * @param a - the storage of a.
+	 * @param aRowStride - the distance between two rows of a.
+	 * @param b - the storage of b.
+	 * @param bRowStride - the distance between two rows of b.
+	 * @param c - the storage of c, which should not overlap a or b.
+	 * @param cRowStride - the distance between two rows of c.
+	 */
+	static void multiply(unsigned size, const T* a, std::ptrdiff_t aRowStride, const T* b,
+						 std::ptrdiff_t bRowStride, T* c, std::ptrdiff_t cRowStride)
+	{
+		unsigned evenSize = size & ~1u;
+		unsigned half = evenSize / 2;
+		bool isParallel = ThreadPool::instance().numOfThreads() > 1;
+		std::size_t arenaSize = isParallel ?
+								(STRASSEN_NUM_OF_OPERANDS + STRASSEN_NUM_OF_PRODUCT_BUFFERS) *
+								quarterSize(half) + STRASSEN_NUM_OF_PRODUCTS * workspaceSize(half) :
+								workspaceSize(evenSize);
+		std::unique_ptr<T[]> arena(new T[arenaSize]);
+		if(isParallel)
+		{
+			multiplyInParallel(half, a, aRowStride, b, bRowStride, c, cRowStride, arena.get());
+		}
+		else
+		{
+			multiplyRecursively(evenSize, a, aRowStride, b, bRowStride, c, cRowStride,
+								arena.get());
+		}
+		if(size != evenSize)
+		{
+			fixUpPeeledDimension(size, a, aRowStride, b, bRowStride, c, cRowStride, true);
+		}
+	}
+
+	private:
+
+	/**
+	 * This method returns the storage of the setting of the minimal dimension.
+	 * @return a reference to the setting.
+	 */
+	static unsigned& minimalSizeSetting()
+	{
+		static unsigned size = STRASSEN_DEFAULT_MINIMAL_SIZE;
+		return size;
+	}
+
+	/**
+	 * This method returns the number of coordinates of a square block.
+	 * @param size - the dimension of the block.
+	 * @return the number of coordinates.
+	 */
+	static std::size_t quarterSize(unsigned size)
+	{
+		return (std::size_t) size * size;
+	}
+
+	/**
+	 * This method returns the workspace which multiplyRecursively needs: two temporary blocks of
+	 * half the size per level of the recursion.
+	 * @param size - the dimension of the product.
+	 * @return the number of coordinates of the workspace.
+	 */
+	static std::size_t workspaceSize(unsigned size)
+	{
+		std::size_t result = 0;
+		while(size > STRASSEN_CUTOFF)
+		{
+			size = (size & ~1u) / 2;
+			result += 2 * quarterSize(size);
+		}
+		return result;
+	}
+
+	/**
+	 * This method fixes up the last row and column of a product of odd dimension, after the
+	 * leading block of dimension size - 1 was multiplied: it adds the outer product of the last
+	 * column of a and the last row of b to the leading block, and multiplies the last row and
+	 * column of c from scratch.
+	 * @param size - the odd dimension of the product.
+	 * @param isParallel - true to run the GEMMs on the global thread pool.
+	 * The other parameters are the same as in multiply.
+	 */
+	static void fixUpPeeledDimension(unsigned size, const T* a, std::ptrdiff_t aRowStride,
+									 const T* b, std::ptrdiff_t bRowStride, T* c,
+									 std::ptrdiff_t cRowStride, bool isParallel)
+	{
+		unsigned last = size - 1;
+		auto gemm = isParallel ? MatrixKernels<T>::template parallelGemm<T> :
+							  MatrixKernels<T>::template gemm<T>;
+		gemm(last, last, 1, a + last, aRowStride, 1, b + last * bRowStride, bRowStride, 1,
+			 c, cRowStride, 1, true);
+		gemm(size, 1, size, a, aRowStride, 1, b + last, bRowStride, 1, c + last, cRowStride, 1,
+			 false);
+		gemm(1, last, size, a + last * aRowStride, aRowStride, 1, b, bRowStride, 1,
+			 c + last * cRowStride, cRowStride, 1, false);
+	}
+
+	/**
+	 * This method multiplies square matrices on the calling thread, with the two-temporaries
+	 * schedule below: X and Y are the temporaries, and the blocks of c hold the products until
+	 * they are combined into the result.
+	 * @param size - the dimension of the matrices.
+	 * @param workspace - at least workspaceSize(size) coordinates.
+	 * The other parameters are the same as in multiply.
+	 */
+	static void multiplyRecursively(unsigned size, const T* a, std::ptrdiff_t aRowStride,
+									const T* b, std::ptrdiff_t bRowStride, T* c,
+									std::ptrdiff_t cRowStride, T* workspace)
+	{
+		if(size <= STRASSEN_CUTOFF)
+		{
+			MatrixKernels<T>::gemm(size, size, size, a, aRowStride, 1, b, bRowStride, 1, c,
+								   cRowStride, 1, false);
+			return;
+		}
+		if(size % 2 != 0)
+		{
+			multiplyRecursively(size - 1, a, aRowStride, b, bRowStride, c, cRowStride, workspace);
+			fixUpPeeledDimension(size, a, aRowStride, b, bRowStride, c, cRowStride, false);
+			return;
+		}
+		unsigned half = size / 2;
+		Blocks<const T> A(a, aRowStride, half), B(b, bRowStride, half);
+		Blocks<T> C(c, cRowStride, half);
+		T* x = workspace;
+		T* y = workspace + quarterSize(half);
+		T* next = y + quarterSize(half);
+		auto product = [&](const T* left, std::ptrdiff_t leftStride, const T* right,
+						   std::ptrdiff_t rightStride, T* out, std::ptrdiff_t outStride)
+		{
+			multiplyRecursively(half, left, leftStride, right, rightStride, out, outStride, next);
+		};
+		combine(half, A.at11, A.rowStride, A.at21, A.rowStride, x, half, subtractRows); // S3
+		combine(half, B.at22, B.rowStride, B.at12, B.rowStride, y, half, subtractRows); // T3
+		product(x, half, y, half, C.at21, C.rowStride); // P7
+		combine(half, A.at21, A.rowStride, A.at22, A.rowStride, x, half, addRows); // S1
+		combine(half, B.at12, B.rowStride, B.at11, B.rowStride, y, half, subtractRows); // T1
+		product(x, half, y, half, C.at22, C.rowStride); // P5
+		combine(half, x, half, A.at11, A.rowStride, x, half, subtractRows); // S2
+		combine(half, B.at22, B.rowStride, y, half, y, half, subtractRows); // T2
+		product(x, half, y, half, C.at12, C.rowStride); // P6
+		combine(half, A.at12, A.rowStride, x, half, x, half, subtractRows); // S4
+		combine(half, y, half, B.at21, B.rowStride, y, half, subtractRows); // T4
+		product(x, half, B.at22, B.rowStride, C.at11, C.rowStride); // P3
+		product(A.at11, A.rowStride, B.at11, B.rowStride, x, half); // P1
+		combine(half, x, half, C.at12, C.rowStride, C.at12, C.rowStride, addRows); // U2
+		combine(half, C.at12, C.rowStride, C.at21, C.rowStride, C.at21, C.rowStride, addRows);
+		combine(half, C.at12, C.rowStride, C.at22, C.rowStride, C.at12, C.rowStride, addRows);
+		combine(half, C.at21, C.rowStride, C.at22, C.rowStride, C.at22, C.rowStride, addRows);
+		combine(half, C.at12, C.rowStride, C.at11, C.rowStride, C.at12, C.rowStride, addRows);
+		product(A.at22, A.rowStride, y, half, C.at11, C.rowStride); // P4
+		combine(half, C.at21, C.rowStride, C.at11, C.rowStride, C.at21, C.rowStride,
+				subtractRows); // U6
+		product(A.at12, A.rowStride, B.at21, B.rowStride, C.at11, C.rowStride); // P2
+		combine(half, x, half, C.at11, C.rowStride, C.at11, C.rowStride, addRows); // U1
+	}
+
+	/**
+	 * This method multiplies square matrices of even dimension with the 7 products of the top
+	 * level running as tasks of the global thread pool. The operands of the products are
+	 * computed first, the products go to the blocks of c and to three more buffers, and then
+	 * they are combined into the result. The element-wise passes are split by rows on the pool.
+	 * @param half - half the dimension of the matrices.
+	 * @param arena - the operands, the product buffers and a workspace per product.
+	 * The other parameters are the same as in multiply.
+	 */
+	static void multiplyInParallel(unsigned half, const T* a, std::ptrdiff_t aRowStride,
+								   const T* b, std::ptrdiff_t bRowStride, T* c,
+								   std::ptrdiff_t cRowStride, T* arena)
+	{
+		Blocks<const T> A(a, aRowStride, half), B(b, bRowStride, half);
+		Blocks<T> C(c, cRowStride, half);
+		std::size_t quarter = quarterSize(half);
+		T *s1 = arena, *s2 = s1 + quarter, *s3 = s2 + quarter, *s4 = s3 + quarter;
+		T *t1 = s4 + quarter, *t2 = t1 + quarter, *t3 = t2 + quarter, *t4 = t3 + quarter;
+		T *p1 = t4 + quarter, *p2 = p1 + quarter, *p4 = p2 + quarter;
+		T* workspaces = p4 + quarter;
+		ThreadPool& pool = ThreadPool::instance();
+		pool.parallelRanges(half, STRASSEN_PARALLEL_ROWS_CHUNK,
+							[&](std::size_t begin, std::size_t end)
+		{
+			for(std::size_t row = begin ; row < end ; ++row)
+			{
+				std::size_t r = row * half;
+				const T *a11 = A.at11 + row * A.rowStride, *a12 = A.at12 + row * A.rowStride;
+				const T *a21 = A.at21 + row * A.rowStride, *a22 = A.at22 + row * A.rowStride;
+				const T *b11 = B.at11 + row * B.rowStride, *b12 = B.at12 + row * B.rowStride;
+				const T *b21 = B.at21 + row * B.rowStride, *b22 = B.at22 + row * B.rowStride;
+				addRows(half, a21, a22, s1 + r);
+				subtractRows(half, s1 + r, a11, s2 + r);
+				subtractRows(half, a11, a21, s3 + r);
+				subtractRows(half, a12, s2 + r, s4 + r);
+				subtractRows(half, b12, b11, t1 + r);
+				subtractRows(half, b22, t1 + r, t2 + r);
+				subtractRows(half, b22, b12, t3 + r);
+				subtractRows(half, t2 + r, b21, t4 + r);
+			}
+		});
+		const T* lefts[STRASSEN_NUM_OF_PRODUCTS] = {A.at11, A.at12, s4, A.at22, s1, s2, s3};
+		std::ptrdiff_t leftStrides[STRASSEN_NUM_OF_PRODUCTS] = {A.rowStride, A.rowStride, half,
+																A.rowStride, half, half, half};
+		const T* rights[STRASSEN_NUM_OF_PRODUCTS] = {B.at11, B.at21, B.at22, t4, t1, t2, t3};
+		std::ptrdiff_t rightStrides[STRASSEN_NUM_OF_PRODUCTS] = {B.rowStride, B.rowStride,
+																 B.rowStride, half, half, half,
+																 half};
+		T* outs[STRASSEN_NUM_OF_PRODUCTS] = {p1, p2, C.at11, p4, C.at22, C.at12, C.at21};
+		std::ptrdiff_t outStrides[STRASSEN_NUM_OF_PRODUCTS] = {half, half, C.rowStride, half,
+															   C.rowStride, C.rowStride,
+															   C.rowStride};
+		pool.parallelFor(STRASSEN_NUM_OF_PRODUCTS, [&](std::size_t index)
+		{
+			multiplyRecursively(half, lefts[index], leftStrides[index], rights[index],
+								rightStrides[index], outs[index], outStrides[index],
+								workspaces + index * workspaceSize(half));
+		});
+		// the blocks of c hold P3 (C11), P5 (C22), P6 (C12) and P7 (C21)
+		pool.parallelRanges(half, STRASSEN_PARALLEL_ROWS_CHUNK,
+							[&](std::size_t begin, std::size_t end)
+		{
+			for(std::size_t row = begin ; row < end ; ++row)
+			{
+				std::size_t r = row * half;
+				T *c11 = C.at11 + row * C.rowStride, *c12 = C.at12 + row * C.rowStride;
+				T *c21 = C.at21 + row * C.rowStride, *c22 = C.at22 + row * C.rowStride;
+				addRows(half, p1 + r, c12, c12); // U2
+				addRows(half, c12, c21, c21); // U3
+				addRows(half, c12, c22, c12); // U4
+				addRows(half, c21, c22, c22); // U7
+				addRows(half, c12, c11, c12); // U5
+				subtractRows(half, c21, p4 + r, c21); // U6
+				addRows(half, p1 + r, p2 + r, c11); // U1
+			}
+		});
+	}
+
+	/**
+	 * This struct represents the four blocks of a square matrix of even dimension.
+	 * @tparam U - the type of a coordinate (const for operands).
+	 */
+	template <class U> struct Blocks
+	{
+		/**
+		 * This constructor splits a matrix into its blocks.
+		 * @param data - the storage of the matrix.
+		 * @param rowStride - the distance between two rows.
+		 * @param half - half the dimension of the matrix.
+		 */
+		Blocks(U* data, std::ptrdiff_t rowStride, unsigned half) : rowStride(rowStride),
+		at11(data), at12(data + half), at21(data + half * rowStride),
+		at22(data + half * rowStride + half)
+		{
+
+		}
+
+		const std::ptrdiff_t rowStride;
+		U* const at11;
+		U* const at12;
+		U* const at21;
+		U* const at22;
+	};
+
+	/**
+	 * This method adds two rows: out = left + right.
+	 * @param size - the length of the rows.
+	 * @param left - the left row.
+	 * @param right - the right row.
+	 * @param out - the result, which may be one of the operands.
+	 */
+	static void addRows(std::size_t size, const T* left, const T* right, T* out)
+	{
+		ElementwiseKernels<T>::add(size, left, right, out);
+	}
+
+	/**
+	 * This method subtracts two rows: out = left - right.
+	 * @param size - the length of the rows.
+	 * @param left - the left row.
+	 * @param right - the right row.
+	 * @param out - the result, which may be one of the operands.
+	 */
+	static void subtractRows(std::size_t size, const T* left, const T* right, T* out)
+	{
+		ElementwiseKernels<T>::subtract(size, left, right, out);
+	}
+
+	/**
+	 * This method combines two square blocks row by row: out = rows(left, right).
+	 * @param size - the dimension of the blocks.
+	 * @param left - the left block.
+	 * @param leftStride - the distance between two rows of left.
+	 * @param right - the right block.
+	 * @param rightStride - the distance between two rows of right.
+	 * @param out - the result, which may be one of the operands.
+	 * @param outStride - the distance between two rows of out.
+	 * @param rows - the function which combines two rows (addRows or subtractRows).
+	 */
+	static void combine(unsigned size, const T* left, std::ptrdiff_t leftStride, const T* right,
+						std::ptrdiff_t rightStride, T* out, std::ptrdiff_t outStride,
+						void (*rows)(std::size_t, const T*, const T*, T*))
+	{
+		for(unsigned row = 0 ; row < size ; ++row)
+		{
+			rows(size, left + row * leftStride, right + row * rightStride, out + row * outStride);
+		}
+	}
+
+};
+
+#endif
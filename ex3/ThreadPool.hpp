@@ -0,0 +1,367 @@
+//================================ Includes =====================================================
+#include "PerfCounters.hpp"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+//================================ Constants ====================================================
+#ifndef CPP3_THREAD_POOL_H
+#define CPP3_THREAD_POOL_H
+#define MINIMAL_NUM_OF_THREADS 1
+//================================ Code Segment =================================================
+
+/**
+ * This class represents the global pool of worker threads which runs the parallel matrix
+ * operations. The calling thread always takes part in the work, so a pool of n threads has
+ * n - 1 workers, and a pool of one thread runs everything serially on the caller.
+ * The number of threads is a global setting: it should not be changed while a parallel
+ * operation is running.
+ */
+class ThreadPool
+{
+	public:
+
+	/**
+	 * This method returns the global thread pool. It starts with one thread per hardware thread.
+	 * @return the global thread pool.
+	 */
+	static ThreadPool& instance()
+	{
+		static ThreadPool pool(std::thread::hardware_concurrency());
+		return pool;
+	}
+
+	/**
+	 * This destructor stops the worker threads.
+	 */
+	~ThreadPool()
+	{
+		stopWorkers();
+	}
+
+	ThreadPool(const ThreadPool&) = delete;
+
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	/**
+	 * This method returns the number of threads which run a parallel operation (the workers and
+	 * the calling thread).
+	 * @return the number of threads.
+	 */
+	unsigned numOfThreads() const
+	{
+		return (unsigned) _workers.size() + 1;
+	}
+
+	/**
+	 * This method sets the number of threads which run a parallel operation.
+	 * @param numOfThreads - the number of threads, 1 to run everything serially (0 is treated
+	 * as 1).
+	 */
+	void setNumOfThreads(unsigned numOfThreads)
+	{
+		numOfThreads = std::max(numOfThreads, (unsigned) MINIMAL_NUM_OF_THREADS);
+		if(numOfThreads != this->numOfThreads())
+		{
+			stopWorkers();
+			startWorkers(numOfThreads - 1);
+		}
+	}
+
+	/**
+	 * This method runs task(0), ..., task(numOfTasks - 1) on the threads of the pool and returns
+	 * when all of them are done. A call from inside a task runs serially, so nested parallel
+	 * operations cannot deadlock. If tasks throw, the first exception is rethrown here.
+	 * @param numOfTasks - the number of tasks.
+	 * @param task - the function which runs a task, given its index.
+	 */
+	void parallelFor(std::size_t numOfTasks, const std::function<void(std::size_t)>& task)
+	{
+		if(numOfTasks <= 1 || _workers.empty() || isWorkerThread())
+		{
+			for(std::size_t taskIndex = 0 ; taskIndex < numOfTasks ; ++taskIndex)
+			{
+				task(taskIndex);
+			}
+			return;
+		}
+		std::shared_ptr<Batch> batch = std::make_shared<Batch>(numOfTasks, task);
+		std::size_t numOfHelpers = std::min(_workers.size(), numOfTasks - 1);
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			for(std::size_t helper = 0 ; helper < numOfHelpers ; ++helper)
+			{
+				_jobs.emplace_back([batch]
+				{
+					batch->run();
+				});
+			}
+		}
+		_jobAvailable.notify_all();
+		batch->run();
+		batch->wait();
+	}
+
+	/**
+	 * This method splits the range [0, size) into contiguous chunks and runs them on the threads
+	 * of the pool. Ranges shorter than twice the minimal chunk run serially on the caller.
+	 * @tparam Chunk - the type of the chunk function.
+	 * @param size - the size of the range.
+	 * @param minimalChunk - the minimal number of indices in a chunk.
+	 * @param chunk - the function which runs a chunk, given its begin and end indices.
+	 */
+	template <class Chunk>
+	void parallelRanges(std::size_t size, std::size_t minimalChunk, const Chunk& chunk)
+	{
+		std::size_t numOfChunks = numOfChunksOf(size, minimalChunk);
+		if(numOfChunks <= 1)
+		{
+			chunk(0, size);
+			return;
+		}
+		std::size_t chunkSize = (size + numOfChunks - 1) / numOfChunks;
+		parallelFor(numOfChunks, [&](std::size_t chunkIndex)
+		{
+			std::size_t begin = chunkIndex * chunkSize;
+			chunk(begin, std::min(size, begin + chunkSize));
+		});
+	}
+
+	/**
+	 * This method reduces the range [0, size) in parallel: it splits it into contiguous chunks
+	 * like parallelRanges, reduces every chunk on the threads of the pool, and combines the
+	 * partial results in the order of the chunks, so the result does not depend on which thread
+	 * ran which chunk.
+	 * @tparam Result - the type of the result.
+	 * @tparam Chunk - the type of the chunk function.
+	 * @tparam Combine - the type of the combine function.
+	 * @param size - the size of the range, which should be positive.
+	 * @param minimalChunk - the minimal number of indices in a chunk.
+	 * @param chunk - the function which reduces a chunk, given its begin and end indices.
+	 * @param combine - the function which combines two partial results.
+	 * @return the reduction of the range.
+	 */
+	template <class Result, class Chunk, class Combine>
+	Result parallelReduce(std::size_t size, std::size_t minimalChunk, const Chunk& chunk,
+						  const Combine& combine)
+	{
+		std::size_t numOfChunks = numOfChunksOf(size, minimalChunk);
+		if(numOfChunks <= 1)
+		{
+			return chunk(0, size);
+		}
+		std::size_t chunkSize = (size + numOfChunks - 1) / numOfChunks;
+		std::vector<Result> partialResults(numOfChunks);
+		parallelFor(numOfChunks, [&](std::size_t chunkIndex)
+		{
+			std::size_t begin = chunkIndex * chunkSize;
+			partialResults[chunkIndex] = chunk(begin, std::min(size, begin + chunkSize));
+		});
+		Result result = partialResults[0];
+		for(std::size_t chunkIndex = 1 ; chunkIndex < numOfChunks ; ++chunkIndex)
+		{
+			result = combine(result, partialResults[chunkIndex]);
+		}
+		return result;
+	}
+
+	private:
+
+	/**
+	 * This struct represents the tasks of one parallelFor call. Every thread takes the next task
+	 * index until none are left, and the caller waits until all of them are done.
+	 */
+	struct Batch
+	{
+		/**
+		 * This constructor initializes a batch of tasks.
+		 * @param numOfTasks - the number of tasks.
+		 * @param task - the function which runs a task, given its index.
+		 */
+		Batch(std::size_t numOfTasks, const std::function<void(std::size_t)>& task) :
+		numOfTasks(numOfTasks), task(task), nextTask(0), numOfDoneTasks(0)
+		{
+
+		}
+
+		/**
+		 * This method runs tasks of the batch until no task is left.
+		 */
+		void run()
+		{
+			for(std::size_t taskIndex = nextTask++ ; taskIndex < numOfTasks ;
+				taskIndex = nextTask++)
+			{
+				try
+				{
+					task(taskIndex);
+				}
+				catch(...)
+				{
+					std::lock_guard<std::mutex> lock(mutex);
+					if(!error)
+					{
+						error = std::current_exception();
+					}
+				}
+				std::lock_guard<std::mutex> lock(mutex);
+				if(++numOfDoneTasks == numOfTasks)
+				{
+					finished.notify_all();
+				}
+			}
+		}
+
+		/**
+		 * This method waits until all the tasks of the batch are done.
+		 * @throw the first exception which a task threw.
+		 */
+		void wait()
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			finished.wait(lock, [this]
+			{
+				return numOfDoneTasks == numOfTasks;
+			});
+			if(error)
+			{
+				std::rethrow_exception(error);
+			}
+		}
+
+		const std::size_t numOfTasks;
+		const std::function<void(std::size_t)>& task;
+		std::atomic<std::size_t> nextTask;
+		std::size_t numOfDoneTasks;
+		std::exception_ptr error;
+		std::mutex mutex;
+		std::condition_variable finished;
+	};
+
+	/**
+	 * This constructor starts the worker threads.
+	 * @param numOfThreads - the number of threads, including the calling thread.
+	 */
+	explicit ThreadPool(unsigned numOfThreads) : _stopping(false)
+	{
+		startWorkers(std::max(numOfThreads, (unsigned) MINIMAL_NUM_OF_THREADS) - 1);
+	}
+
+	/**
+	 * This method returns the number of chunks of a range: one per thread, unless the chunks
+	 * would be shorter than the minimal chunk.
+	 * @param size - the size of the range.
+	 * @param minimalChunk - the minimal number of indices in a chunk.
+	 * @return the number of chunks.
+	 */
+	std::size_t numOfChunksOf(std::size_t size, std::size_t minimalChunk) const
+	{
+		return std::min<std::size_t>(numOfThreads(), size / std::max<std::size_t>(minimalChunk, 1));
+	}
+
+	/**
+	 * This method returns the flag of the calling thread, which is true in worker threads.
+	 * @return a reference to the flag of the calling thread.
+	 */
+	static bool& isWorkerThread()
+	{
+		thread_local bool workerThread = false;
+		return workerThread;
+	}
+
+	/**
+	 * This method starts worker threads.
+	 * @param numOfWorkers - the number of worker threads.
+	 */
+	void startWorkers(unsigned numOfWorkers)
+	{
+		_stopping = false;
+		for(unsigned worker = 0 ; worker < numOfWorkers ; ++worker)
+		{
+			_workers.emplace_back([this]
+			{
+				isWorkerThread() = true;
+				workerLoop();
+			});
+		}
+		PerfCounters::threadsChanged();
+	}
+
+	/**
+	 * This method stops the worker threads after they finish the queued jobs.
+	 */
+	void stopWorkers()
+	{
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_stopping = true;
+		}
+		_jobAvailable.notify_all();
+		for(std::thread& worker : _workers)
+		{
+			worker.join();
+		}
+		_workers.clear();
+		PerfCounters::threadsChanged();
+	}
+
+	/**
+	 * This method is the loop of a worker thread: it runs queued jobs until the pool stops.
+	 */
+	void workerLoop()
+	{
+		while(true)
+		{
+			std::function<void()> job;
+			{
+				std::unique_lock<std::mutex> lock(_mutex);
+				_jobAvailable.wait(lock, [this]
+				{
+					return _stopping || !_jobs.empty();
+				});
+				if(_jobs.empty())
+				{
+					return;
+				}
+				job = std::move(_jobs.front());
+				_jobs.pop_front();
+			}
+			job();
+		}
+	}
+
+	/**
+	 * The worker threads.
+	 */
+	std::vector<std::thread> _workers;
+
+	/**
+	 * The queued jobs.
+	 */
+	std::deque<std::function<void()>> _jobs;
+
+	/**
+	 * The mutex which guards the queue and the stopping flag.
+	 */
+	std::mutex _mutex;
+
+	/**
+	 * Notified when a job is queued or the pool stops.
+	 */
+	std::condition_variable _jobAvailable;
+
+	/**
+	 * True if the workers should exit once the queue is empty.
+	 */
+	bool _stopping;
+
+};
+
+#endif
@@ -0,0 +1,1117 @@
+//================================ Includes =====================================================
+#include "Matrix.hpp"
+#include "MatrixIO.hpp"
+#include "MatrixView.hpp"
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+//================================ Constants ====================================================
+#ifndef CPP3_TILED_MATRIX_H
+#define CPP3_TILED_MATRIX_H
+#define TILED_MATRIX_DEFAULT_TILE_SIZE 1024u
+#define TILE_CACHE_DEFAULT_CAPACITY ((std :: size_t) 1 << 30)
+#define TILE_CACHE_DEFAULT_DIRECTORY "/tmp"
+#define TILE_FILE_NAME_TEMPLATE "/matrix-tiles-XXXXXX"
+#define TILE_FILE_CREATE_ERROR "Cannot create the tile file"
+#define TILE_FILE_READ_ERROR "Cannot read a tile from the tile file"
+#define TILE_FILE_WRITE_ERROR "Cannot write a tile to the tile file"
+#define TILE_SIZE_ERROR "The tile size should be positive and the same for both matrices"
+#define TILE_TYPE_ERROR "The coordinates of a tiled matrix must be trivially copyable"
+//================================ Code Segment =================================================
+
+/**
+ * This file adds out-of-core matrices, for matrices larger than the memory. A TiledMatrix<T> is
+ * split into square tiles of tileSize * tileSize coordinates, stored (row-major, the edge tiles
+ * padded with zeros) in an unlinked temporary file of a local directory. Tiles are read into a
+ * TileCache<T> when they are used and written back when they are evicted: the cache keeps the
+ * least recently used tiles up to its capacity in bytes, and is shared by all the matrices which
+ * use it. The cache has an I/O thread, so the operations schedule the reads of the next tiles
+ * (prefetch) and the writes of the finished ones (write-behind) while the current ones are
+ * computed - with the usual in-memory kernels on the global thread pool. A product pins three
+ * tiles and prefetches two more, so the capacity should hold at least five tiles; a capacity of
+ * a whole row of tiles of the left operand also saves reading it again for every column.
+ * Matrices are imported from (MappedMatrix) and exported to (save) the binary matrix files of
+ * MatrixIO.hpp. The tile files use POSIX pread and pwrite.
+ */
+
+/**
+ * This enum represents how a tile is used.
+ * Read - the tile is read.
+ * Write - the tile is read and written.
+ * Overwrite - the tile is written without being read: the caller writes all of it, or it was
+ * never written (and so it is zero).
+ */
+enum class TileAccess
+{
+	Read,
+	Write,
+	Overwrite
+};
+
+/**
+ * This class represents the file of the tiles of a matrix. It is created unlinked, so it is
+ * removed when it is closed, and sparse, so the tiles which are never written are zeros and take
+ * no space on the disk.
+ * @tparam T - the coordinate type.
+ */
+template <class T> class TileFile
+{
+	static_assert(std :: is_trivially_copyable<T>::value, TILE_TYPE_ERROR);
+
+	public:
+
+	/**
+	 * This constructor creates the file of the tiles.
+	 * @param directory - the directory of the file.
+	 * @param numOfTiles - number of tiles.
+	 * @param tileSize - number of rows (and columns) of a tile.
+	 * @throw runtime error if the file cannot be created.
+	 */
+	TileFile(const std :: string& directory, std :: size_t numOfTiles, unsigned int tileSize) :
+	_tileSize(tileSize)
+	{
+		std :: string path = directory + TILE_FILE_NAME_TEMPLATE;
+		_descriptor = mkstemp(&path[0]);
+		if(_descriptor < 0)
+		{
+			throw std :: runtime_error(TILE_FILE_CREATE_ERROR);
+		}
+		unlink(path.c_str());
+		if(ftruncate(_descriptor, (off_t) (numOfTiles * tileBytes())) != 0)
+		{
+			close(_descriptor);
+			throw std :: runtime_error(TILE_FILE_CREATE_ERROR);
+		}
+	}
+
+	/**
+	 * This destructor closes (and so removes) the file.
+	 */
+	~TileFile()
+	{
+		close(_descriptor);
+	}
+
+	TileFile(const TileFile&) = delete;
+
+	TileFile& operator=(const TileFile&) = delete;
+
+	/**
+	 * This method returns number of rows (and columns) of a tile.
+	 * @return the tile size.
+	 */
+	unsigned int tileSize() const
+	{
+		return _tileSize;
+	}
+
+	/**
+	 * This method returns the size of a tile in the file.
+	 * @return the size of a tile in bytes.
+	 */
+	std :: size_t tileBytes() const
+	{
+		return (std :: size_t) _tileSize * _tileSize * sizeof(T);
+	}
+
+	/**
+	 * This method reads a tile.
+	 * @param index - the index of the tile.
+	 * @param coords - the storage of the tile.
+	 * @throw runtime error if the tile cannot be read.
+	 */
+	void read(std :: size_t index, T* coords) const
+	{
+		char* bytes = (char*) coords;
+		std :: size_t done = 0;
+		while(done < tileBytes())
+		{
+			ssize_t count = pread(_descriptor, bytes + done, tileBytes() - done,
+								  (off_t) (index * tileBytes() + done));
+			if(count <= 0)
+			{
+				throw std :: runtime_error(TILE_FILE_READ_ERROR);
+			}
+			done += (std :: size_t) count;
+		}
+	}
+
+	/**
+	 * This method writes a tile.
+	 * @param index - the index of the tile.
+	 * @param coords - the storage of the tile.
+	 * @throw runtime error if the tile cannot be written.
+	 */
+	void write(std :: size_t index, const T* coords) const
+	{
+		const char* bytes = (const char*) coords;
+		std :: size_t done = 0;
+		while(done < tileBytes())
+		{
+			ssize_t count = pwrite(_descriptor, bytes + done, tileBytes() - done,
+								   (off_t) (index * tileBytes() + done));
+			if(count <= 0)
+			{
+				throw std :: runtime_error(TILE_FILE_WRITE_ERROR);
+			}
+			done += (std :: size_t) count;
+		}
+	}
+
+	private:
+
+	/**
+	 * The descriptor of the file.
+	 */
+	int _descriptor;
+
+	/**
+	 * Number of rows (and columns) of a tile.
+	 */
+	unsigned int _tileSize;
+
+};
+
+/**
+ * This class represents an LRU cache of tiles, shared by the tiled matrices which use it. A tile
+ * is acquired as a shared pointer, and it is pinned - not evicted - until all its pointers are
+ * released. Dirty tiles are written back when they are evicted, or earlier by writeBehind(). The
+ * cache must outlive its matrices.
+ * @tparam T - the coordinate type.
+ */
+template <class T> class TileCache
+{
+	public:
+
+	typedef Matrix<T> Tile;
+
+	/**
+	 * This constructor initializes a cache and starts its I/O thread.
+	 * @param capacity - the capacity of the cache in bytes.
+	 * @param directory - the directory of the tile files.
+	 */
+	explicit TileCache(std :: size_t capacity = TILE_CACHE_DEFAULT_CAPACITY,
+					   const std :: string& directory = TILE_CACHE_DEFAULT_DIRECTORY) :
+	_capacity(capacity), _directory(directory), _busyFile(nullptr), _numOfEvictionWrites(0),
+	_isStopping(false), _numOfBytes(0), _numOfHits(0), _numOfMisses(0),
+	_thread(&TileCache::run, this)
+	{
+		PerfCounters::threadsChanged();
+	}
+
+	/**
+	 * This destructor stops the I/O thread.
+	 */
+	~TileCache()
+	{
+		{
+			std :: lock_guard<std :: mutex> lock(_mutex);
+			_isStopping = true;
+		}
+		_requested.notify_all();
+		_thread.join();
+		PerfCounters::threadsChanged();
+	}
+
+	TileCache(const TileCache&) = delete;
+
+	TileCache& operator=(const TileCache&) = delete;
+
+	/**
+	 * This method returns the directory of the tile files.
+	 * @return the directory.
+	 */
+	const std :: string& directory() const
+	{
+		return _directory;
+	}
+
+	/**
+	 * This method returns the capacity of the cache.
+	 * @return the capacity in bytes.
+	 */
+	std :: size_t capacity() const
+	{
+		std :: lock_guard<std :: mutex> lock(_mutex);
+		return _capacity;
+	}
+
+	/**
+	 * This method sets the capacity of the cache, and evicts tiles down to it.
+	 * @param capacity - the capacity in bytes.
+	 * @throw runtime error if an evicted tile cannot be written back.
+	 */
+	void setCapacity(std :: size_t capacity)
+	{
+		std :: unique_lock<std :: mutex> lock(_mutex);
+		_capacity = capacity;
+		evict(lock);
+	}
+
+	/**
+	 * This method returns the size of the cached tiles. It is above the capacity when more tiles
+	 * are pinned.
+	 * @return the size in bytes.
+	 */
+	std :: size_t size() const
+	{
+		std :: lock_guard<std :: mutex> lock(_mutex);
+		return _numOfBytes;
+	}
+
+	/**
+	 * This method returns number of tiles which were acquired from the cache.
+	 * @return number of hits.
+	 */
+	std :: size_t hits() const
+	{
+		std :: lock_guard<std :: mutex> lock(_mutex);
+		return _numOfHits;
+	}
+
+	/**
+	 * This method returns number of tiles which were acquired before they were cached, and so
+	 * waited for them to be read.
+	 * @return number of misses.
+	 */
+	std :: size_t misses() const
+	{
+		std :: lock_guard<std :: mutex> lock(_mutex);
+		return _numOfMisses;
+	}
+
+	/**
+	 * This method acquires a tile, and reads it if it is not cached. If it is being prefetched,
+	 * it waits for it.
+	 * @param file - the tile file.
+	 * @param index - the index of the tile.
+	 * @param access - how the tile is used.
+	 * @return the tile, pinned until it is released.
+	 * @throw runtime error if the tile cannot be read, or an evicted tile cannot be written back.
+	 */
+	std :: shared_ptr<Tile> acquire(const TileFile<T>& file, std :: size_t index,
+									TileAccess access)
+	{
+		std :: unique_lock<std :: mutex> lock(_mutex);
+		Key key(&file, index);
+		for(auto found = _entries.find(key) ; found != _entries.end() ; found = _entries.find(key))
+		{
+			if(found->second.isLoaded)
+			{
+				++_numOfHits;
+				_lru.splice(_lru.begin(), _lru, found->second.position);
+				found->second.isDirty |= access != TileAccess::Read;
+				return found->second.tile;
+			}
+			_changed.wait(lock);
+		}
+		++_numOfMisses;
+		std :: shared_ptr<Tile> tile = load(lock, key, access != TileAccess::Overwrite);
+		_entries.at(key).isDirty = access != TileAccess::Read;
+		return tile;
+	}
+
+	/**
+	 * This method asks the I/O thread to read a tile, if it is not cached.
+	 * @param file - the tile file.
+	 * @param index - the index of the tile.
+	 */
+	void prefetch(const TileFile<T>& file, std :: size_t index)
+	{
+		request({&file, index, RequestKind::Load});
+	}
+
+	/**
+	 * This method asks the I/O thread to write a tile back, if it is dirty. The tile stays
+	 * cached, and clean, so evicting it costs nothing.
+	 * @param file - the tile file.
+	 * @param index - the index of the tile.
+	 */
+	void writeBehind(const TileFile<T>& file, std :: size_t index)
+	{
+		request({&file, index, RequestKind::Store});
+	}
+
+	/**
+	 * This method removes the tiles of a file from the cache, without writing them, and cancels
+	 * their requests. The tiles must not be pinned.
+	 * @param file - the tile file.
+	 */
+	void drop(const TileFile<T>& file)
+	{
+		std :: unique_lock<std :: mutex> lock(_mutex);
+		_requests.erase(std :: remove_if(_requests.begin(), _requests.end(),
+										 [&file](const Request& request)
+										 {
+											 return request.file == &file;
+										 }), _requests.end());
+		_changed.wait(lock, [this, &file]()
+		{
+			return _busyFile != &file && _numOfEvictionWrites == 0;
+		});
+		auto entry = _entries.lower_bound(Key(&file, 0));
+		while(entry != _entries.end() && entry->first.first == &file)
+		{
+			_numOfBytes -= file.tileBytes();
+			_lru.erase(entry->second.position);
+			entry = _entries.erase(entry);
+		}
+	}
+
+	private:
+
+	typedef std :: pair<const TileFile<T>*, std :: size_t> Key;
+
+	/**
+	 * This enum represents the requests of the I/O thread.
+	 */
+	enum class RequestKind
+	{
+		Load,
+		Store
+	};
+
+	/**
+	 * This struct represents a request of the I/O thread.
+	 */
+	struct Request
+	{
+		const TileFile<T>* file;
+		std :: size_t index;
+		RequestKind kind;
+	};
+
+	/**
+	 * This struct represents a cached tile.
+	 */
+	struct Entry
+	{
+		std :: shared_ptr<Tile> tile;
+		bool isLoaded;
+		bool isDirty;
+		typename std :: list<Key>::iterator position;
+	};
+
+	/**
+	 * This method queues a request of the I/O thread, unless it is already queued.
+	 * @param request - the request.
+	 */
+	void request(const Request& request)
+	{
+		{
+			std :: lock_guard<std :: mutex> lock(_mutex);
+			for(const Request& queued : _requests)
+			{
+				if(queued.file == request.file && queued.index == request.index &&
+				   queued.kind == request.kind)
+				{
+					return;
+				}
+			}
+			_requests.push_back(request);
+		}
+		_requested.notify_one();
+	}
+
+	/**
+	 * This method caches a tile which is not cached. It reads the tile without the lock, while
+	 * the tile is marked as not loaded, so other threads wait for it.
+	 * @param lock - the lock of the cache.
+	 * @param key - the tile.
+	 * @param isRead - true to read the tile, false to start from zeros.
+	 * @return the tile.
+	 * @throw runtime error if the tile cannot be read, or an evicted tile cannot be written back.
+	 */
+	std :: shared_ptr<Tile> load(std :: unique_lock<std :: mutex>& lock, const Key& key,
+								 bool isRead)
+	{
+		const TileFile<T>& file = *(key.first);
+		std :: shared_ptr<Tile> tile = std :: make_shared<Tile>(file.tileSize(), file.tileSize());
+		_lru.push_front(key);
+		_entries[key] = Entry{tile, false, false, _lru.begin()};
+		_numOfBytes += file.tileBytes();
+		try
+		{
+			evict(lock);
+			if(isRead)
+			{
+				lock.unlock();
+				file.read(key.second, tile->data());
+				lock.lock();
+			}
+		}
+		catch(...)
+		{
+			if(!lock.owns_lock())
+			{
+				lock.lock();
+			}
+			_numOfBytes -= file.tileBytes();
+			_lru.erase(_entries.at(key).position);
+			_entries.erase(key);
+			_changed.notify_all();
+			throw;
+		}
+		_entries.at(key).isLoaded = true;
+		_changed.notify_all();
+		return tile;
+	}
+
+	/**
+	 * This method evicts the least recently used tiles which are not pinned, while the cache is
+	 * above its capacity. A dirty tile is written back without the lock, while it is marked as
+	 * not loaded, so other threads wait for it instead of reading the stale tile from the file,
+	 * and the rest of the cache is not blocked by the write.
+	 * @param lock - the lock of the cache, which is held when the method is called and returns.
+	 * @throw runtime error if a dirty tile cannot be written back.
+	 */
+	void evict(std :: unique_lock<std :: mutex>& lock)
+	{
+		auto position = _lru.end();
+		while(_numOfBytes > _capacity && position != _lru.begin())
+		{
+			--position;
+			Entry& entry = _entries.at(*position);
+			if(!entry.isLoaded || entry.tile.use_count() > 1)
+			{
+				continue;
+			}
+			Key key = *position;
+			const TileFile<T>& file = *(key.first);
+			if(entry.isDirty)
+			{
+				std :: shared_ptr<Tile> tile = entry.tile;
+				entry.isLoaded = false;
+				++_numOfEvictionWrites;
+				lock.unlock();
+				try
+				{
+					file.write(key.second, tile->data());
+				}
+				catch(...)
+				{
+					lock.lock();
+					--_numOfEvictionWrites;
+					_entries.at(key).isLoaded = true;
+					_changed.notify_all();
+					throw;
+				}
+				lock.lock();
+				--_numOfEvictionWrites;
+				_changed.notify_all();
+				// the list may have changed while the lock was released, but not this entry:
+				// it was neither loaded nor acquired, and drop waits for the write
+				position = _entries.at(key).position;
+			}
+			_numOfBytes -= file.tileBytes();
+			_entries.erase(key);
+			position = _lru.erase(position);
+		}
+	}
+
+	/**
+	 * This method runs the I/O thread. A failed prefetch is only retried by the acquire of the
+	 * tile, and a tile whose write-behind failed stays dirty.
+	 */
+	void run()
+	{
+		std :: unique_lock<std :: mutex> lock(_mutex);
+		while(true)
+		{
+			_requested.wait(lock, [this]()
+			{
+				return _isStopping || !_requests.empty();
+			});
+			if(_isStopping)
+			{
+				return;
+			}
+			Request request = _requests.front();
+			_requests.pop_front();
+			Key key(request.file, request.index);
+			_busyFile = request.file;
+			try
+			{
+				auto found = _entries.find(key);
+				if(request.kind == RequestKind::Load && found == _entries.end())
+				{
+					load(lock, key, true);
+				}
+				else if(request.kind == RequestKind::Store && found != _entries.end() &&
+						found->second.isLoaded && found->second.isDirty)
+				{
+					std :: shared_ptr<Tile> tile = found->second.tile;
+					found->second.isDirty = false;
+					lock.unlock();
+					try
+					{
+						request.file->write(request.index, tile->data());
+					}
+					catch(...)
+					{
+						lock.lock();
+						_entries.at(key).isDirty = true;
+						throw;
+					}
+					lock.lock();
+				}
+			}
+			catch(...)
+			{
+				if(!lock.owns_lock())
+				{
+					lock.lock();
+				}
+			}
+			_busyFile = nullptr;
+			_changed.notify_all();
+		}
+	}
+
+	/**
+	 * The capacity of the cache in bytes.
+	 */
+	std :: size_t _capacity;
+
+	/**
+	 * The directory of the tile files.
+	 */
+	std :: string _directory;
+
+	/**
+	 * The mutex of the cache.
+	 */
+	mutable std :: mutex _mutex;
+
+	/**
+	 * Notified when a tile is loaded or a request is done.
+	 */
+	std :: condition_variable _changed;
+
+	/**
+	 * Notified when a request is queued.
+	 */
+	std :: condition_variable _requested;
+
+	/**
+	 * The cached tiles.
+	 */
+	std :: map<Key, Entry> _entries;
+
+	/**
+	 * The cached tiles, from the most recently used.
+	 */
+	std :: list<Key> _lru;
+
+	/**
+	 * The requests of the I/O thread.
+	 */
+	std :: deque<Request> _requests;
+
+	/**
+	 * The file of the request the I/O thread runs, if any.
+	 */
+	const TileFile<T>* _busyFile;
+
+	/**
+	 * Number of evicted tiles which are being written back.
+	 */
+	std :: size_t _numOfEvictionWrites;
+
+	/**
+	 * True when the I/O thread should stop.
+	 */
+	bool _isStopping;
+
+	/**
+	 * The size of the cached tiles in bytes.
+	 */
+	std :: size_t _numOfBytes;
+
+	/**
+	 * Number of hits.
+	 */
+	std :: size_t _numOfHits;
+
+	/**
+	 * Number of misses.
+	 */
+	std :: size_t _numOfMisses;
+
+	/**
+	 * The I/O thread.
+	 */
+	std :: thread _thread;
+
+};
+
+/**
+ * This class represents an out-of-core matrix: its tiles are on the disk, and in a TileCache
+ * while they are used.
+ * @tparam T - the coordinate type.
+ */
+template <class T> class TiledMatrix
+{
+	public:
+
+	typedef Matrix<T> Tile;
+
+	/**
+	 * This constructor initializes a tiled matrix of zeros.
+	 * @param rows - number of rows in the matrix.
+	 * @param cols - number of columns in the matrix.
+	 * @param cache - the tile cache, which must outlive the matrix.
+	 * @param tileSize - number of rows (and columns) of a tile.
+	 * @throw invalid argument error if not positive.
+	 * @throw runtime error if the tile file cannot be created.
+	 */
+	TiledMatrix(unsigned int rows, unsigned int cols, TileCache<T>& cache,
+				unsigned int tileSize = TILED_MATRIX_DEFAULT_TILE_SIZE) : _cache(&cache),
+	_numOfRows(rows), _numOfCols(cols), _tileSize(tileSize)
+	{
+		if(!((int) rows > 0 && (int) cols > 0))
+		{
+			throw std :: invalid_argument(INVALID_ARGUMENT_ERROR);
+		}
+		if(!((int) tileSize > 0))
+		{
+			throw std :: invalid_argument(TILE_SIZE_ERROR);
+		}
+		_numOfTileRows = (rows + tileSize - 1) / tileSize;
+		_numOfTileCols = (cols + tileSize - 1) / tileSize;
+		_file.reset(new TileFile<T>(cache.directory(),
+									(std :: size_t) _numOfTileRows * _numOfTileCols, tileSize));
+	}
+
+	/**
+	 * This constructor copies a view - of a matrix, or of a MappedMatrix for a matrix file
+	 * larger than the memory - into a tiled matrix.
+	 * @param source - the view.
+	 * @param cache - the tile cache, which must outlive the matrix.
+	 * @param tileSize - number of rows (and columns) of a tile.
+	 * @throw runtime error if the tile file cannot be created or written.
+	 */
+	TiledMatrix(const ConstMatrixView<T>& source, TileCache<T>& cache,
+				unsigned int tileSize = TILED_MATRIX_DEFAULT_TILE_SIZE) :
+	TiledMatrix(source.rows(), source.cols(), cache, tileSize)
+	{
+		for(unsigned int tileRow = 0 ; tileRow < _numOfTileRows ; ++tileRow)
+		{
+			for(unsigned int tileCol = 0 ; tileCol < _numOfTileCols ; ++tileCol)
+			{
+				std :: shared_ptr<Tile> target = tile(tileRow, tileCol, TileAccess::Overwrite);
+				view(*target).block(0, 0, rowsOf(tileRow), colsOf(tileCol)) =
+					source.block(tileRow * _tileSize, tileCol * _tileSize, rowsOf(tileRow),
+								 colsOf(tileCol));
+				target.reset();
+				_cache->writeBehind(*_file, indexOf(tileRow, tileCol));
+			}
+		}
+	}
+
+	/**
+	 * This constructor is a move constructor. m is left without tiles, and can only be
+	 * destroyed.
+	 * @param m - the tiled matrix that we move from.
+	 */
+	TiledMatrix(TiledMatrix&& m) noexcept = default;
+
+	/**
+	 * This destructor drops the tiles of the matrix from the cache and removes its file.
+	 */
+	~TiledMatrix()
+	{
+		if(_file)
+		{
+			_cache->drop(*_file);
+		}
+	}
+
+	TiledMatrix(const TiledMatrix&) = delete;
+
+	TiledMatrix& operator=(const TiledMatrix&) = delete;
+
+	/**
+	 * This method returns number of rows in the matrix.
+	 * @return number of rows in the matrix.
+	 */
+	unsigned int rows() const
+	{
+		return _numOfRows;
+	}
+
+	/**
+	 * This method returns number of columns in the matrix.
+	 * @return number of columns in the matrix.
+	 */
+	unsigned int cols() const
+	{
+		return _numOfCols;
+	}
+
+	/**
+	 * This method returns number of rows (and columns) of a tile.
+	 * @return the tile size.
+	 */
+	unsigned int tileSize() const
+	{
+		return _tileSize;
+	}
+
+	/**
+	 * This method returns a coordinate. It acquires its tile, so it is only meant for a few
+	 * coordinates; block() copies many of them.
+	 * @param row - the coordinate row.
+	 * @param column - the coordinate column.
+	 * @return coordinate (row, column).
+	 * @throw out of range exception of index out of bounds.
+	 */
+	T get(unsigned int row, unsigned int column) const
+	{
+		checkIndex(row, column);
+		return tile(row / _tileSize, column / _tileSize, TileAccess::Read)->at_unchecked(
+			row % _tileSize, column % _tileSize);
+	}
+
+	/**
+	 * This method sets a coordinate.
+	 * @param row - the coordinate row.
+	 * @param column - the coordinate column.
+	 * @param value - the value.
+	 * @throw out of range exception of index out of bounds.
+	 */
+	void set(unsigned int row, unsigned int column, const T& value)
+	{
+		checkIndex(row, column);
+		tile(row / _tileSize, column / _tileSize, TileAccess::Write)->at_unchecked(
+			row % _tileSize, column % _tileSize) = value;
+	}
+
+	/**
+	 * This method copies a block of the matrix into memory.
+	 * @param row - the first row of the block.
+	 * @param col - the first column of the block.
+	 * @param rows - number of rows of the block.
+	 * @param cols - number of columns of the block.
+	 * @return the block.
+	 * @throw out of range exception if the block is not inside the matrix.
+	 */
+	Matrix<T> block(unsigned int row, unsigned int col, unsigned int rows,
+					unsigned int cols) const
+	{
+		if(rows == 0 || cols == 0 || rows > _numOfRows || row > _numOfRows - rows ||
+		   cols > _numOfCols || col > _numOfCols - cols)
+		{
+			throw std :: out_of_range(INDEX_OUT_OF_BOUNDS_ERROR);
+		}
+		Matrix<T> result(rows, cols);
+		for(unsigned int tileRow = row / _tileSize ; tileRow * _tileSize < row + rows ; ++tileRow)
+		{
+			unsigned int first = std :: max(row, tileRow * _tileSize);
+			unsigned int last = std :: min(row + rows, tileRow * _tileSize + rowsOf(tileRow));
+			for(unsigned int tileCol = col / _tileSize ; tileCol * _tileSize < col + cols ;
+				++tileCol)
+			{
+				unsigned int left = std :: max(col, tileCol * _tileSize);
+				unsigned int right = std :: min(col + cols, tileCol * _tileSize + colsOf(tileCol));
+				std :: shared_ptr<Tile> source = tile(tileRow, tileCol, TileAccess::Read);
+				view(result).block(first - row, left - col, last - first, right - left) =
+					view(*source).block(first - tileRow * _tileSize, left - tileCol * _tileSize,
+										last - first, right - left);
+			}
+		}
+		return result;
+	}
+
+	/**
+	 * This method saves the matrix to a row-major matrix file (see MatrixIO.hpp) a tile at a
+	 * time, each tile written at its place in the file, while the next tile is prefetched. So
+	 * only one tile is pinned, whatever the number of tiles in a row.
+	 * @param path - the path of the file.
+	 * @throw runtime error if a tile cannot be read or the file cannot be written.
+	 */
+	void save(const std :: string& path) const
+	{
+		ChunkedMatrixWriter<T> writer(path, _numOfRows, _numOfCols);
+		std :: size_t numOfTiles = (std :: size_t) _numOfTileRows * _numOfTileCols;
+		for(std :: size_t index = 0 ; index < numOfTiles ; ++index)
+		{
+			if(index + 1 < numOfTiles)
+			{
+				_cache->prefetch(*_file, index + 1);
+			}
+			unsigned int tileRow = (unsigned int) (index / _numOfTileCols);
+			unsigned int tileCol = (unsigned int) (index % _numOfTileCols);
+			std :: shared_ptr<Tile> source = tile(tileRow, tileCol, TileAccess::Read);
+			writer.writeBlock(tileRow * _tileSize, tileCol * _tileSize,
+							  view(*source).block(0, 0, rowsOf(tileRow), colsOf(tileCol)));
+		}
+		writer.close();
+	}
+
+	/**
+	 * This method adds a tiled matrix to this one, a tile at a time, while the next tiles are
+	 * prefetched and the finished ones are written behind.
+	 * @param m - the tiled matrix.
+	 * @return this matrix.
+	 * @throw invalid argument error if the dimensions or tile sizes are not the same.
+	 * @throw runtime error if a tile cannot be read or written.
+	 */
+	TiledMatrix& operator+=(const TiledMatrix& m)
+	{
+		checkSameShape(m);
+		forEachTile([this, &m](unsigned int tileRow, unsigned int tileCol)
+		{
+			std :: shared_ptr<Tile> target = tile(tileRow, tileCol, TileAccess::Write);
+			*target += *(m.tile(tileRow, tileCol, TileAccess::Read));
+		}, m, *this);
+		return *(this);
+	}
+
+	/**
+	 * This method adds two tiled matrices, like operator+=.
+	 * @param m - the tiled matrix.
+	 * @return the sum, in the same cache.
+	 * @throw invalid argument error if the dimensions or tile sizes are not the same.
+	 * @throw runtime error if a tile cannot be read or written.
+	 */
+	TiledMatrix operator+(const TiledMatrix& m) const
+	{
+		checkSameShape(m);
+		TiledMatrix result(_numOfRows, _numOfCols, *_cache, _tileSize);
+		forEachTile([this, &m, &result](unsigned int tileRow, unsigned int tileCol)
+		{
+			std :: shared_ptr<Tile> target = result.tile(tileRow, tileCol, TileAccess::Overwrite);
+			*target = *(tile(tileRow, tileCol, TileAccess::Read));
+			*target += *(m.tile(tileRow, tileCol, TileAccess::Read));
+		}, m, result);
+		return result;
+	}
+
+	/**
+	 * This method multiplies two tiled matrices. Every tile of the product accumulates the
+	 * products of a row of tiles of this matrix and a column of tiles of m, with the parallel
+	 * GEMM, while the next pair of tiles is prefetched; the finished tile is written behind.
+	 * @param m - the tiled matrix.
+	 * @return the product, in the same cache.
+	 * @throw invalid argument error if the dimensions do not match or the tile sizes are not the
+	 * same.
+	 * @throw runtime error if a tile cannot be read or written.
+	 */
+	TiledMatrix operator*(const TiledMatrix& m) const
+	{
+		if(_numOfCols != m._numOfRows)
+		{
+			throw std :: invalid_argument(INVALID_MULTIPLICATION_OF_MATRICES_ERROR);
+		}
+		if(_tileSize != m._tileSize)
+		{
+			throw std :: invalid_argument(TILE_SIZE_ERROR);
+		}
+		TiledMatrix result(_numOfRows, m._numOfCols, *_cache, _tileSize);
+		for(unsigned int tileRow = 0 ; tileRow < _numOfTileRows ; ++tileRow)
+		{
+			for(unsigned int tileCol = 0 ; tileCol < m._numOfTileCols ; ++tileCol)
+			{
+				std :: shared_ptr<Tile> target = result.tile(tileRow, tileCol,
+															 TileAccess::Overwrite);
+				for(unsigned int depth = 0 ; depth < _numOfTileCols ; ++depth)
+				{
+					if(depth + 1 < _numOfTileCols)
+					{
+						prefetch(tileRow, depth + 1);
+						m.prefetch(depth + 1, tileCol);
+					}
+					else if(tileCol + 1 < m._numOfTileCols)
+					{
+						prefetch(tileRow, 0);
+						m.prefetch(0, tileCol + 1);
+					}
+					else if(tileRow + 1 < _numOfTileRows)
+					{
+						prefetch(tileRow + 1, 0);
+						m.prefetch(0, 0);
+					}
+					std :: shared_ptr<Tile> left = tile(tileRow, depth, TileAccess::Read);
+					std :: shared_ptr<Tile> right = m.tile(depth, tileCol, TileAccess::Read);
+					view(*target) += view(*left) * view(*right);
+				}
+				target.reset();
+				_cache->writeBehind(*(result._file), result.indexOf(tileRow, tileCol));
+			}
+		}
+		return result;
+	}
+
+	private:
+
+	/**
+	 * This method returns the index of a tile in the tile file.
+	 * @param tileRow - the row of the tile.
+	 * @param tileCol - the column of the tile.
+	 * @return the index of the tile.
+	 */
+	std :: size_t indexOf(unsigned int tileRow, unsigned int tileCol) const
+	{
+		return (std :: size_t) tileRow * _numOfTileCols + tileCol;
+	}
+
+	/**
+	 * This method returns number of rows of the matrix in a row of tiles, which is less than
+	 * the tile size in the last one.
+	 * @param tileRow - the row of tiles.
+	 * @return number of rows.
+	 */
+	unsigned int rowsOf(unsigned int tileRow) const
+	{
+		return std :: min(_tileSize, _numOfRows - tileRow * _tileSize);
+	}
+
+	/**
+	 * This method returns number of columns of the matrix in a column of tiles.
+	 * @param tileCol - the column of tiles.
+	 * @return number of columns.
+	 */
+	unsigned int colsOf(unsigned int tileCol) const
+	{
+		return std :: min(_tileSize, _numOfCols - tileCol * _tileSize);
+	}
+
+	/**
+	 * This method acquires a tile from the cache.
+	 * @param tileRow - the row of the tile.
+	 * @param tileCol - the column of the tile.
+	 * @param access - how the tile is used.
+	 * @return the tile, pinned until it is released.
+	 */
+	std :: shared_ptr<Tile> tile(unsigned int tileRow, unsigned int tileCol,
+								 TileAccess access) const
+	{
+		return _cache->acquire(*_file, indexOf(tileRow, tileCol), access);
+	}
+
+	/**
+	 * This method asks the cache to prefetch a tile.
+	 * @param tileRow - the row of the tile.
+	 * @param tileCol - the column of the tile.
+	 */
+	void prefetch(unsigned int tileRow, unsigned int tileCol) const
+	{
+		_cache->prefetch(*_file, indexOf(tileRow, tileCol));
+	}
+
+	/**
+	 * This method runs an elementwise operation tile by tile: it prefetches the next tiles of
+	 * this matrix and m, runs the operation, and writes the tile of the result behind.
+	 * @tparam Operation - the type of the operation.
+	 * @param operation - the operation of a tile, given its row and column.
+	 * @param m - the other operand.
+	 * @param result - the result.
+	 */
+	template <class Operation> void forEachTile(Operation operation, const TiledMatrix& m,
+												TiledMatrix& result) const
+	{
+		for(unsigned int tileRow = 0 ; tileRow < _numOfTileRows ; ++tileRow)
+		{
+			for(unsigned int tileCol = 0 ; tileCol < _numOfTileCols ; ++tileCol)
+			{
+				std :: size_t next = indexOf(tileRow, tileCol) + 1;
+				if(next < (std :: size_t) _numOfTileRows * _numOfTileCols)
+				{
+					_cache->prefetch(*_file, next);
+					m._cache->prefetch(*(m._file), next);
+				}
+				operation(tileRow, tileCol);
+				result._cache->writeBehind(*(result._file), indexOf(tileRow, tileCol));
+			}
+		}
+	}
+
+	/**
+	 * This method checks that a tiled matrix has the dimensions and tile size of this one.
+	 * @param m - the tiled matrix.
+	 * @throw invalid argument error if not.
+	 */
+	void checkSameShape(const TiledMatrix& m) const
+	{
+		if(_numOfRows != m._numOfRows || _numOfCols != m._numOfCols)
+		{
+			throw std :: invalid_argument(INCOMPATIBLE_DIMENSIONS_OF_MATRICES_ERROR);
+		}
+		if(_tileSize != m._tileSize)
+		{
+			throw std :: invalid_argument(TILE_SIZE_ERROR);
+		}
+	}
+
+	/**
+	 * This method checks if a coordinate is inside the matrix, unless MATRIX_BOUNDS_CHECK is 0.
+	 * @param row - the coordinate row.
+	 * @param column - the coordinate column.
+	 * @throw out of range exception of index out of bounds.
+	 */
+	void checkIndex(unsigned int row, unsigned int column) const
+	{
+#if MATRIX_BOUNDS_CHECK
+		if(!(column < _numOfCols && row < _numOfRows))
+		{
+			throw std :: out_of_range(INDEX_OUT_OF_BOUNDS_ERROR);
+		}
+#else
+		(void) row;
+		(void) column;
+#endif
+	}
+
+	/**
+	 * The tile file. It is held by pointer, so its address - the key of its tiles in the cache -
+	 * does not change when the matrix is moved.
+	 */
+	std :: unique_ptr<TileFile<T>> _file;
+
+	/**
+	 * The tile cache.
+	 */
+	TileCache<T>* _cache;
+
+	/**
+	 * Number of rows in the matrix.
+	 */
+	unsigned int _numOfRows;
+
+	/**
+	 * Number of columns in the matrix.
+	 */
+	unsigned int _numOfCols;
+
+	/**
+	 * Number of rows (and columns) of a tile.
+	 */
+	unsigned int _tileSize;
+
+	/**
+	 * Number of rows of tiles.
+	 */
+	unsigned int _numOfTileRows;
+
+	/**
+	 * Number of columns of tiles.
+	 */
+	unsigned int _numOfTileCols;
+
+};
+
+#endif
@@ -1,100 +1,646 @@
 //================================ Includes =====================================================
-#include <string>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <complex>
 #include <cstdlib>
-#include <cassert>
-#include <cstdio>
-#include <cstring>
-#include <fstream>
 #include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
 #include <vector>
-#include <stack>
-#include <ctime>
-#include <chrono>
 #include "Complex.h"
+#include "LinearSolvers.hpp"
 #include "Matrix.hpp"
+#include "MatrixView.hpp"
+#include "PerfCounters.hpp"
+#include "StrassenKernels.hpp"
+#include "ThreadPool.hpp"
 #include <eigen3/Eigen/Dense>
 //================================ Constants ====================================================
-#define MAX_SIZE_OF_SQUARED_MATRIX 500
+#define MAX_SIZE_OF_SQUARED_MATRIX 4096
 #define MIN_SIZE_OF_SQUARED_MATRIX 1
-#define NUM_OF_ARGS 2
+#define MAX_NUM_OF_REPETITIONS 1000
+#define MIN_NUM_OF_ARGS 2
+#define MAX_NUM_OF_ARGS 4
 #define INDEX_OF_SIZE_OF_MATRIX_ARGUMENT 1
-#define TESTED_MATRIX_CELL_VALUE 1
-#define OUT_OF_RANGE_SIZE_USAGE_ERROR "Usage: size of matrix should be an int in range 1 to 500"
-#define WRONG_NUMBER_OF_ARGS_USAGE_ERROR "Usage: One positive int is required (size of matrix)"
-#define PRINT_SIZE_TITLE "size "
-#define PRINT_EIGEN_MULT_TITLE "eigen mult "
-#define PRINT_EIGEN_ADD_TITLE "eigen add "
-#define PRINT_MATLIB_MULT_TITLE "matlib mult "
-#define PRINT_MATLIB_ADD_TITLE "matlib add "
+#define INDEX_OF_FORMAT_ARGUMENT 2
+#define INDEX_OF_REPETITIONS_ARGUMENT 3
+#define FIRST_SWEEP_SIZE 32
+#define DEFAULT_NUM_OF_REPETITIONS 10
+#define MIN_NUM_OF_REPETITIONS 3
+#define NUM_OF_WARMUPS 2
+#define MEASUREMENT_TIME_BUDGET_SECONDS 2.0
+#define PERCENTILE_OF_TAIL 0.95
+#define GIGA 1e9
+#define STRASSEN_ALWAYS 1
+#define RANDOM_INT_BOUND 10
+#define TEXT_FORMAT "text"
+#define CSV_FORMAT "csv"
+#define JSON_FORMAT "json"
+#define FLOPS_UNIT "GFLOP/s"
+#define BYTES_UNIT "GB/s"
+#define CSV_HEADER "type,operation,size,threads,repetitions,median_seconds,p95_seconds," \
+				   "min_seconds,rate,unit,eigen_median_seconds,speedup_over_eigen,relative_error"
+#define JSON_NULL "null"
+#define USAGE_ERROR "Usage: timeChecker <size of matrix, 1 to 4096> [text|csv|json] " \
+					"[repetitions, 1 to 1000]"
+#define PRINT_SEPARATOR ' '
+#define CSV_SEPARATOR ','
 //================================ Code Segment =================================================
 
 /**
- * This file measures the running time of our program.
- * It measures the running time of doing arithmetic operations with our matrix library,
- * and with the built-in matrix library.
+ * This file is the benchmark suite of our matrix library. It sweeps the sizes of squared matrices
+ * (doubling from FIRST_SWEEP_SIZE up to the size argument), the numbers of threads (powers of two
+ * up to the hardware concurrency) and the coordinate types int, float, double and Complex, and
+ * measures multiply, Strassen-Winograd multiply (at the sizes above the cutoff of its recursion),
+ * add, transpose, solve (by LU) and a product of views. Every measurement runs NUM_OF_WARMUPS
+ * untimed times, then up to the requested repetitions on the monotonic steady clock, and reports
+ * the median, the 95th percentile and the minimum, the rate (GFLOP/s, or GB/s for transpose), the
+ * same operation in Eigen as a baseline, and the error of our result relative to Eigen's. Every row
+ * also has the hardware counters of one run of our operation (see PerfCounters.hpp), and IPC:
+ * cycles, instructions, L1 data and last level cache misses, branch misses and the task clock. The
+ * counters which are not available are left out of the text, empty in CSV and null in JSON.
  */
 
 /**
- * This is the main function of our program. It measures the running time of doing
- * arithmetic operations with our matrix library, and with the built-in matrix library.
+ * This enum represents the output format of the report.
+ */
+enum class ReportFormat
+{
+	Text,
+	Csv,
+	Json
+};
+
+/**
+ * This struct holds the statistics of the repetitions of a measurement, in seconds.
+ */
+struct Statistics
+{
+	double median;
+	double p95;
+	double minimum;
+	unsigned int repetitions;
+	PerfCounts counters;
+};
+
+/**
+ * This struct holds a row of the report.
+ */
+struct BenchmarkRow
+{
+	std :: string type;
+	std :: string operation;
+	unsigned int size;
+	unsigned int threads;
+	Statistics ours;
+	double rate;
+	const char* unit;
+	double eigenMedian;
+	double relativeError;
+};
+
+/**
+ * This struct maps a coordinate type to the scalar type of Eigen: itself, or
+ * std::complex<double> for Complex.
+ * @tparam T - the coordinate type.
+ */
+template <class T> struct EigenCoordinate
+{
+	typedef T type;
+
+	static type of(const T& coord)
+	{
+		return coord;
+	}
+
+	static double squaredDistance(const T& coord, const type& eigenCoord)
+	{
+		double difference = (double) coord - (double) eigenCoord;
+		return difference * difference;
+	}
+
+	static double squaredMagnitude(const type& eigenCoord)
+	{
+		return (double) eigenCoord * (double) eigenCoord;
+	}
+};
+
+template <> struct EigenCoordinate<Complex>
+{
+	typedef std :: complex<double> type;
+
+	static type of(const Complex& coord)
+	{
+		return type(coord.real(), coord.imag());
+	}
+
+	static double squaredDistance(const Complex& coord, const type& eigenCoord)
+	{
+		return std :: norm(type(coord.real(), coord.imag()) - eigenCoord);
+	}
+
+	static double squaredMagnitude(const type& eigenCoord)
+	{
+		return std :: norm(eigenCoord);
+	}
+};
+
+/**
+ * This class writes the rows of the report in the chosen format.
+ */
+class ReportWriter
+{
+	public:
+
+	/**
+	 * This constructor starts a report.
+	 * @param format - the output format.
+	 * @param os - the output stream.
+	 */
+	ReportWriter(ReportFormat format, std :: ostream& os) : _format(format), _os(os),
+	_isFirstRow(true)
+	{
+		if(_format == ReportFormat::Csv)
+		{
+			_os << CSV_HEADER;
+			for(std :: size_t index = 0 ; index < PERF_NUM_OF_COUNTERS ; ++index)
+			{
+				_os << CSV_SEPARATOR << PerfCounts::nameOf((PerfCounter) index);
+			}
+			_os << CSV_SEPARATOR << "ipc" << '\n';
+		}
+		else if(_format == ReportFormat::Json)
+		{
+			_os << "[\n";
+		}
+	}
+
+	/**
+	 * This method writes a row of the report.
+	 * @param row - the row.
+	 */
+	void write(const BenchmarkRow& row)
+	{
+		double speedup = row.ours.median > 0 ? row.eigenMedian / row.ours.median : 0;
+		const PerfCounts& counters = row.ours.counters;
+		switch(_format)
+		{
+			case ReportFormat::Text:
+				_os << row.type << PRINT_SEPARATOR << row.operation << " size " << row.size
+					<< " threads " << row.threads << " median " << row.ours.median << " p95 "
+					<< row.ours.p95 << PRINT_SEPARATOR << row.unit << PRINT_SEPARATOR << row.rate
+					<< " eigen " << row.eigenMedian << " speedup " << speedup
+					<< " relative error " << row.relativeError;
+				for(std :: size_t index = 0 ; index < PERF_NUM_OF_COUNTERS ; ++index)
+				{
+					if(counters.isAvailable((PerfCounter) index))
+					{
+						_os << PRINT_SEPARATOR << PerfCounts::nameOf((PerfCounter) index)
+							<< PRINT_SEPARATOR << counters.values[index];
+					}
+				}
+				if(counters.instructionsPerCycle() >= 0)
+				{
+					_os << " ipc " << counters.instructionsPerCycle();
+				}
+				_os << '\n';
+				break;
+			case ReportFormat::Csv:
+				_os << row.type << CSV_SEPARATOR << row.operation << CSV_SEPARATOR << row.size
+					<< CSV_SEPARATOR << row.threads << CSV_SEPARATOR << row.ours.repetitions
+					<< CSV_SEPARATOR << row.ours.median << CSV_SEPARATOR << row.ours.p95
+					<< CSV_SEPARATOR << row.ours.minimum << CSV_SEPARATOR << row.rate
+					<< CSV_SEPARATOR << row.unit << CSV_SEPARATOR << row.eigenMedian
+					<< CSV_SEPARATOR << speedup << CSV_SEPARATOR << row.relativeError;
+				for(std :: size_t index = 0 ; index < PERF_NUM_OF_COUNTERS ; ++index)
+				{
+					_os << CSV_SEPARATOR;
+					writeCount(counters.values[index], "");
+				}
+				_os << CSV_SEPARATOR;
+				writeCount(counters.instructionsPerCycle(), "");
+				_os << '\n';
+				break;
+			case ReportFormat::Json:
+				_os << (_isFirstRow ? "" : ",\n") << "  {\"type\": \"" << row.type
+					<< "\", \"operation\": \"" << row.operation << "\", \"size\": " << row.size
+					<< ", \"threads\": " << row.threads << ", \"repetitions\": "
+					<< row.ours.repetitions << ", \"median_seconds\": " << row.ours.median
+					<< ", \"p95_seconds\": " << row.ours.p95 << ", \"min_seconds\": "
+					<< row.ours.minimum << ", \"rate\": " << row.rate << ", \"unit\": \""
+					<< row.unit << "\", \"eigen_median_seconds\": " << row.eigenMedian
+					<< ", \"speedup_over_eigen\": " << speedup << ", \"relative_error\": "
+					<< row.relativeError;
+				for(std :: size_t index = 0 ; index < PERF_NUM_OF_COUNTERS ; ++index)
+				{
+					_os << ", \"" << PerfCounts::nameOf((PerfCounter) index) << "\": ";
+					writeCount(counters.values[index], JSON_NULL);
+				}
+				_os << ", \"ipc\": ";
+				writeCount(counters.instructionsPerCycle(), JSON_NULL);
+				_os << "}";
+				break;
+		}
+		_isFirstRow = false;
+		_os.flush();
+	}
+
+	/**
+	 * This method ends the report.
+	 */
+	void finish()
+	{
+		if(_format == ReportFormat::Json)
+		{
+			_os << (_isFirstRow ? "" : "\n") << "]\n";
+		}
+		_os.flush();
+	}
+
+	private:
+
+	/**
+	 * This method writes a count, or a placeholder if it is unavailable.
+	 * @param count - the count.
+	 * @param unavailable - the placeholder.
+	 */
+	void writeCount(double count, const char* unavailable)
+	{
+		if(count >= 0)
+		{
+			_os << count;
+		}
+		else
+		{
+			_os << unavailable;
+		}
+	}
+
+	ReportFormat _format;
+
+	std :: ostream& _os;
+
+	bool _isFirstRow;
+};
+
+/**
+ * This function measures an operation: NUM_OF_WARMUPS untimed runs, then timed runs until the
+ * requested repetitions, or until MEASUREMENT_TIME_BUDGET_SECONDS if at least
+ * MIN_NUM_OF_REPETITIONS ran.
+ * @tparam Operation - the type of the operation.
+ * @param operation - the operation.
+ * @param repetitions - the requested number of timed runs.
+ * @return the statistics of the timed runs.
+ */
+template <class Operation> Statistics measure(const Operation& operation, unsigned int repetitions)
+{
+	for(unsigned int warmup = 0 ; warmup < NUM_OF_WARMUPS ; ++warmup)
+	{
+		operation();
+	}
+	std :: vector<double> samples;
+	double totalSeconds = 0;
+	PerfCounts countersAtStart = PerfCounters::instance().read();
+	while(samples.size() < repetitions && (samples.size() < MIN_NUM_OF_REPETITIONS ||
+										   totalSeconds < MEASUREMENT_TIME_BUDGET_SECONDS))
+	{
+		std :: chrono :: steady_clock :: time_point start = std :: chrono :: steady_clock :: now();
+		operation();
+		std :: chrono :: duration<double> seconds = std :: chrono :: steady_clock :: now() - start;
+		samples.push_back(seconds.count());
+		totalSeconds += seconds.count();
+	}
+	std :: size_t count = samples.size();
+	Statistics statistics;
+	statistics.counters = PerfCounters::instance().read() - countersAtStart;
+	statistics.counters.calls = count;
+	statistics.counters = statistics.counters.perCall();
+	std :: sort(samples.begin(), samples.end());
+	statistics.median = count % 2 ? samples[count / 2] :
+						(samples[count / 2 - 1] + samples[count / 2]) / 2;
+	statistics.p95 = samples[(std :: size_t) std :: ceil(PERCENTILE_OF_TAIL * count) - 1];
+	statistics.minimum = samples.front();
+	statistics.repetitions = (unsigned int) count;
+	return statistics;
+}
+
+/**
+ * This function returns random coordinates: integers in [-RANDOM_INT_BOUND, RANDOM_INT_BOUND],
+ * or real (and imaginary) parts in [-1, 1].
+ * @tparam T - the coordinate type.
+ * @param count - the number of coordinates.
+ * @param generator - the random generator.
+ * @return the coordinates.
+ */
+template <class T> std :: vector<T> randomCells(std :: size_t count, std :: mt19937& generator)
+{
+	std :: vector<T> cells(count);
+	std :: uniform_int_distribution<int> integers(-RANDOM_INT_BOUND, RANDOM_INT_BOUND);
+	std :: uniform_real_distribution<double> reals(-1, 1);
+	for(T& cell : cells)
+	{
+		if constexpr (std :: is_integral<T>::value)
+		{
+			cell = (T) integers(generator);
+		}
+		else if constexpr (std :: is_same<T, Complex>::value)
+		{
+			double real = reals(generator);
+			cell = Complex(real, reals(generator));
+		}
+		else
+		{
+			cell = (T) reals(generator);
+		}
+	}
+	return cells;
+}
+
+/**
+ * This function copies row-major coordinates into an Eigen matrix.
+ * @tparam T - the coordinate type.
+ * @param cells - the coordinates.
+ * @param size - the number of rows and columns.
+ * @return the Eigen matrix.
+ */
+template <class T>
+Eigen :: Matrix<typename EigenCoordinate<T>::type, Eigen :: Dynamic, Eigen :: Dynamic>
+toEigen(const std :: vector<T>& cells, unsigned int size)
+{
+	Eigen :: Matrix<typename EigenCoordinate<T>::type, Eigen :: Dynamic, Eigen :: Dynamic>
+			result(size, size);
+	for(unsigned int row = 0 ; row < size ; ++row)
+	{
+		for(unsigned int col = 0 ; col < size ; ++col)
+		{
+			result(row, col) = EigenCoordinate<T>::of(cells[(std :: size_t) row * size + col]);
+		}
+	}
+	return result;
+}
+
+/**
+ * This function calculates the Frobenius norm of the difference between our result and
+ * Eigen's, relative to the norm of Eigen's (or the absolute norm if Eigen's is zero).
+ * @tparam T - the coordinate type.
+ * @tparam EigenMatrix - the type of the Eigen matrix.
+ * @param ours - our result.
+ * @param eigen - Eigen's result.
+ * @return the relative error.
+ */
+template <class T, class EigenMatrix>
+double relativeError(const Matrix<T>& ours, const EigenMatrix& eigen)
+{
+	if(ours.rows() != (unsigned int) eigen.rows() || ours.cols() != (unsigned int) eigen.cols())
+	{
+		throw std :: logic_error(INCOMPATIBLE_DIMENSIONS_OF_MATRICES_ERROR);
+	}
+	double distance = 0, magnitude = 0;
+	for(unsigned int row = 0 ; row < ours.rows() ; ++row)
+	{
+		for(unsigned int col = 0 ; col < ours.cols() ; ++col)
+		{
+			distance += EigenCoordinate<T>::squaredDistance(ours.at_unchecked(row, col),
+															 eigen(row, col));
+			magnitude += EigenCoordinate<T>::squaredMagnitude(eigen(row, col));
+		}
+	}
+	return magnitude > 0 ? std :: sqrt(distance / magnitude) : std :: sqrt(distance);
+}
+
+/**
+ * This class benchmarks the operations of one coordinate type at one size.
+ * @tparam T - the coordinate type.
+ */
+template <class T> class TypeBenchmark
+{
+	public:
+
+	typedef typename EigenCoordinate<T>::type Scalar;
+
+	typedef Eigen :: Matrix<Scalar, Eigen :: Dynamic, Eigen :: Dynamic> EigenMatrix;
+
+	/**
+	 * This constructor creates the random operands.
+	 * @param type - the name of the coordinate type.
+	 * @param size - the number of rows and columns of the operands.
+	 * @param threadCounts - the numbers of threads to measure our operations with.
+	 * @param repetitions - the requested number of timed runs of a measurement.
+	 * @param writer - the report.
+	 */
+	TypeBenchmark(const std :: string& type, unsigned int size,
+				  const std :: vector<unsigned int>& threadCounts, unsigned int repetitions,
+				  ReportWriter& writer) :
+	_type(type), _size(size), _threadCounts(threadCounts), _repetitions(repetitions),
+	_writer(writer)
+	{
+		std :: mt19937 generator(size);
+		std :: vector<T> cellsA = randomCells<T>((std :: size_t) size * size, generator);
+		std :: vector<T> cellsB = randomCells<T>((std :: size_t) size * size, generator);
+		_a = Matrix<T>(size, size, cellsA);
+		_b = Matrix<T>(size, size, cellsB);
+		_eigenA = toEigen(cellsA, size);
+		_eigenB = toEigen(cellsB, size);
+	}
+
+	/**
+	 * This method benchmarks all the operations which support the coordinate type.
+	 */
+	void run()
+	{
+		// a complex multiply-add is 4 real multiplications and 4 real additions
+		double flopsPerOperation = std :: is_same<T, Complex>::value ? 4 : 1;
+		double cells = (double) _size * _size, cube = cells * _size;
+		benchmark("multiply", 2 * cube * flopsPerOperation, FLOPS_UNIT,
+				  [this]() { _result = _a * _b; },
+				  [this]() { _eigenResult.noalias() = _eigenA * _eigenB; });
+		if constexpr (std :: is_floating_point<T>::value)
+		{
+			unsigned int minimalSize = StrassenKernels<T>::minimalSize();
+			StrassenKernels<T>::setMinimalSize(STRASSEN_ALWAYS);
+			// below the cutoff of the recursion the product is the classic GEMM, so there is
+			// no Strassen-Winograd row to report
+			if(StrassenKernels<T>::isUsedFor(_size, _size, _size))
+			{
+				benchmark("strassen", 2 * cube, FLOPS_UNIT, [this]() { _result = _a * _b; },
+						  [this]() { _eigenResult.noalias() = _eigenA * _eigenB; });
+			}
+			StrassenKernels<T>::setMinimalSize(minimalSize);
+		}
+		benchmark("add", cells * (flopsPerOperation > 1 ? 2 : 1), FLOPS_UNIT,
+				  [this]() { _result = _a + _b; },
+				  [this]() { _eigenResult = _eigenA + _eigenB; });
+		// transpose reads and writes every coordinate once
+		benchmark("transpose", 2 * cells * sizeof(T), BYTES_UNIT,
+				  [this]() { _result = _a.trans(); },
+				  [this]() { _eigenResult = _eigenA.adjoint(); });
+		if constexpr (!std :: is_integral<T>::value)
+		{
+			// LU is 2/3 n^3, and the two triangular solves with n right hand sides 2 n^3
+			benchmark("solve", 8.0 / 3 * cube * flopsPerOperation, FLOPS_UNIT,
+					  [this]() { _result = LUDecomposition<T>(_a).solve(_b); },
+					  [this]() { _eigenResult = _eigenA.partialPivLu().solve(_eigenB); });
+		}
+		unsigned int half = _size / 2;
+		if(half > 0)
+		{
+			double halfCube = (double) half * half * half;
+			_result = Matrix<T>(_size, _size);
+			_eigenResult = EigenMatrix::Zero(_size, _size);
+			benchmark("views", 2 * halfCube * flopsPerOperation, FLOPS_UNIT, [this, half]()
+			{
+				view(_result).block(0, 0, half, half) =
+						view(_a).block(half, 0, half, half) * view(_b).block(0, half, half, half);
+			}, [this, half]()
+			{
+				_eigenResult.block(0, 0, half, half).noalias() =
+						_eigenA.block(half, 0, half, half) * _eigenB.block(0, half, half, half);
+			});
+		}
+	}
+
+	private:
+
+	/**
+	 * This method measures an operation in Eigen once (Eigen runs on one thread), and ours with
+	 * every number of threads, and writes a row for each.
+	 * @tparam Ours - the type of our operation.
+	 * @tparam Theirs - the type of Eigen's operation.
+	 * @param operation - the name of the operation.
+	 * @param work - the number of floating point operations (or bytes) of the operation.
+	 * @param unit - the unit of the rate.
+	 * @param ours - our operation, which writes _result.
+	 * @param theirs - Eigen's operation, which writes _eigenResult.
+	 */
+	template <class Ours, class Theirs>
+	void benchmark(const std :: string& operation, double work, const char* unit,
+				   const Ours& ours, const Theirs& theirs)
+	{
+		Statistics eigenStatistics = measure(theirs, _repetitions);
+		for(unsigned int numOfThreads : _threadCounts)
+		{
+			ThreadPool::instance().setNumOfThreads(numOfThreads);
+			BenchmarkRow row;
+			row.type = _type;
+			row.operation = operation;
+			row.size = _size;
+			row.threads = numOfThreads;
+			row.ours = measure(ours, _repetitions);
+			row.rate = row.ours.median > 0 ? work / row.ours.median / GIGA : 0;
+			row.unit = unit;
+			row.eigenMedian = eigenStatistics.median;
+			row.relativeError = relativeError(_result, _eigenResult);
+			_writer.write(row);
+		}
+	}
+
+	std :: string _type;
+
+	unsigned int _size;
+
+	const std :: vector<unsigned int>& _threadCounts;
+
+	unsigned int _repetitions;
+
+	ReportWriter& _writer;
+
+	Matrix<T> _a, _b, _result;
+
+	EigenMatrix _eigenA, _eigenB, _eigenResult;
+};
+
+/**
+ * This function parses a positive integer argument.
+ * @param argument - the argument.
+ * @param maximum - the maximal valid value.
+ * @return the value.
+ * @throw invalid argument error if the argument is not an integer between 1 and maximum.
+ */
+unsigned int parsePositive(const std :: string& argument, unsigned int maximum)
+{
+	std :: size_t parsedLength = 0;
+	long value = std :: stol(argument, &parsedLength);
+	if(parsedLength != argument.size() || value < MIN_SIZE_OF_SQUARED_MATRIX ||
+	   value > (long) maximum)
+	{
+		throw std :: invalid_argument(USAGE_ERROR);
+	}
+	return (unsigned int) value;
+}
+
+/**
+ * This is the main function of our program. It runs the benchmark suite and writes the report
+ * to the standard output.
  * @param argc - the number of input arguments for our program.
- * @param argv - the values of the input arguments for our program (the matrix size).
+ * @param argv - the values of the input arguments for our program: the maximal matrix size,
+ * optionally the format (text, csv or json) and the number of repetitions.
  * @return 0 if succeeds, non-zero otherwise.
- * @throw invalid argument error if not positive.
- * @throw out of range exception if the matrices dimensions do not suit each other.
- * @throw logic error of incompatible matrices dimensions.
- * @throw logic error of untransposable matrix exception.
- * @throw out of range exception of index out of bounds.
  */
 int main(int argc, char *argv[])
 {
-	//check validity of number of input arguments and then check validity of range of size
-	if (argc != NUM_OF_ARGS)
-	{
-		std::cerr << WRONG_NUMBER_OF_ARGS_USAGE_ERROR << std::endl;
-		exit(EXIT_FAILURE);
-	}
-	if(argc > MAX_SIZE_OF_SQUARED_MATRIX || argc < MIN_SIZE_OF_SQUARED_MATRIX)
-	{
-		std::cerr << OUT_OF_RANGE_SIZE_USAGE_ERROR << std::endl;
-		exit(EXIT_FAILURE);
-	}
-	std::string matrixSizeString(argv[INDEX_OF_SIZE_OF_MATRIX_ARGUMENT]);
-	unsigned int matrixSize = (unsigned int) std::stoi(argv[1]);
-	std::stack<std::chrono::time_point<std::chrono::system_clock>> tictoc_stack;
-	Eigen :: MatrixXd eigenMatrixA = Eigen :: MatrixXd :: Random(matrixSize, matrixSize);
-	Eigen :: MatrixXd eigenMatrixB = Eigen :: MatrixXd :: Random(matrixSize, matrixSize);
-	Eigen :: MatrixXd eigenMatrixMultiplicationResult;
-	Eigen :: MatrixXd eigenMatrixAdditionResult;
-	std::cout << PRINT_SIZE_TITLE << matrixSize << std :: endl;
-	//measure running time of Eigen matrix multiplication:
-	tictoc_stack.push(std::chrono::system_clock::now());
-	eigenMatrixMultiplicationResult = eigenMatrixA * eigenMatrixB;
-	std::chrono::duration<double> elapsed_seconds = std::chrono::system_clock::now() -
-													tictoc_stack.top();
-	std::cout << PRINT_EIGEN_MULT_TITLE << elapsed_seconds.count() << std :: endl;
-	tictoc_stack.pop();
-	//measure running time of Eigen matrix addition:
-	tictoc_stack.push(std::chrono::system_clock::now());
-	eigenMatrixAdditionResult = eigenMatrixA + eigenMatrixB;
-	elapsed_seconds = std::chrono::system_clock::now() - tictoc_stack.top();
-	std::cout << PRINT_EIGEN_ADD_TITLE << elapsed_seconds.count() << std :: endl;
-	tictoc_stack.pop();
-	//create matlib matrices:
-	Matrix<int> myOneMatrix(matrixSize, matrixSize,
-			             std::vector<int>(matrixSize * matrixSize, TESTED_MATRIX_CELL_VALUE));
-	Matrix<int> multiplyOneMatrix, addOneMatrix;
-	//measure running time of Matlib matrix multiplication:
-	tictoc_stack.push(std::chrono::system_clock::now());
-	multiplyOneMatrix = myOneMatrix * myOneMatrix;
-	elapsed_seconds = std::chrono::system_clock::now() - tictoc_stack.top();
-	std::cout << PRINT_MATLIB_MULT_TITLE << elapsed_seconds.count() << std :: endl;
-	tictoc_stack.pop();
-	//measure running time of Matlib matrix addition:
-	tictoc_stack.push(std::chrono::system_clock::now());
-	addOneMatrix = myOneMatrix + myOneMatrix;
-	elapsed_seconds = std::chrono::system_clock::now() - tictoc_stack.top();
-	std::cout << PRINT_MATLIB_ADD_TITLE << elapsed_seconds.count() << std :: endl;
-	tictoc_stack.pop();
+	if(argc < MIN_NUM_OF_ARGS || argc > MAX_NUM_OF_ARGS)
+	{
+		std :: cerr << USAGE_ERROR << std :: endl;
+		return EXIT_FAILURE;
+	}
+	unsigned int maxSize, repetitions = DEFAULT_NUM_OF_REPETITIONS;
+	ReportFormat format = ReportFormat::Text;
+	try
+	{
+		maxSize = parsePositive(argv[INDEX_OF_SIZE_OF_MATRIX_ARGUMENT], MAX_SIZE_OF_SQUARED_MATRIX);
+		if(argc > INDEX_OF_FORMAT_ARGUMENT)
+		{
+			std :: string formatName(argv[INDEX_OF_FORMAT_ARGUMENT]);
+			if(formatName == CSV_FORMAT)
+			{
+				format = ReportFormat::Csv;
+			}
+			else if(formatName == JSON_FORMAT)
+			{
+				format = ReportFormat::Json;
+			}
+			else if(formatName != TEXT_FORMAT)
+			{
+				throw std :: invalid_argument(USAGE_ERROR);
+			}
+		}
+		if(argc > INDEX_OF_REPETITIONS_ARGUMENT)
+		{
+			repetitions = parsePositive(argv[INDEX_OF_REPETITIONS_ARGUMENT],
+										MAX_NUM_OF_REPETITIONS);
+		}
+	}
+	catch(const std :: logic_error&)
+	{
+		// std::stol throws invalid argument or out of range errors, both logic errors
+		std :: cerr << USAGE_ERROR << std :: endl;
+		return EXIT_FAILURE;
+	}
+	std :: vector<unsigned int> sizes;
+	for(unsigned int size = FIRST_SWEEP_SIZE ; size < maxSize ; size *= 2)
+	{
+		sizes.push_back(size);
+	}
+	sizes.push_back(maxSize);
+	unsigned int maxNumOfThreads = std :: max(1u, std :: thread :: hardware_concurrency());
+	std :: vector<unsigned int> threadCounts;
+	for(unsigned int numOfThreads = 1 ; numOfThreads <= maxNumOfThreads ; numOfThreads *= 2)
+	{
+		threadCounts.push_back(numOfThreads);
+	}
+	ReportWriter writer(format, std :: cout);
+	for(unsigned int size : sizes)
+	{
+		TypeBenchmark<int>("int", size, threadCounts, repetitions, writer).run();
+		TypeBenchmark<float>("float", size, threadCounts, repetitions, writer).run();
+		TypeBenchmark<double>("double", size, threadCounts, repetitions, writer).run();
+		TypeBenchmark<Complex>("Complex", size, threadCounts, repetitions, writer).run();
+	}
+	writer.finish();
+	ThreadPool::instance().setNumOfThreads(maxNumOfThreads);
 	return 0;
-}
\ No newline at end of file
+}